@@ -19,6 +19,8 @@
 #include <gsl/gsl-lite.hpp>
 #include <sodium/crypto_box.h>
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
@@ -131,6 +133,9 @@ T generichash(std::string_view data)
 
 std::vector<uint8_t> generichash16(gsl::span<uint8_t const> data);
 void randomFill(gsl::span<uint8_t> data);
+// Zeroes data in a way the compiler can not optimize out, for secrets that are
+// about to be dropped
+void secureZero(gsl::span<uint8_t> data);
 
 template <typename T, typename = std::enable_if_t<IsCryptographicType<T>::value>>
 T getRandom()
@@ -199,16 +204,51 @@ void tryDecryptAead(std::optional<Crypto::SymmetricKey> const& key,
                     gsl::span<uint8_t const> encryptedData,
                     gsl::span<uint8_t const> associatedData);
 
+// AES-256-GCM, with the same key and Mac sizes as encryptAead but a shorter
+// IV. It uses the CPU AES instructions when there are some, and a portable
+// implementation otherwise.
+inline constexpr std::size_t aes256GcmIvSize = 12;
+bool aes256GcmIsAccelerated();
+
+// returns the Mac
+gsl::span<uint8_t const> encryptAeadAes256Gcm(SymmetricKey const& key,
+                                              gsl::span<uint8_t const> iv,
+                                              gsl::span<uint8_t> encryptedData,
+                                              gsl::span<uint8_t const> clearData,
+                                              gsl::span<uint8_t const> associatedData);
+
+void decryptAeadAes256Gcm(SymmetricKey const& key,
+                          gsl::span<uint8_t const> iv,
+                          gsl::span<uint8_t> clearData,
+                          gsl::span<uint8_t const> encryptedData,
+                          gsl::span<uint8_t const> associatedData);
+
+namespace detail
+{
+// Always the portable implementation, so that it can be tested on any CPU
+void encryptAeadAes256GcmPortable(SymmetricKey const& key,
+                                  gsl::span<uint8_t const> iv,
+                                  gsl::span<uint8_t> encryptedData,
+                                  gsl::span<uint8_t const> clearData,
+                                  gsl::span<uint8_t const> associatedData);
+
+void decryptAeadAes256GcmPortable(SymmetricKey const& key,
+                                  gsl::span<uint8_t const> iv,
+                                  gsl::span<uint8_t> clearData,
+                                  gsl::span<uint8_t const> encryptedData,
+                                  gsl::span<uint8_t const> associatedData);
+}
+
 template <typename SeedType>
 AeadIv deriveIv(SeedType const& ivSeed, uint64_t const number)
 {
   auto pointer = reinterpret_cast<uint8_t const*>(&number);
-  auto const numberSize = sizeof(number);
+  constexpr auto numberSize = sizeof(number);
 
-  std::vector<uint8_t> toHash;
-  toHash.reserve(numberSize + SeedType::arraySize);
-  toHash.insert(toHash.end(), ivSeed.begin(), ivSeed.end());
-  toHash.insert(toHash.end(), pointer, pointer + numberSize);
+  // This is called for every chunk of a stream, keep it off the heap
+  std::array<uint8_t, SeedType::arraySize + numberSize> toHash;
+  auto const it = std::copy(ivSeed.begin(), ivSeed.end(), toHash.begin());
+  std::copy(pointer, pointer + numberSize, it);
   return generichash<AeadIv>(gsl::make_span(toHash.data(), toHash.size()));
 }
 
@@ -0,0 +1,178 @@
+#include <Tanker/Crypto/Crypto.hpp>
+
+#include <Tanker/Errors/AssertionError.hpp>
+#include <Tanker/Errors/Exception.hpp>
+
+#include <openssl/evp.h>
+#include <sodium/crypto_aead_aes256gcm.h>
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+
+using Tanker::Errors::Exception;
+
+namespace Tanker
+{
+namespace Crypto
+{
+namespace
+{
+static_assert(crypto_aead_aes256gcm_KEYBYTES == SymmetricKey::arraySize);
+static_assert(crypto_aead_aes256gcm_ABYTES == Mac::arraySize);
+static_assert(crypto_aead_aes256gcm_NPUBBYTES == aes256GcmIvSize);
+
+struct CipherContextDeleter
+{
+  void operator()(EVP_CIPHER_CTX* ctx) const
+  {
+    EVP_CIPHER_CTX_free(ctx);
+  }
+};
+
+using CipherContext = std::unique_ptr<EVP_CIPHER_CTX, CipherContextDeleter>;
+
+void checkSizes(std::string const& function,
+                gsl::span<uint8_t const> iv,
+                std::size_t clearSize,
+                std::size_t associatedDataSize)
+{
+  if (iv.size() != aes256GcmIvSize)
+    throw Errors::AssertionError(function + ": iv buffer is of the wrong size");
+  // LibreSSL takes int sizes
+  if (clearSize > std::numeric_limits<int>::max() || associatedDataSize > std::numeric_limits<int>::max())
+    throw Errors::AssertionError(function + ": buffer is too large");
+}
+
+CipherContext makeContext(SymmetricKey const& key, gsl::span<uint8_t const> iv, int encrypt)
+{
+  CipherContext ctx(EVP_CIPHER_CTX_new());
+  if (!ctx || EVP_CipherInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr, nullptr, nullptr, encrypt) != 1 ||
+      EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_IVLEN, iv.size(), nullptr) != 1 ||
+      EVP_CipherInit_ex(ctx.get(), nullptr, nullptr, key.data(), iv.data(), encrypt) != 1)
+    throw Errors::AssertionError("AES-256-GCM: failed to initialize the cipher");
+  return ctx;
+}
+}
+
+bool aes256GcmIsAccelerated()
+{
+  static auto const accelerated = crypto_aead_aes256gcm_is_available() == 1;
+  return accelerated;
+}
+
+gsl::span<uint8_t const> encryptAeadAes256Gcm(SymmetricKey const& key,
+                                              gsl::span<uint8_t const> iv,
+                                              gsl::span<uint8_t> encryptedData,
+                                              gsl::span<uint8_t const> clearData,
+                                              gsl::span<uint8_t const> associatedData)
+{
+  if (encryptedData.size() < clearData.size() + Mac::arraySize)
+    throw Errors::AssertionError("encryptAeadAes256Gcm: encryptedData buffer is too short");
+
+  if (!aes256GcmIsAccelerated())
+    detail::encryptAeadAes256GcmPortable(key, iv, encryptedData, clearData, associatedData);
+  else
+  {
+    if (iv.size() != aes256GcmIvSize)
+      throw Errors::AssertionError("encryptAeadAes256Gcm: iv buffer is of the wrong size");
+    crypto_aead_aes256gcm_encrypt(encryptedData.data(),
+                                  nullptr,
+                                  clearData.data(),
+                                  clearData.size(),
+                                  associatedData.data(),
+                                  associatedData.size(),
+                                  nullptr,
+                                  iv.data(),
+                                  key.data());
+  }
+  return encryptedData.subspan(clearData.size(), Mac::arraySize);
+}
+
+void decryptAeadAes256Gcm(SymmetricKey const& key,
+                          gsl::span<uint8_t const> iv,
+                          gsl::span<uint8_t> clearData,
+                          gsl::span<uint8_t const> encryptedData,
+                          gsl::span<uint8_t const> associatedData)
+{
+  if (encryptedData.size() < Mac::arraySize)
+    throw Exception(Errc::InvalidEncryptedDataSize, "decryptAeadAes256Gcm: encryptedData buffer is too short");
+  if (clearData.size() < encryptedData.size() - Mac::arraySize)
+    throw Errors::AssertionError("decryptAeadAes256Gcm: clearData buffer is too short");
+
+  if (!aes256GcmIsAccelerated())
+  {
+    detail::decryptAeadAes256GcmPortable(key, iv, clearData, encryptedData, associatedData);
+    return;
+  }
+
+  if (iv.size() != aes256GcmIvSize)
+    throw Errors::AssertionError("decryptAeadAes256Gcm: iv buffer is of the wrong size");
+  auto const error = crypto_aead_aes256gcm_decrypt(clearData.data(),
+                                                   nullptr,
+                                                   nullptr,
+                                                   encryptedData.data(),
+                                                   encryptedData.size(),
+                                                   associatedData.data(),
+                                                   associatedData.size(),
+                                                   iv.data(),
+                                                   key.data());
+  if (error != 0)
+    throw Exception(Errc::AeadDecryptionFailed, "MAC verification failed");
+}
+
+namespace detail
+{
+void encryptAeadAes256GcmPortable(SymmetricKey const& key,
+                                  gsl::span<uint8_t const> iv,
+                                  gsl::span<uint8_t> encryptedData,
+                                  gsl::span<uint8_t const> clearData,
+                                  gsl::span<uint8_t const> associatedData)
+{
+  if (encryptedData.size() < clearData.size() + Mac::arraySize)
+    throw Errors::AssertionError("encryptAeadAes256Gcm: encryptedData buffer is too short");
+  checkSizes("encryptAeadAes256Gcm", iv, clearData.size(), associatedData.size());
+
+  auto const ctx = makeContext(key, iv, 1);
+  int written = 0;
+  int finalWritten = 0;
+  if ((!associatedData.empty() &&
+       EVP_EncryptUpdate(ctx.get(), nullptr, &written, associatedData.data(), associatedData.size()) != 1) ||
+      EVP_EncryptUpdate(ctx.get(), encryptedData.data(), &written, clearData.data(), clearData.size()) != 1 ||
+      EVP_EncryptFinal_ex(ctx.get(), encryptedData.data() + written, &finalWritten) != 1 ||
+      EVP_CIPHER_CTX_ctrl(
+          ctx.get(), EVP_CTRL_GCM_GET_TAG, Mac::arraySize, encryptedData.data() + clearData.size()) != 1)
+    throw Errors::AssertionError("encryptAeadAes256Gcm: encryption failed");
+}
+
+void decryptAeadAes256GcmPortable(SymmetricKey const& key,
+                                  gsl::span<uint8_t const> iv,
+                                  gsl::span<uint8_t> clearData,
+                                  gsl::span<uint8_t const> encryptedData,
+                                  gsl::span<uint8_t const> associatedData)
+{
+  if (encryptedData.size() < Mac::arraySize)
+    throw Exception(Errc::InvalidEncryptedDataSize, "decryptAeadAes256Gcm: encryptedData buffer is too short");
+  auto const cipherText = encryptedData.first(encryptedData.size() - Mac::arraySize);
+  auto const mac = encryptedData.last(Mac::arraySize);
+  if (clearData.size() < cipherText.size())
+    throw Errors::AssertionError("decryptAeadAes256Gcm: clearData buffer is too short");
+  checkSizes("decryptAeadAes256Gcm", iv, cipherText.size(), associatedData.size());
+
+  auto const ctx = makeContext(key, iv, 0);
+  int written = 0;
+  int finalWritten = 0;
+  // LibreSSL does not modify the tag, but only takes it as non-const
+  if ((!associatedData.empty() &&
+       EVP_DecryptUpdate(ctx.get(), nullptr, &written, associatedData.data(), associatedData.size()) != 1) ||
+      EVP_DecryptUpdate(ctx.get(), clearData.data(), &written, cipherText.data(), cipherText.size()) != 1 ||
+      EVP_CIPHER_CTX_ctrl(
+          ctx.get(), EVP_CTRL_GCM_SET_TAG, Mac::arraySize, const_cast<uint8_t*>(mac.data())) != 1)
+    throw Errors::AssertionError("decryptAeadAes256Gcm: decryption failed");
+  if (EVP_DecryptFinal_ex(ctx.get(), clearData.data() + written, &finalWritten) != 1)
+    throw Exception(Errc::AeadDecryptionFailed, "MAC verification failed");
+}
+}
+}
+}
@@ -10,6 +10,7 @@
 #include <sodium/crypto_sign.h>
 #include <sodium/crypto_sign_ed25519.h>
 #include <sodium/randombytes.h>
+#include <sodium/utils.h>
 
 #include <cassert>
 #include <cstddef>
@@ -98,6 +99,11 @@ void randomFill(gsl::span<uint8_t> data)
   randombytes_buf(data.data(), data.size());
 }
 
+void secureZero(gsl::span<uint8_t> data)
+{
+  sodium_memzero(data.data(), data.size());
+}
+
 Signature sign(gsl::span<uint8_t const> data, PrivateSignatureKey const& privateSignatureKey)
 {
   Signature signature;
@@ -9,6 +9,7 @@
 
 #include <catch2/catch_test_macros.hpp>
 #include <gsl/gsl-lite.hpp>
+#include <mgs/base16.hpp>
 #include <mgs/base64.hpp>
 #include <mgs/base64url.hpp>
 #include <nlohmann/json.hpp>
@@ -135,6 +136,77 @@ TEST_CASE("aead")
   }
 }
 
+TEST_CASE("aead with AES-256-GCM")
+{
+  // Test case 16 of the GCM specification
+  auto const key = mgs::base16::decode<SymmetricKey>(
+      "FEFFE9928665731C6D6A8F9467308308FEFFE9928665731C6D6A8F9467308308");
+  auto const iv = mgs::base16::decode<std::vector<uint8_t>>("CAFEBABEFACEDBADDECAF888");
+  auto const clear = mgs::base16::decode<std::vector<uint8_t>>(
+      "D9313225F88406E5A55909C5AFF5269A86A7A9531534F7DA2E4C303D8A318A721C3C0C95956809532FCF0E2449A6B525B16AEDF5AA0DE657"
+      "BA637B39");
+  auto const additional = mgs::base16::decode<std::vector<uint8_t>>("FEEDFACEDEADBEEFFEEDFACEDEADBEEFABADDAD2");
+  auto const expected = mgs::base16::decode<std::vector<uint8_t>>(
+      "522DC1F099567D07F47F37A32A84427D643A8CDCBFE5C0C97598A2BD2555D1AA8CB08E48590DBB3DA7B08B1056828838C5F61E6393BA7A0A"
+      "BCC9F662"
+      "76FC6ECE0F4E1768CDDF8853BB2D551B");
+
+  std::vector<uint8_t> encryptedBuffer(encryptedSize(clear.size()));
+  std::vector<uint8_t> decryptedBuffer(clear.size());
+
+  SECTION("it should match the specification")
+  {
+    encryptAeadAes256Gcm(key, iv, encryptedBuffer, clear, additional);
+    CHECK(encryptedBuffer == expected);
+
+    decryptAeadAes256Gcm(key, iv, decryptedBuffer, encryptedBuffer, additional);
+    CHECK(decryptedBuffer == clear);
+  }
+
+  SECTION("the portable implementation should match the specification")
+  {
+    detail::encryptAeadAes256GcmPortable(key, iv, encryptedBuffer, clear, additional);
+    CHECK(encryptedBuffer == expected);
+
+    detail::decryptAeadAes256GcmPortable(key, iv, decryptedBuffer, encryptedBuffer, additional);
+    CHECK(decryptedBuffer == clear);
+  }
+
+  SECTION("it should encrypt/decrypt an empty buffer")
+  {
+    std::vector<uint8_t> empty;
+    std::vector<uint8_t> emptyEncrypted(encryptedSize(0));
+    encryptAeadAes256Gcm(key, iv, emptyEncrypted, empty, {});
+
+    decryptAeadAes256Gcm(key, iv, empty, emptyEncrypted, {});
+    detail::decryptAeadAes256GcmPortable(key, iv, empty, emptyEncrypted, {});
+  }
+
+  SECTION("it should fail to decrypt a corrupted buffer")
+  {
+    auto corrupted = expected;
+    ++corrupted[0];
+
+    TANKER_CHECK_THROWS_WITH_CODE(decryptAeadAes256Gcm(key, iv, decryptedBuffer, corrupted, additional),
+                                  Errc::AeadDecryptionFailed);
+    TANKER_CHECK_THROWS_WITH_CODE(
+        detail::decryptAeadAes256GcmPortable(key, iv, decryptedBuffer, corrupted, additional),
+        Errc::AeadDecryptionFailed);
+  }
+
+  SECTION("it should fail to verify corrupted additional data")
+  {
+    auto corrupted = additional;
+    ++corrupted[0];
+
+    TANKER_CHECK_THROWS_WITH_CODE(decryptAeadAes256Gcm(key, iv, decryptedBuffer, expected, corrupted),
+                                  Errc::AeadDecryptionFailed);
+    TANKER_CHECK_THROWS_WITH_CODE(
+        detail::decryptAeadAes256GcmPortable(key, iv, decryptedBuffer, expected, corrupted),
+        Errc::AeadDecryptionFailed);
+  }
+}
+
 TEST_CASE("asymmetric")
 {
   auto const buf = gsl::make_span("Yet another test buffer").as_span<uint8_t const>();
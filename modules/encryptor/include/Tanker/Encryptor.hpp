@@ -2,6 +2,8 @@
 
 #include <Tanker/Crypto/ResourceId.hpp>
 #include <Tanker/EncryptCacheMetadata.hpp>
+#include <Tanker/Streams/TransparentSessionHeader.hpp>
+#include <Tanker/WorkerPool.hpp>
 
 #include <gsl/gsl-lite.hpp>
 #include <tconcurrent/coroutine.hpp>
@@ -20,21 +22,46 @@ inline ResourceKeyFinder fixedKeyFinder(Crypto::SymmetricKey key)
   return [key = std::move(key)](Crypto::SimpleResourceId const&) -> ResourceKeyFinder::result_type { TC_RETURN(key); };
 }
 
-bool isHugeClearData(uint64_t dataSize, std::optional<uint32_t> paddingStep);
+// How large data is split into chunks. Smaller chunks give a lower latency to
+// the first bytes of a stream, larger ones a higher throughput.
+struct StreamOptions
+{
+  static constexpr uint64_t defaultStreamThreshold = 1024 * 1024;
+
+  uint32_t encryptedChunkSize = Streams::TransparentSessionHeader::defaultEncryptedChunkSize;
+  // Data at least this large once padded is encrypted in the chunked format
+  uint64_t streamThreshold = defaultStreamThreshold;
+  // Encrypt the chunks with AES-256-GCM (V12) instead of XChaCha20-Poly1305
+  // (V11). It is much faster on CPUs with AES instructions, see
+  // Crypto::aes256GcmIsAccelerated(), and slower elsewhere.
+  bool aes256Gcm = false;
+};
+
+void checkStreamOptions(StreamOptions const& options);
+
+bool isHugeClearData(uint64_t dataSize,
+                     std::optional<uint32_t> paddingStep,
+                     uint64_t streamThreshold = StreamOptions::defaultStreamThreshold);
 
-uint64_t encryptedSize(uint64_t clearSize, std::optional<uint32_t> paddingStep);
+uint64_t encryptedSize(uint64_t clearSize,
+                       std::optional<uint32_t> paddingStep,
+                       StreamOptions const& streamOptions = {});
 uint64_t decryptedSize(gsl::span<uint8_t const> encryptedData);
 tc::cotask<EncryptCacheMetadata> encrypt(gsl::span<uint8_t> encryptedData,
                                          gsl::span<uint8_t const> clearData,
                                          std::optional<uint32_t> paddingStep,
                                          Crypto::SimpleResourceId transparentSessionId,
-                                         Crypto::SymmetricKey transparentSessionKey);
+                                         Crypto::SymmetricKey transparentSessionKey,
+                                         WorkerPool* workerPool = nullptr,
+                                         StreamOptions const& streamOptions = {});
 tc::cotask<uint64_t> decrypt(gsl::span<uint8_t> decryptedData,
                              ResourceKeyFinder const& keyFinder,
-                             gsl::span<uint8_t const> encryptedData);
+                             gsl::span<uint8_t const> encryptedData,
+                             WorkerPool* workerPool = nullptr);
 tc::cotask<uint64_t> decrypt(gsl::span<uint8_t> decryptedData,
                              Crypto::SymmetricKey const& key,
-                             gsl::span<uint8_t const> encryptedData);
+                             gsl::span<uint8_t const> encryptedData,
+                             WorkerPool* workerPool = nullptr);
 Crypto::ResourceId extractResourceId(gsl::span<uint8_t const> encryptedData);
 }
 }
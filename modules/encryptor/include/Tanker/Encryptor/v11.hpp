@@ -5,11 +5,13 @@
 #include <Tanker/EncryptCacheMetadata.hpp>
 #include <Tanker/Encryptor.hpp>
 #include <Tanker/Streams/TransparentSessionHeader.hpp>
+#include <Tanker/WorkerPool.hpp>
 
 #include <gsl/gsl-lite.hpp>
 #include <tconcurrent/coroutine.hpp>
 
 #include <cstdint>
+#include <functional>
 
 namespace Tanker
 {
@@ -44,13 +46,16 @@ public:
   static Crypto::SymmetricKey deriveSubkey(Crypto::SymmetricKey const& sessionKey,
                                            Crypto::SubkeySeed const& subkeySeed);
 
+  // Chunks are independent, when a workerPool is given they are encrypted and
+  // decrypted in parallel on its threads
   static tc::cotask<EncryptCacheMetadata> encrypt(
       gsl::span<std::uint8_t> encryptedData,
       gsl::span<std::uint8_t const> clearData,
       Crypto::SimpleResourceId const& sessionId,
       Crypto::SymmetricKey const& sessionKey,
       std::optional<std::uint32_t> paddingStep,
-      std::uint32_t encryptedChunkSize = Streams::TransparentSessionHeader::defaultEncryptedChunkSize);
+      std::uint32_t encryptedChunkSize = Streams::TransparentSessionHeader::defaultEncryptedChunkSize,
+      WorkerPool* workerPool = nullptr);
   static tc::cotask<EncryptCacheMetadata> encrypt(
       gsl::span<std::uint8_t> encryptedData,
       gsl::span<std::uint8_t const> clearData,
@@ -58,10 +63,38 @@ public:
       Crypto::SymmetricKey const& sessionKey,
       Crypto::SubkeySeed const& subkeySeed,
       std::optional<std::uint32_t> paddingStep,
-      std::uint32_t encryptedChunkSize = Streams::TransparentSessionHeader::defaultEncryptedChunkSize);
+      std::uint32_t encryptedChunkSize = Streams::TransparentSessionHeader::defaultEncryptedChunkSize,
+      WorkerPool* workerPool = nullptr);
   static tc::cotask<std::uint64_t> decrypt(gsl::span<std::uint8_t> decryptedData,
                                            Encryptor::ResourceKeyFinder const& keyFinder,
-                                           gsl::span<std::uint8_t const> encryptedData);
+                                           gsl::span<std::uint8_t const> encryptedData,
+                                           WorkerPool* workerPool = nullptr);
   static Crypto::CompositeResourceId extractResourceId(gsl::span<std::uint8_t const> encryptedData);
+
+  // Encrypts or decrypts a chunk: (key, iv, output, input, associatedData)
+  using ChunkCipher = std::function<void(Crypto::SymmetricKey const&,
+                                         gsl::span<std::uint8_t const>,
+                                         gsl::span<std::uint8_t>,
+                                         gsl::span<std::uint8_t const>,
+                                         gsl::span<std::uint8_t const>)>;
+
+  // The chunk layout of this format, EncryptorV12 uses it with another AEAD
+  // and version
+  static tc::cotask<EncryptCacheMetadata> encryptChunks(std::uint32_t version,
+                                                        ChunkCipher const& encryptChunk,
+                                                        gsl::span<std::uint8_t> encryptedData,
+                                                        gsl::span<std::uint8_t const> clearData,
+                                                        Crypto::SimpleResourceId const& sessionId,
+                                                        Crypto::SymmetricKey const& sessionKey,
+                                                        Crypto::SubkeySeed const& subkeySeed,
+                                                        std::optional<std::uint32_t> paddingStep,
+                                                        std::uint32_t encryptedChunkSize,
+                                                        WorkerPool* workerPool);
+  static tc::cotask<std::uint64_t> decryptChunks(std::uint32_t version,
+                                                 ChunkCipher const& decryptChunk,
+                                                 gsl::span<std::uint8_t> decryptedData,
+                                                 Encryptor::ResourceKeyFinder const& keyFinder,
+                                                 gsl::span<std::uint8_t const> encryptedData,
+                                                 WorkerPool* workerPool);
 };
 }
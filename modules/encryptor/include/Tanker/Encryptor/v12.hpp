@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Tanker/Crypto/SimpleResourceId.hpp>
+#include <Tanker/Crypto/SubkeySeed.hpp>
+#include <Tanker/EncryptCacheMetadata.hpp>
+#include <Tanker/Encryptor.hpp>
+#include <Tanker/Encryptor/v11.hpp>
+#include <Tanker/Streams/TransparentSessionHeader.hpp>
+#include <Tanker/WorkerPool.hpp>
+
+#include <gsl/gsl-lite.hpp>
+#include <tconcurrent/coroutine.hpp>
+
+#include <cstdint>
+
+namespace Tanker
+{
+// Same layout as EncryptorV11, with AES-256-GCM instead of XChaCha20-Poly1305
+class EncryptorV12
+{
+public:
+  static constexpr auto paddingSizeSize = EncryptorV11::paddingSizeSize;
+  static constexpr auto macDataSize = EncryptorV11::macDataSize;
+  static constexpr auto chunkOverhead = EncryptorV11::chunkOverhead;
+
+  static constexpr std::uint32_t version()
+  {
+    return 12u;
+  }
+
+  static std::uint64_t encryptedSize(
+      std::uint64_t clearSize,
+      std::optional<std::uint32_t> paddingStep,
+      std::uint32_t encryptedChunkSize = Streams::TransparentSessionHeader::defaultEncryptedChunkSize);
+  static std::uint64_t decryptedSize(gsl::span<std::uint8_t const> encryptedData);
+
+  static std::array<uint8_t, macDataSize> makeMacData(Crypto::SimpleResourceId const& sessionId,
+                                                      Crypto::SubkeySeed const& subkeySeed,
+                                                      std::uint32_t chunkSize);
+
+  static tc::cotask<EncryptCacheMetadata> encrypt(
+      gsl::span<std::uint8_t> encryptedData,
+      gsl::span<std::uint8_t const> clearData,
+      Crypto::SimpleResourceId const& sessionId,
+      Crypto::SymmetricKey const& sessionKey,
+      std::optional<std::uint32_t> paddingStep,
+      std::uint32_t encryptedChunkSize = Streams::TransparentSessionHeader::defaultEncryptedChunkSize,
+      WorkerPool* workerPool = nullptr);
+  static tc::cotask<EncryptCacheMetadata> encrypt(
+      gsl::span<std::uint8_t> encryptedData,
+      gsl::span<std::uint8_t const> clearData,
+      Crypto::SimpleResourceId const& sessionId,
+      Crypto::SymmetricKey const& sessionKey,
+      Crypto::SubkeySeed const& subkeySeed,
+      std::optional<std::uint32_t> paddingStep,
+      std::uint32_t encryptedChunkSize = Streams::TransparentSessionHeader::defaultEncryptedChunkSize,
+      WorkerPool* workerPool = nullptr);
+  static tc::cotask<std::uint64_t> decrypt(gsl::span<std::uint8_t> decryptedData,
+                                           Encryptor::ResourceKeyFinder const& keyFinder,
+                                           gsl::span<std::uint8_t const> encryptedData,
+                                           WorkerPool* workerPool = nullptr);
+  static Crypto::CompositeResourceId extractResourceId(gsl::span<std::uint8_t const> encryptedData);
+};
+}
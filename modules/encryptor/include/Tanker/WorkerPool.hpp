@@ -0,0 +1,40 @@
+#pragma once
+
+#include <tconcurrent/coroutine.hpp>
+#include <tconcurrent/executor.hpp>
+#include <tconcurrent/thread_pool.hpp>
+
+#include <cstddef>
+#include <functional>
+
+namespace Tanker
+{
+/// Threads dedicated to CPU-bound work (chunk encryption, key sealing), so that
+/// it can be spread over several cores without blocking the event loop
+class WorkerPool
+{
+public:
+  explicit WorkerPool(unsigned int threadCount);
+  WorkerPool(WorkerPool const&) = delete;
+  WorkerPool& operator=(WorkerPool const&) = delete;
+  ~WorkerPool();
+
+  unsigned int threadCount() const;
+  tc::executor executor();
+
+private:
+  unsigned int _threadCount;
+  tc::thread_pool _threadPool;
+};
+
+using SliceFunction = std::function<void(std::size_t begin, std::size_t end)>;
+
+/// Splits [0, count) into contiguous slices, one per worker thread, and calls
+/// f(begin, end) for each of them. Everything runs on the calling thread when
+/// workerPool is null.
+///
+/// Waits for all the slices to finish before rethrowing the first error.
+tc::cotask<void> parallelForSlices(WorkerPool* workerPool, std::size_t count, SliceFunction const& f);
+/// Same as parallelForSlices, but calls f(i) for each i in [0, count)
+tc::cotask<void> parallelFor(WorkerPool* workerPool, std::size_t count, std::function<void(std::size_t)> const& f);
+}
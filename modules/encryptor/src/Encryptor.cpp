@@ -4,6 +4,7 @@
 #include <Tanker/Crypto/Padding.hpp>
 #include <Tanker/Encryptor/v10.hpp>
 #include <Tanker/Encryptor/v11.hpp>
+#include <Tanker/Encryptor/v12.hpp>
 #include <Tanker/Encryptor/v2.hpp>
 #include <Tanker/Encryptor/v3.hpp>
 #include <Tanker/Encryptor/v4.hpp>
@@ -17,6 +18,9 @@
 #include <Tanker/Serialization/Errors/Errc.hpp>
 
 #include <Tanker/Streams/Header.hpp>
+#include <Tanker/Streams/TransparentSessionHeader.hpp>
+
+#include <type_traits>
 
 using Tanker::Crypto::ResourceId;
 
@@ -28,8 +32,6 @@ namespace Encryptor
 {
 namespace
 {
-constexpr auto STREAM_THRESHOLD = 1024 * 1024;
-
 template <typename Callable>
 decltype(auto) performEncryptorAction(std::uint32_t version, Callable&& cb)
 {
@@ -55,22 +57,36 @@ decltype(auto) performEncryptorAction(std::uint32_t version, Callable&& cb)
     return std::forward<Callable>(cb)(EncryptorV10{});
   case EncryptorV11::version():
     return std::forward<Callable>(cb)(EncryptorV11{});
+  case EncryptorV12::version():
+    return std::forward<Callable>(cb)(EncryptorV12{});
   default:
     throw Errors::formatEx(Errc::InvalidArgument, "Unhandled format version {} used in encryptedData", version);
   }
 }
 }
 
-bool isHugeClearData(uint64_t dataSize, std::optional<uint32_t> paddingStep)
+void checkStreamOptions(StreamOptions const& options)
+{
+  // Each chunk must hold at least one byte of clear data
+  if (options.encryptedChunkSize <= EncryptorV11::chunkOverhead)
+    throw formatEx(Errc::InvalidArgument,
+                   "encrypted chunk size must be greater than {}, got {}",
+                   EncryptorV11::chunkOverhead,
+                   options.encryptedChunkSize);
+}
+
+bool isHugeClearData(uint64_t dataSize, std::optional<uint32_t> paddingStep, uint64_t streamThreshold)
 {
-  return Padding::paddedFromClearSize(dataSize, paddingStep) >= STREAM_THRESHOLD;
+  return Padding::paddedFromClearSize(dataSize, paddingStep) >= streamThreshold;
 }
 
-uint64_t encryptedSize(uint64_t clearSize, std::optional<uint32_t> paddingStep)
+uint64_t encryptedSize(uint64_t clearSize, std::optional<uint32_t> paddingStep, StreamOptions const& streamOptions)
 {
-  if (isHugeClearData(clearSize, paddingStep))
+  checkStreamOptions(streamOptions);
+  // V12 has the same layout as V11
+  if (isHugeClearData(clearSize, paddingStep, streamOptions.streamThreshold))
   {
-    return EncryptorV11::encryptedSize(clearSize, paddingStep);
+    return EncryptorV11::encryptedSize(clearSize, paddingStep, streamOptions.encryptedChunkSize);
   }
   else
   {
@@ -95,12 +111,30 @@ tc::cotask<EncryptCacheMetadata> encrypt(gsl::span<uint8_t> encryptedData,
                                          gsl::span<uint8_t const> clearData,
                                          std::optional<uint32_t> paddingStep,
                                          Crypto::SimpleResourceId sessionId,
-                                         Crypto::SymmetricKey sessionKey)
+                                         Crypto::SymmetricKey sessionKey,
+                                         WorkerPool* workerPool,
+                                         StreamOptions const& streamOptions)
 {
   auto seed = Crypto::getRandom<Crypto::SubkeySeed>();
-  if (isHugeClearData(clearData.size(), paddingStep))
+  if (isHugeClearData(clearData.size(), paddingStep, streamOptions.streamThreshold))
   {
-    TC_RETURN(TC_AWAIT(EncryptorV11::encrypt(encryptedData, clearData, sessionId, sessionKey, seed, paddingStep)));
+    if (streamOptions.aes256Gcm)
+      TC_RETURN(TC_AWAIT(EncryptorV12::encrypt(encryptedData,
+                                               clearData,
+                                               sessionId,
+                                               sessionKey,
+                                               seed,
+                                               paddingStep,
+                                               streamOptions.encryptedChunkSize,
+                                               workerPool)));
+    TC_RETURN(TC_AWAIT(EncryptorV11::encrypt(encryptedData,
+                                             clearData,
+                                             sessionId,
+                                             sessionKey,
+                                             seed,
+                                             paddingStep,
+                                             streamOptions.encryptedChunkSize,
+                                             workerPool)));
   }
   else
   {
@@ -113,7 +147,8 @@ tc::cotask<EncryptCacheMetadata> encrypt(gsl::span<uint8_t> encryptedData,
 
 tc::cotask<uint64_t> decrypt(gsl::span<uint8_t> decryptedData,
                              ResourceKeyFinder const& keyFinder,
-                             gsl::span<uint8_t const> encryptedData)
+                             gsl::span<uint8_t const> encryptedData,
+                             WorkerPool* workerPool)
 {
   if (encryptedData.empty())
     throw Errors::formatEx(Errors::Errc::InvalidArgument, "encrypted data is empty");
@@ -121,15 +156,25 @@ tc::cotask<uint64_t> decrypt(gsl::span<uint8_t> decryptedData,
   auto const version = encryptedData[0];
 
   TC_RETURN(TC_AWAIT(performEncryptorAction(version, [&](auto encryptor) -> tc::cotask<uint64_t> {
-    TC_RETURN(TC_AWAIT(encryptor.decrypt(decryptedData, keyFinder, encryptedData)));
+    // Only the chunked format can be split over several threads
+    if constexpr (std::is_same_v<decltype(encryptor), EncryptorV11> ||
+                  std::is_same_v<decltype(encryptor), EncryptorV12>)
+    {
+      TC_RETURN(TC_AWAIT(encryptor.decrypt(decryptedData, keyFinder, encryptedData, workerPool)));
+    }
+    else
+    {
+      TC_RETURN(TC_AWAIT(encryptor.decrypt(decryptedData, keyFinder, encryptedData)));
+    }
   })));
 }
 
 tc::cotask<uint64_t> decrypt(gsl::span<uint8_t> decryptedData,
                              Crypto::SymmetricKey const& key,
-                             gsl::span<uint8_t const> encryptedData)
+                             gsl::span<uint8_t const> encryptedData,
+                             WorkerPool* workerPool)
 {
-  TC_RETURN(TC_AWAIT(decrypt(decryptedData, fixedKeyFinder(key), encryptedData)));
+  TC_RETURN(TC_AWAIT(decrypt(decryptedData, fixedKeyFinder(key), encryptedData, workerPool)));
 }
 
 ResourceId extractResourceId(gsl::span<uint8_t const> encryptedData)
@@ -3,17 +3,19 @@
 #include <Tanker/Crypto/Crypto.hpp>
 #include <Tanker/Crypto/Padding.hpp>
 #include <Tanker/Crypto/SubkeySeed.hpp>
+#include <Tanker/Errors/AssertionError.hpp>
 #include <Tanker/Errors/Errc.hpp>
 #include <Tanker/Errors/Exception.hpp>
 #include <Tanker/Serialization/Serialization.hpp>
-#include <Tanker/Streams/DecryptionStreamV11.hpp>
-#include <Tanker/Streams/EncryptionStreamV11.hpp>
-#include <Tanker/Streams/Helpers.hpp>
 #include <Tanker/Streams/TransparentSessionHeader.hpp>
 
+#include <fmt/format.h>
 #include <sodium/randombytes.h>
 #include <tconcurrent/coroutine.hpp>
 
+#include <algorithm>
+#include <cstring>
+
 using namespace Tanker::Errors;
 using namespace Tanker::Streams;
 using namespace Tanker::Crypto;
@@ -26,6 +28,51 @@ namespace Tanker
 // N * chunk of chunkSize:
 // content: [padding size, 4B] [ciphertext, chunkSize-16] [MAC, 16B]
 
+namespace
+{
+AeadIv makeSeedIv(SimpleResourceId const& sessionId)
+{
+  AeadIv seedIv{};
+  std::copy(sessionId.begin(), sessionId.end(), seedIv.begin());
+  return seedIv;
+}
+
+TransparentSessionHeader deserializeHeader(gsl::span<std::uint8_t const> encryptedData)
+try
+{
+  if (encryptedData.size() < TransparentSessionHeader::serializedSize)
+    throw Errors::Exception(make_error_code(Errors::Errc::DecryptionFailed),
+                            "truncated buffer: could not read encrypted input header");
+  return Serialization::deserialize<TransparentSessionHeader>(
+      encryptedData.first(TransparentSessionHeader::serializedSize));
+}
+catch (Errors::Exception const& e)
+{
+  if (e.errorCode() == Errors::Errc::InvalidArgument)
+    throw Errors::Exception(make_error_code(Errors::Errc::DecryptionFailed), e.what());
+  throw;
+}
+
+std::array<uint8_t, EncryptorV11::macDataSize> makeVersionedMacData(std::uint32_t version,
+                                                                    SimpleResourceId const& sessionId,
+                                                                    SubkeySeed const& subkeySeed,
+                                                                    std::uint32_t chunkSize)
+{
+  auto macData = EncryptorV11::makeMacData(sessionId, subkeySeed, chunkSize);
+  macData[0] = version;
+  return macData;
+}
+
+tc::cotask<std::optional<SymmetricKey>> findSubkey(Encryptor::ResourceKeyFinder const& keyFinder,
+                                                   TransparentSessionHeader const& header)
+{
+  auto const resId = header.resourceId().individualResourceId();
+  if (auto key = TC_AWAIT(keyFinder(header.resourceId().sessionId())); key)
+    TC_RETURN(EncryptorV11::deriveSubkey(*key, SubkeySeed{resId}));
+  TC_RETURN(TC_AWAIT(keyFinder(resId)));
+}
+}
+
 std::uint64_t EncryptorV11::encryptedSize(std::uint64_t clearSize,
                                           std::optional<std::uint32_t> paddingStep,
                                           std::uint32_t encryptedChunkSize)
@@ -84,10 +131,17 @@ tc::cotask<EncryptCacheMetadata> EncryptorV11::encrypt(gsl::span<std::uint8_t> e
                                                        Crypto::SimpleResourceId const& sessionId,
                                                        Crypto::SymmetricKey const& sessionKey,
                                                        std::optional<std::uint32_t> paddingStep,
-                                                       std::uint32_t encryptedChunkSize)
+                                                       std::uint32_t encryptedChunkSize,
+                                                       WorkerPool* workerPool)
 {
-  TC_RETURN(TC_AWAIT(encrypt(
-      encryptedData, clearData, sessionId, sessionKey, getRandom<SubkeySeed>(), paddingStep, encryptedChunkSize)));
+  TC_RETURN(TC_AWAIT(encrypt(encryptedData,
+                             clearData,
+                             sessionId,
+                             sessionKey,
+                             getRandom<SubkeySeed>(),
+                             paddingStep,
+                             encryptedChunkSize,
+                             workerPool)));
 }
 
 tc::cotask<EncryptCacheMetadata> EncryptorV11::encrypt(gsl::span<std::uint8_t> encryptedData,
@@ -96,30 +150,38 @@ tc::cotask<EncryptCacheMetadata> EncryptorV11::encrypt(gsl::span<std::uint8_t> e
                                                        Crypto::SymmetricKey const& sessionKey,
                                                        Crypto::SubkeySeed const& subkeySeed,
                                                        std::optional<std::uint32_t> paddingStep,
-                                                       std::uint32_t encryptedChunkSize)
+                                                       std::uint32_t encryptedChunkSize,
+                                                       WorkerPool* workerPool)
 {
-  EncryptionStreamV11 encryptor(
-      bufferViewToInputSource(clearData), sessionId, sessionKey, subkeySeed, paddingStep, encryptedChunkSize);
-
-  while (auto const nbRead = TC_AWAIT(encryptor(encryptedData)))
-    encryptedData = encryptedData.subspan(nbRead);
-
-  TC_RETURN((EncryptCacheMetadata{encryptor.resourceId().sessionId(), encryptor.symmetricKey()}));
+  TC_RETURN(TC_AWAIT(encryptChunks(
+      version(),
+      [](auto const& key, auto iv, auto encryptedChunk, auto clearChunk, auto associatedData) {
+        encryptAead(key, iv, encryptedChunk, clearChunk, associatedData);
+      },
+      encryptedData,
+      clearData,
+      sessionId,
+      sessionKey,
+      subkeySeed,
+      paddingStep,
+      encryptedChunkSize,
+      workerPool)));
 }
 
 tc::cotask<std::uint64_t> EncryptorV11::decrypt(gsl::span<std::uint8_t> decryptedData,
                                                 Encryptor::ResourceKeyFinder const& keyFinder,
-                                                gsl::span<std::uint8_t const> encryptedData)
+                                                gsl::span<std::uint8_t const> encryptedData,
+                                                WorkerPool* workerPool)
 {
-  auto const initialSize = decryptedData.size();
-
-  auto decryptor = TC_AWAIT(DecryptionStreamV11::create(bufferViewToInputSource(encryptedData), keyFinder));
-
-  while (auto const nbRead = TC_AWAIT(decryptor(decryptedData)))
-    decryptedData = decryptedData.subspan(nbRead);
-
-  // Remove padding
-  TC_RETURN(initialSize - decryptedData.size());
+  TC_RETURN(TC_AWAIT(decryptChunks(
+      version(),
+      [](auto const& key, auto iv, auto clearChunk, auto encryptedChunk, auto associatedData) {
+        decryptAead(key, iv, clearChunk, encryptedChunk, associatedData);
+      },
+      decryptedData,
+      keyFinder,
+      encryptedData,
+      workerPool)));
 }
 
 CompositeResourceId EncryptorV11::extractResourceId(gsl::span<std::uint8_t const> encryptedData)
@@ -127,4 +189,158 @@ CompositeResourceId EncryptorV11::extractResourceId(gsl::span<std::uint8_t const
   Serialization::SerializedSource ss{encryptedData};
   return Serialization::deserialize<TransparentSessionHeader>(ss).resourceId();
 }
+
+tc::cotask<EncryptCacheMetadata> EncryptorV11::encryptChunks(std::uint32_t version,
+                                                             ChunkCipher const& encryptChunk,
+                                                             gsl::span<std::uint8_t> encryptedData,
+                                                             gsl::span<std::uint8_t const> clearData,
+                                                             Crypto::SimpleResourceId const& sessionId,
+                                                             Crypto::SymmetricKey const& sessionKey,
+                                                             Crypto::SubkeySeed const& subkeySeed,
+                                                             std::optional<std::uint32_t> paddingStep,
+                                                             std::uint32_t encryptedChunkSize,
+                                                             WorkerPool* workerPool)
+{
+  if (encryptedChunkSize <= chunkOverhead)
+    throw Errors::AssertionError("invalid encrypted chunk size");
+  if (encryptedData.size() < encryptedSize(clearData.size(), paddingStep, encryptedChunkSize))
+    throw Errors::AssertionError(fmt::format("EncryptorV{}: encryptedData buffer is too short", version));
+
+  auto const resourceId = CompositeResourceId::newTransparentSessionId(sessionId, SimpleResourceId{subkeySeed});
+  TransparentSessionHeader const header(version, encryptedChunkSize, resourceId);
+  Serialization::serialize(encryptedData.data(), header);
+
+  auto const associatedData = makeVersionedMacData(version, sessionId, subkeySeed, encryptedChunkSize);
+  auto const subkey = deriveSubkey(sessionKey, subkeySeed);
+  auto const seedIv = makeSeedIv(sessionId);
+
+  // The padded content is laid out contiguously across chunks: the clear data
+  // followed by the padding. Each chunk holds clearChunkSize bytes of it, and
+  // the last chunk is the first one that is not full (it can be empty).
+  std::uint64_t const clearChunkSize = encryptedChunkSize - chunkOverhead;
+  std::uint64_t const clearSize = clearData.size();
+  auto const paddedSize = Padding::paddedFromClearSize(clearSize, paddingStep) - 1;
+  auto const nbChunks = paddedSize / clearChunkSize + 1;
+
+  auto const output = encryptedData.subspan(TransparentSessionHeader::serializedSize);
+  TC_AWAIT(parallelFor(workerPool, nbChunks, [&](std::uint64_t chunkIndex) {
+    auto const contentBegin = chunkIndex * clearChunkSize;
+    auto const contentSize = std::min(clearChunkSize, paddedSize - contentBegin);
+    auto const dataBegin = std::min(contentBegin, clearSize);
+    auto const dataSize = std::min(clearSize, contentBegin + contentSize) - dataBegin;
+    auto const paddingSize = contentSize - dataSize;
+
+    // Lay out [padding size][padding][clear data] where the ciphertext goes,
+    // and encrypt it in place
+    auto const chunk =
+        output.subspan(chunkIndex * encryptedChunkSize, paddingSizeSize + contentSize + Mac::arraySize);
+    auto const clearChunk = chunk.first(paddingSizeSize + contentSize);
+    auto it = Serialization::serialize<uint32_t>(clearChunk.data(), paddingSize);
+    it = std::fill_n(it, paddingSize, 0);
+    std::copy_n(clearData.data() + dataBegin, dataSize, it);
+
+    encryptChunk(subkey, deriveIv(seedIv, chunkIndex), chunk, clearChunk, associatedData);
+  }));
+
+  TC_RETURN((EncryptCacheMetadata{sessionId, sessionKey}));
+}
+
+tc::cotask<std::uint64_t> EncryptorV11::decryptChunks(std::uint32_t version,
+                                                      ChunkCipher const& decryptChunk,
+                                                      gsl::span<std::uint8_t> decryptedData,
+                                                      Encryptor::ResourceKeyFinder const& keyFinder,
+                                                      gsl::span<std::uint8_t const> encryptedData,
+                                                      WorkerPool* workerPool)
+{
+  auto const header = deserializeHeader(encryptedData);
+  auto const key = TC_AWAIT(findSubkey(keyFinder, header));
+  if (!key)
+    throw Errors::formatEx(Errors::Errc::InvalidArgument, "key not found for resource: {:s}", header.resourceId());
+
+  auto const& resourceId = header.resourceId();
+  auto const associatedData = makeVersionedMacData(
+      version, resourceId.sessionId(), SubkeySeed{resourceId.individualResourceId()}, header.encryptedChunkSize());
+  auto const seedIv = makeSeedIv(resourceId.sessionId());
+
+  // Only the last chunk is smaller than encryptedChunkSize, it can be empty
+  // but it must be there
+  auto const input = encryptedData.subspan(TransparentSessionHeader::serializedSize);
+  std::uint64_t const encryptedChunkSize = header.encryptedChunkSize();
+  auto const nbChunks = input.size() / encryptedChunkSize + 1;
+  auto const lastEncryptedChunkSize = input.size() % encryptedChunkSize;
+  if (lastEncryptedChunkSize < chunkOverhead)
+    throw Errors::Exception(make_error_code(Errors::Errc::DecryptionFailed),
+                            "truncated buffer: missing chunk metadata");
+
+  // Until the padding starts, chunk i holds clear data at offset
+  // i * clearChunkSize. Each chunk is decrypted there, and the padding is
+  // checked afterwards.
+  std::uint64_t const clearChunkSize = encryptedChunkSize - chunkOverhead;
+  if ((nbChunks - 1) * clearChunkSize + lastEncryptedChunkSize - chunkOverhead > decryptedData.size())
+    throw Errors::AssertionError(fmt::format("EncryptorV{}: decryptedData buffer is too short", version));
+
+  std::vector<std::uint32_t> paddingSizes(nbChunks);
+  TC_AWAIT(parallelForSlices(workerPool, nbChunks, [&](std::uint64_t sliceBegin, std::uint64_t sliceEnd) {
+    std::vector<std::uint8_t> scratch;
+    for (auto chunkIndex = sliceBegin; chunkIndex < sliceEnd; ++chunkIndex)
+    {
+      auto const chunk = input.subspan(chunkIndex * encryptedChunkSize,
+                                       std::min(encryptedChunkSize, input.size() - chunkIndex * encryptedChunkSize));
+      auto const decryptedChunkSize = chunk.size() - Mac::arraySize;
+      auto const clearOffset = chunkIndex * clearChunkSize;
+
+      // Decrypt the chunk so that its clear data lands where it belongs. The
+      // padding size field then overwrites the end of the previous chunk,
+      // which is saved and restored afterwards. The first chunk of a slice
+      // must not touch what other slices are working on.
+      std::array<std::uint8_t, paddingSizeSize> overwritten;
+      gsl::span<std::uint8_t> clearChunk;
+      auto const inPlace = chunkIndex != sliceBegin;
+      if (inPlace)
+      {
+        clearChunk = decryptedData.subspan(clearOffset - paddingSizeSize, decryptedChunkSize);
+        std::copy_n(clearChunk.data(), paddingSizeSize, overwritten.data());
+      }
+      else if ((chunkIndex + 1 < sliceEnd || sliceEnd == nbChunks) &&
+               clearOffset + decryptedChunkSize <= decryptedData.size())
+      {
+        clearChunk = decryptedData.subspan(clearOffset, decryptedChunkSize);
+      }
+      else
+      {
+        scratch.resize(decryptedChunkSize);
+        clearChunk = scratch;
+      }
+      decryptChunk(*key, deriveIv(seedIv, chunkIndex), clearChunk, chunk, associatedData);
+
+      auto const paddingSize = Serialization::deserialize<uint32_t>(clearChunk.first(paddingSizeSize));
+      if (decryptedChunkSize - paddingSizeSize < paddingSize)
+        throw Errors::Exception(make_error_code(Errors::Errc::DecryptionFailed), "invalid padding size value");
+      auto const unpadded = clearChunk.subspan(paddingSizeSize + paddingSize);
+
+      if (unpadded.data() != decryptedData.data() + clearOffset)
+        std::memmove(decryptedData.data() + clearOffset, unpadded.data(), unpadded.size());
+      if (inPlace)
+        std::copy(overwritten.begin(), overwritten.end(), clearChunk.data());
+      paddingSizes[chunkIndex] = paddingSize;
+    }
+  }));
+
+  // Once the padding has started, chunks must not contain data anymore
+  std::uint64_t written = 0;
+  auto onlyPaddingLeft = false;
+  for (std::uint64_t chunkIndex = 0; chunkIndex < nbChunks; ++chunkIndex)
+  {
+    auto const contentSize = chunkIndex + 1 < nbChunks ? clearChunkSize : lastEncryptedChunkSize - chunkOverhead;
+    auto const dataSize = contentSize - paddingSizes[chunkIndex];
+
+    if (onlyPaddingLeft && dataSize != 0)
+      throw Errors::formatEx(Errors::Errc::DecryptionFailed, "invalid padding");
+    else if (paddingSizes[chunkIndex])
+      onlyPaddingLeft = true;
+    written += dataSize;
+  }
+
+  TC_RETURN(written);
+}
 }
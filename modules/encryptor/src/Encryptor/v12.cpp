@@ -0,0 +1,115 @@
+#include <Tanker/Encryptor/v12.hpp>
+
+#include <Tanker/Crypto/Crypto.hpp>
+#include <Tanker/Crypto/SubkeySeed.hpp>
+#include <Tanker/Serialization/Serialization.hpp>
+#include <Tanker/Streams/TransparentSessionHeader.hpp>
+
+#include <tconcurrent/coroutine.hpp>
+
+using namespace Tanker::Streams;
+using namespace Tanker::Crypto;
+
+namespace Tanker
+{
+// version 12 format layout, the same as version 11:
+// header: [version, 1B] [session id, 16B] [resource id/seed, 16B]
+// [chunk size, 4B]
+// N * chunk of chunkSize:
+// content: [padding size, 4B] [ciphertext, chunkSize-16] [MAC, 16B]
+// Chunks are encrypted with AES-256-GCM, and their IV is the beginning of the
+// version 11 one.
+
+namespace
+{
+gsl::span<std::uint8_t const> chunkIv(gsl::span<std::uint8_t const> derivedIv)
+{
+  return derivedIv.first(aes256GcmIvSize);
+}
+}
+
+std::uint64_t EncryptorV12::encryptedSize(std::uint64_t clearSize,
+                                          std::optional<std::uint32_t> paddingStep,
+                                          std::uint32_t encryptedChunkSize)
+{
+  return EncryptorV11::encryptedSize(clearSize, paddingStep, encryptedChunkSize);
+}
+
+std::uint64_t EncryptorV12::decryptedSize(gsl::span<std::uint8_t const> encryptedData)
+{
+  return EncryptorV11::decryptedSize(encryptedData);
+}
+
+std::array<uint8_t, EncryptorV12::macDataSize> EncryptorV12::makeMacData(SimpleResourceId const& sessionId,
+                                                                         SubkeySeed const& subkeySeed,
+                                                                         std::uint32_t chunkSize)
+{
+  auto macData = EncryptorV11::makeMacData(sessionId, subkeySeed, chunkSize);
+  macData[0] = version();
+  return macData;
+}
+
+tc::cotask<EncryptCacheMetadata> EncryptorV12::encrypt(gsl::span<std::uint8_t> encryptedData,
+                                                       gsl::span<std::uint8_t const> clearData,
+                                                       Crypto::SimpleResourceId const& sessionId,
+                                                       Crypto::SymmetricKey const& sessionKey,
+                                                       std::optional<std::uint32_t> paddingStep,
+                                                       std::uint32_t encryptedChunkSize,
+                                                       WorkerPool* workerPool)
+{
+  TC_RETURN(TC_AWAIT(encrypt(encryptedData,
+                             clearData,
+                             sessionId,
+                             sessionKey,
+                             getRandom<SubkeySeed>(),
+                             paddingStep,
+                             encryptedChunkSize,
+                             workerPool)));
+}
+
+tc::cotask<EncryptCacheMetadata> EncryptorV12::encrypt(gsl::span<std::uint8_t> encryptedData,
+                                                       gsl::span<std::uint8_t const> clearData,
+                                                       Crypto::SimpleResourceId const& sessionId,
+                                                       Crypto::SymmetricKey const& sessionKey,
+                                                       Crypto::SubkeySeed const& subkeySeed,
+                                                       std::optional<std::uint32_t> paddingStep,
+                                                       std::uint32_t encryptedChunkSize,
+                                                       WorkerPool* workerPool)
+{
+  TC_RETURN(TC_AWAIT(EncryptorV11::encryptChunks(
+      version(),
+      [](auto const& key, auto iv, auto encryptedChunk, auto clearChunk, auto associatedData) {
+        encryptAeadAes256Gcm(key, chunkIv(iv), encryptedChunk, clearChunk, associatedData);
+      },
+      encryptedData,
+      clearData,
+      sessionId,
+      sessionKey,
+      subkeySeed,
+      paddingStep,
+      encryptedChunkSize,
+      workerPool)));
+}
+
+tc::cotask<std::uint64_t> EncryptorV12::decrypt(gsl::span<std::uint8_t> decryptedData,
+                                                Encryptor::ResourceKeyFinder const& keyFinder,
+                                                gsl::span<std::uint8_t const> encryptedData,
+                                                WorkerPool* workerPool)
+{
+  TC_RETURN(TC_AWAIT(EncryptorV11::decryptChunks(
+      version(),
+      [](auto const& key, auto iv, auto clearChunk, auto encryptedChunk, auto associatedData) {
+        decryptAeadAes256Gcm(key, chunkIv(iv), clearChunk, encryptedChunk, associatedData);
+      },
+      decryptedData,
+      keyFinder,
+      encryptedData,
+      workerPool)));
+}
+
+CompositeResourceId EncryptorV12::extractResourceId(gsl::span<std::uint8_t const> encryptedData)
+{
+  Serialization::SerializedSource ss{encryptedData};
+  return Serialization::deserialize<TransparentSessionHeader>(ss).resourceId();
+}
+}
@@ -0,0 +1,69 @@
+#include <Tanker/WorkerPool.hpp>
+
+#include <Tanker/Errors/AssertionError.hpp>
+
+#include <tconcurrent/async.hpp>
+#include <tconcurrent/when.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace Tanker
+{
+WorkerPool::WorkerPool(unsigned int threadCount) : _threadCount(threadCount)
+{
+  if (threadCount == 0)
+    throw Errors::AssertionError("WorkerPool needs at least one thread");
+  _threadPool.start(threadCount);
+}
+
+WorkerPool::~WorkerPool()
+{
+  _threadPool.stop();
+}
+
+unsigned int WorkerPool::threadCount() const
+{
+  return _threadCount;
+}
+
+tc::executor WorkerPool::executor()
+{
+  return tc::executor(_threadPool);
+}
+
+tc::cotask<void> parallelForSlices(WorkerPool* workerPool, std::size_t count, SliceFunction const& f)
+{
+  auto const nbSlices = workerPool ? std::min<std::size_t>(workerPool->threadCount(), count) : 1;
+  if (nbSlices <= 1)
+  {
+    if (count)
+      f(0, count);
+    TC_RETURN();
+  }
+
+  std::vector<tc::future<void>> futures;
+  futures.reserve(nbSlices);
+  for (std::size_t slice = 0; slice < nbSlices; ++slice)
+  {
+    auto const begin = count * slice / nbSlices;
+    auto const end = count * (slice + 1) / nbSlices;
+    futures.push_back(tc::async(workerPool->executor(), [&f, begin, end] { f(begin, end); }));
+  }
+
+  // The slices work on data owned by the caller, do not return before all of
+  // them are done, even when one of them failed
+  auto done = TC_AWAIT(tc::when_all(std::make_move_iterator(futures.begin()), std::make_move_iterator(futures.end())));
+  for (auto& future : done)
+    future.get();
+}
+
+tc::cotask<void> parallelFor(WorkerPool* workerPool, std::size_t count, std::function<void(std::size_t)> const& f)
+{
+  TC_AWAIT(parallelForSlices(workerPool, count, [&](std::size_t begin, std::size_t end) {
+    for (auto i = begin; i < end; ++i)
+      f(i);
+  }));
+}
+}
@@ -2,9 +2,14 @@
 #include <Tanker/Crypto/Mac.hpp>
 #include <Tanker/Crypto/Padding.hpp>
 #include <Tanker/Encryptor.hpp>
+#include <Tanker/Encryptor/v12.hpp>
 #include <Tanker/Errors/AssertionError.hpp>
 #include <Tanker/Errors/Errc.hpp>
 #include <Tanker/Serialization/Serialization.hpp>
+#include <Tanker/Streams/DecryptionStreamV11.hpp>
+#include <Tanker/Streams/EncryptionStreamV11.hpp>
+#include <Tanker/Streams/Helpers.hpp>
+#include <Tanker/WorkerPool.hpp>
 
 #include <Helpers/Await.hpp>
 #include <Helpers/Buffers.hpp>
@@ -15,7 +20,9 @@
 #include <range/v3/view/iota.hpp>
 #include <range/v3/view/zip.hpp>
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
 
 using namespace Tanker;
 using namespace Tanker::Errors;
@@ -36,6 +43,18 @@ std::vector<uint8_t> doDecrypt(Crypto::SymmetricKey const& key, gsl::span<uint8_
   return decryptedData;
 }
 
+std::vector<uint8_t> streamEncryptV11(gsl::span<uint8_t const> clearData,
+                                      SimpleResourceId const& sessionId,
+                                      Crypto::SymmetricKey const& sessionKey,
+                                      Crypto::SubkeySeed const& subkeySeed,
+                                      std::optional<std::uint32_t> paddingStep,
+                                      std::uint32_t encryptedChunkSize)
+{
+  Streams::EncryptionStreamV11 encryptor(
+      Streams::bufferViewToInputSource(clearData), sessionId, sessionKey, subkeySeed, paddingStep, encryptedChunkSize);
+  return AWAIT(Streams::readAllStream(encryptor));
+}
+
 template <typename T>
 void testEncryptDecrypt(TestContext<T> ctx, std::string const& testTitle, std::vector<uint8_t> const& clearData)
 {
@@ -293,6 +312,44 @@ TEST_CASE("extractResourceId should throw when called with an empty buffer")
   TANKER_CHECK_THROWS_WITH_CODE(Encryptor::extractResourceId(encryptedData), Errc::InvalidArgument);
 }
 
+TEST_CASE("Encryptor::encrypt stream options")
+{
+  auto const sessionId = Crypto::getRandom<SimpleResourceId>();
+  auto const sessionKey = Crypto::makeSymmetricKey();
+  std::vector<uint8_t> clearData(5000);
+  Crypto::randomFill(clearData);
+
+  SECTION("uses the chunked format from the stream threshold")
+  {
+    Encryptor::StreamOptions const options{1024, 4096};
+    std::vector<uint8_t> encryptedData(Encryptor::encryptedSize(clearData.size(), Padding::Off, options));
+    AWAIT(Encryptor::encrypt(encryptedData, clearData, Padding::Off, sessionId, sessionKey, nullptr, options));
+
+    CHECK(encryptedData[0] == EncryptorV11::version());
+    CHECK(encryptedData.size() == EncryptorV11::encryptedSize(clearData.size(), Padding::Off, 1024));
+    std::vector<uint8_t> decryptedData(Encryptor::decryptedSize(encryptedData));
+    decryptedData.resize(
+        AWAIT(Encryptor::decrypt(decryptedData, Encryptor::fixedKeyFinder(sessionKey), encryptedData)));
+    CHECK(decryptedData == clearData);
+  }
+
+  SECTION("keeps the simple format under the stream threshold")
+  {
+    Encryptor::StreamOptions const options{1024, 8192};
+    std::vector<uint8_t> encryptedData(Encryptor::encryptedSize(clearData.size(), Padding::Off, options));
+    AWAIT(Encryptor::encrypt(encryptedData, clearData, Padding::Off, sessionId, sessionKey, nullptr, options));
+
+    CHECK(encryptedData[0] == EncryptorV9::version());
+  }
+
+  SECTION("rejects chunks too small to hold data")
+  {
+    TANKER_CHECK_THROWS_WITH_CODE(Encryptor::checkStreamOptions({EncryptorV11::chunkOverhead, 0}),
+                                  Errc::InvalidArgument);
+    CHECK_NOTHROW(Encryptor::checkStreamOptions({EncryptorV11::chunkOverhead + 1, 0}));
+  }
+}
+
 TEST_CASE("EncryptorV2 tests")
 {
   TestContext<EncryptorV2> ctx;
@@ -468,4 +525,338 @@ TEST_CASE("EncryptorV11 tests")
           Streams::TransparentSessionHeader::serializedSize + Padding::paddedFromClearSize(bigSize, paddingStep) - 1 +
               3 * (EncryptorV11::paddingSizeSize + Crypto::Mac::arraySize));
   }
+
+  SECTION("encrypt should give the same output as EncryptionStreamV11")
+  {
+    constexpr std::uint32_t smallChunkSize = 0x46;
+    constexpr int smallClearChunkSize = smallChunkSize - EncryptorV11::chunkOverhead;
+
+    auto const clearSize = GENERATE(0,                       // empty buffer
+                                    2,                       // single chunk
+                                    smallClearChunkSize,     // exactly one chunk (and one empty one)
+                                    smallClearChunkSize + 2, // one chunk and a half
+                                    2 * smallClearChunkSize, // exactly 2 chunks (and one empty one)
+                                    300                      // lots of chunks
+    );
+    auto const paddingStep = GENERATE(values<std::optional<std::uint32_t>>({std::nullopt, 1, 5, 2 * smallChunkSize}));
+    CAPTURE(clearSize);
+    CAPTURE(paddingStep.value_or(0));
+
+    std::vector<uint8_t> clearData(clearSize);
+    Crypto::randomFill(clearData);
+    auto const sessionId = Crypto::getRandom<SimpleResourceId>();
+    auto const sessionKey = Crypto::makeSymmetricKey();
+    auto const subkeySeed = Crypto::getRandom<Crypto::SubkeySeed>();
+
+    std::vector<uint8_t> encryptedData(EncryptorV11::encryptedSize(clearSize, paddingStep, smallChunkSize));
+    AWAIT(EncryptorV11::encrypt(
+        encryptedData, clearData, sessionId, sessionKey, subkeySeed, paddingStep, smallChunkSize));
+
+    CHECK(encryptedData == streamEncryptV11(clearData, sessionId, sessionKey, subkeySeed, paddingStep, smallChunkSize));
+    CHECK(doDecrypt<EncryptorV11>(sessionKey, encryptedData) == clearData);
+  }
+
+  SECTION("encrypt and decrypt should give the same results when spread over threads")
+  {
+    constexpr std::uint32_t smallChunkSize = 0x46;
+    WorkerPool workerPool(4);
+
+    auto const clearSize = GENERATE(0, 2, 300, 1000);
+    auto const paddingStep = GENERATE(values<std::optional<std::uint32_t>>({std::nullopt, 1, 500}));
+    CAPTURE(clearSize);
+    CAPTURE(paddingStep.value_or(0));
+
+    std::vector<uint8_t> clearData(clearSize);
+    Crypto::randomFill(clearData);
+    auto const sessionId = Crypto::getRandom<SimpleResourceId>();
+    auto const sessionKey = Crypto::makeSymmetricKey();
+    auto const subkeySeed = Crypto::getRandom<Crypto::SubkeySeed>();
+
+    std::vector<uint8_t> encryptedData(EncryptorV11::encryptedSize(clearSize, paddingStep, smallChunkSize));
+    AWAIT(EncryptorV11::encrypt(
+        encryptedData, clearData, sessionId, sessionKey, subkeySeed, paddingStep, smallChunkSize, &workerPool));
+    CHECK(encryptedData == streamEncryptV11(clearData, sessionId, sessionKey, subkeySeed, paddingStep, smallChunkSize));
+
+    std::vector<uint8_t> decryptedData(EncryptorV11::decryptedSize(encryptedData));
+    auto const decryptedSize = AWAIT(EncryptorV11::decrypt(
+        decryptedData, Encryptor::fixedKeyFinder(sessionKey), encryptedData, &workerPool));
+    decryptedData.resize(decryptedSize);
+    CHECK(decryptedData == clearData);
+
+    if (encryptedData.size() > 2 * smallChunkSize)
+    {
+      ++encryptedData[encryptedData.size() / 2];
+      auto const keyFinder = Encryptor::fixedKeyFinder(sessionKey);
+      decryptedData.resize(EncryptorV11::decryptedSize(encryptedData));
+      TANKER_CHECK_THROWS_WITH_CODE(
+          AWAIT_VOID(EncryptorV11::decrypt(decryptedData, keyFinder, encryptedData, &workerPool)),
+          Errc::DecryptionFailed);
+    }
+  }
+
+  SECTION("decrypt should throw when the last chunk is missing")
+  {
+    std::vector<uint8_t> clearData(2 * oneMiB);
+    Crypto::randomFill(clearData);
+    auto const sessionKey = Crypto::makeSymmetricKey();
+
+    std::vector<uint8_t> encryptedData(EncryptorV11::encryptedSize(clearData.size(), Padding::Off));
+    AWAIT(EncryptorV11::encrypt(
+        encryptedData, clearData, Crypto::getRandom<SimpleResourceId>(), sessionKey, Padding::Off));
+
+    std::vector<uint8_t> truncatedData(
+        encryptedData.begin(),
+        encryptedData.begin() + Streams::TransparentSessionHeader::serializedSize +
+            2 * Streams::TransparentSessionHeader::defaultEncryptedChunkSize);
+    std::vector<uint8_t> decryptedData(clearData.size());
+
+    TANKER_CHECK_THROWS_WITH_CODE(
+        AWAIT_VOID(EncryptorV11::decrypt(decryptedData, Encryptor::fixedKeyFinder(sessionKey), truncatedData)),
+        Errc::DecryptionFailed);
+  }
+}
+
+TEST_CASE("EncryptorV12 tests")
+{
+  constexpr std::uint32_t smallChunkSize = 0x46;
+  auto const sessionId = Crypto::getRandom<SimpleResourceId>();
+  auto const sessionKey = Crypto::makeSymmetricKey();
+  auto const subkeySeed = Crypto::getRandom<Crypto::SubkeySeed>();
+
+  SECTION("encrypt and decrypt should give the same results when spread over threads")
+  {
+    WorkerPool workerPool(4);
+
+    auto const clearSize = GENERATE(0, 2, smallChunkSize - EncryptorV12::chunkOverhead, 300, 1000);
+    auto const paddingStep = GENERATE(values<std::optional<std::uint32_t>>({std::nullopt, 1, 500}));
+    CAPTURE(clearSize);
+    CAPTURE(paddingStep.value_or(0));
+
+    std::vector<uint8_t> clearData(clearSize);
+    Crypto::randomFill(clearData);
+
+    std::vector<uint8_t> encryptedData(EncryptorV12::encryptedSize(clearSize, paddingStep, smallChunkSize));
+    AWAIT(EncryptorV12::encrypt(
+        encryptedData, clearData, sessionId, sessionKey, subkeySeed, paddingStep, smallChunkSize));
+    std::vector<uint8_t> threadedEncryptedData(encryptedData.size());
+    AWAIT(EncryptorV12::encrypt(threadedEncryptedData,
+                                clearData,
+                                sessionId,
+                                sessionKey,
+                                subkeySeed,
+                                paddingStep,
+                                smallChunkSize,
+                                &workerPool));
+    CHECK(threadedEncryptedData == encryptedData);
+
+    CHECK(doDecrypt<EncryptorV12>(sessionKey, encryptedData) == clearData);
+    std::vector<uint8_t> decryptedData(EncryptorV12::decryptedSize(encryptedData));
+    decryptedData.resize(AWAIT(EncryptorV12::decrypt(
+        decryptedData, Encryptor::fixedKeyFinder(sessionKey), encryptedData, &workerPool)));
+    CHECK(decryptedData == clearData);
+  }
+
+  SECTION("has the layout of V11 with a different cipher")
+  {
+    std::vector<uint8_t> clearData(300);
+    Crypto::randomFill(clearData);
+
+    std::vector<uint8_t> v11EncryptedData(EncryptorV11::encryptedSize(clearData.size(), Padding::Off, smallChunkSize));
+    AWAIT(EncryptorV11::encrypt(
+        v11EncryptedData, clearData, sessionId, sessionKey, subkeySeed, Padding::Off, smallChunkSize));
+    std::vector<uint8_t> encryptedData(EncryptorV12::encryptedSize(clearData.size(), Padding::Off, smallChunkSize));
+    AWAIT(EncryptorV12::encrypt(
+        encryptedData, clearData, sessionId, sessionKey, subkeySeed, Padding::Off, smallChunkSize));
+
+    REQUIRE(encryptedData.size() == v11EncryptedData.size());
+    CHECK(encryptedData[0] == EncryptorV12::version());
+    auto const headerEnd = Streams::TransparentSessionHeader::serializedSize;
+    CHECK(std::equal(encryptedData.begin() + 1, encryptedData.begin() + headerEnd, v11EncryptedData.begin() + 1));
+    CHECK(!std::equal(encryptedData.begin() + headerEnd, encryptedData.end(), v11EncryptedData.begin() + headerEnd));
+    CHECK(EncryptorV12::extractResourceId(encryptedData) == EncryptorV11::extractResourceId(v11EncryptedData));
+  }
+
+  SECTION("is used by Encryptor::encrypt when asked for")
+  {
+    std::vector<uint8_t> clearData(5000);
+    Crypto::randomFill(clearData);
+    Encryptor::StreamOptions const options{smallChunkSize, 0, true};
+
+    std::vector<uint8_t> encryptedData(Encryptor::encryptedSize(clearData.size(), Padding::Off, options));
+    AWAIT(Encryptor::encrypt(encryptedData, clearData, Padding::Off, sessionId, sessionKey, nullptr, options));
+    CHECK(encryptedData[0] == EncryptorV12::version());
+
+    std::vector<uint8_t> decryptedData(Encryptor::decryptedSize(encryptedData));
+    decryptedData.resize(AWAIT(Encryptor::decrypt(decryptedData, sessionKey, encryptedData)));
+    CHECK(decryptedData == clearData);
+  }
+
+  SECTION("decrypt should throw on a corrupted chunk")
+  {
+    std::vector<uint8_t> clearData(300);
+    Crypto::randomFill(clearData);
+    std::vector<uint8_t> encryptedData(EncryptorV12::encryptedSize(clearData.size(), Padding::Off, smallChunkSize));
+    AWAIT(EncryptorV12::encrypt(
+        encryptedData, clearData, sessionId, sessionKey, subkeySeed, Padding::Off, smallChunkSize));
+
+    ++encryptedData[encryptedData.size() / 2];
+    std::vector<uint8_t> decryptedData(EncryptorV12::decryptedSize(encryptedData));
+    auto const keyFinder = Encryptor::fixedKeyFinder(sessionKey);
+    TANKER_CHECK_THROWS_WITH_CODE(AWAIT_VOID(EncryptorV12::decrypt(decryptedData, keyFinder, encryptedData)),
+                                  Errc::DecryptionFailed);
+  }
+}
+
+TEST_CASE("EncryptorV11 throughput", "[.][benchmark]")
+{
+  std::vector<uint8_t> clearData(64 * oneMiB);
+  Crypto::randomFill(clearData);
+  auto const sessionId = Crypto::getRandom<SimpleResourceId>();
+  auto const sessionKey = Crypto::makeSymmetricKey();
+  auto const subkeySeed = Crypto::getRandom<Crypto::SubkeySeed>();
+  std::vector<uint8_t> encryptedData(EncryptorV11::encryptedSize(clearData.size(), Padding::Off));
+  std::vector<uint8_t> decryptedData(clearData.size());
+
+  BENCHMARK("encrypt 64 MiB through EncryptionStreamV11")
+  {
+    return streamEncryptV11(clearData,
+                            sessionId,
+                            sessionKey,
+                            subkeySeed,
+                            Padding::Off,
+                            Streams::TransparentSessionHeader::defaultEncryptedChunkSize)
+        .size();
+  };
+
+  BENCHMARK("encrypt 64 MiB with EncryptorV11")
+  {
+    return AWAIT(EncryptorV11::encrypt(encryptedData, clearData, sessionId, sessionKey, subkeySeed, Padding::Off));
+  };
+
+  AWAIT(EncryptorV11::encrypt(encryptedData, clearData, sessionId, sessionKey, subkeySeed, Padding::Off));
+
+  BENCHMARK("decrypt 64 MiB through DecryptionStreamV11")
+  {
+    auto decryptor = AWAIT(Streams::DecryptionStreamV11::create(Streams::bufferViewToInputSource(encryptedData),
+                                                                Encryptor::fixedKeyFinder(sessionKey)));
+    return AWAIT(Streams::readStream(decryptedData, decryptor));
+  };
+
+  BENCHMARK("decrypt 64 MiB with EncryptorV11")
+  {
+    return AWAIT(EncryptorV11::decrypt(decryptedData, Encryptor::fixedKeyFinder(sessionKey), encryptedData));
+  };
+
+  WorkerPool workerPool(4);
+
+  BENCHMARK("encrypt 64 MiB with EncryptorV11 on 4 threads")
+  {
+    return AWAIT(EncryptorV11::encrypt(encryptedData,
+                                       clearData,
+                                       sessionId,
+                                       sessionKey,
+                                       subkeySeed,
+                                       Padding::Off,
+                                       Streams::TransparentSessionHeader::defaultEncryptedChunkSize,
+                                       &workerPool));
+  };
+
+  BENCHMARK("decrypt 64 MiB with EncryptorV11 on 4 threads")
+  {
+    return AWAIT(EncryptorV11::decrypt(
+        decryptedData, Encryptor::fixedKeyFinder(sessionKey), encryptedData, &workerPool));
+  };
+}
+
+// Small chunks give the first clear bytes of a stream sooner, large ones
+// amortize the per-chunk overhead
+TEST_CASE("EncryptorV11 chunk size tradeoff", "[.][benchmark]")
+{
+  std::vector<uint8_t> clearData(64 * oneMiB);
+  Crypto::randomFill(clearData);
+  auto const sessionId = Crypto::getRandom<SimpleResourceId>();
+  auto const sessionKey = Crypto::makeSymmetricKey();
+  auto const subkeySeed = Crypto::getRandom<Crypto::SubkeySeed>();
+  std::vector<uint8_t> decryptedData(clearData.size());
+
+  for (std::uint32_t const chunkSize : {16 * 1024, 64 * 1024, 256 * 1024, oneMiB, 4 * oneMiB})
+  {
+    auto const name = std::to_string(chunkSize / 1024) + " KiB chunks";
+    std::vector<uint8_t> encryptedData(EncryptorV11::encryptedSize(clearData.size(), Padding::Off, chunkSize));
+    AWAIT(EncryptorV11::encrypt(
+        encryptedData, clearData, sessionId, sessionKey, subkeySeed, Padding::Off, chunkSize));
+
+    BENCHMARK("first byte of a stream with " + name)
+    {
+      auto decryptor = AWAIT(Streams::DecryptionStreamV11::create(Streams::bufferViewToInputSource(encryptedData),
+                                                                  Encryptor::fixedKeyFinder(sessionKey)));
+      return AWAIT(decryptor(gsl::make_span(decryptedData).subspan(0, 1)));
+    };
+
+    BENCHMARK("decrypt 64 MiB through DecryptionStreamV11 with " + name)
+    {
+      auto decryptor = AWAIT(Streams::DecryptionStreamV11::create(Streams::bufferViewToInputSource(encryptedData),
+                                                                  Encryptor::fixedKeyFinder(sessionKey)));
+      return AWAIT(Streams::readStream(decryptedData, decryptor));
+    };
+
+    BENCHMARK("encrypt 64 MiB with EncryptorV11 with " + name)
+    {
+      return AWAIT(EncryptorV11::encrypt(
+          encryptedData, clearData, sessionId, sessionKey, subkeySeed, Padding::Off, chunkSize));
+    };
+  }
+}
+
+// AES-256-GCM is only faster than XChaCha20-Poly1305 with AES instructions,
+// without them this measures the portable implementation
+TEST_CASE("EncryptorV12 throughput compared to EncryptorV11", "[.][benchmark]")
+{
+  std::vector<uint8_t> clearData(64 * oneMiB);
+  Crypto::randomFill(clearData);
+  auto const sessionId = Crypto::getRandom<SimpleResourceId>();
+  auto const sessionKey = Crypto::makeSymmetricKey();
+  auto const subkeySeed = Crypto::getRandom<Crypto::SubkeySeed>();
+  std::vector<uint8_t> v11EncryptedData(EncryptorV11::encryptedSize(clearData.size(), Padding::Off));
+  std::vector<uint8_t> encryptedData(EncryptorV12::encryptedSize(clearData.size(), Padding::Off));
+  std::vector<uint8_t> decryptedData(clearData.size());
+  auto const cipher = std::string(Crypto::aes256GcmIsAccelerated() ? "accelerated" : "portable");
+
+  BENCHMARK("encrypt 64 MiB with EncryptorV11")
+  {
+    return AWAIT(
+        EncryptorV11::encrypt(v11EncryptedData, clearData, sessionId, sessionKey, subkeySeed, Padding::Off));
+  };
+
+  BENCHMARK("encrypt 64 MiB with EncryptorV12, " + cipher)
+  {
+    return AWAIT(EncryptorV12::encrypt(encryptedData, clearData, sessionId, sessionKey, subkeySeed, Padding::Off));
+  };
+
+  AWAIT(EncryptorV11::encrypt(v11EncryptedData, clearData, sessionId, sessionKey, subkeySeed, Padding::Off));
+  AWAIT(EncryptorV12::encrypt(encryptedData, clearData, sessionId, sessionKey, subkeySeed, Padding::Off));
+
+  BENCHMARK("decrypt 64 MiB with EncryptorV11")
+  {
+    return AWAIT(EncryptorV11::decrypt(decryptedData, Encryptor::fixedKeyFinder(sessionKey), v11EncryptedData));
+  };
+
+  BENCHMARK("decrypt 64 MiB with EncryptorV12, " + cipher)
+  {
+    return AWAIT(EncryptorV12::decrypt(decryptedData, Encryptor::fixedKeyFinder(sessionKey), encryptedData));
+  };
+
+  WorkerPool workerPool(4);
+
+  BENCHMARK("decrypt 64 MiB with EncryptorV11 on 4 threads")
+  {
+    return AWAIT(EncryptorV11::decrypt(
+        decryptedData, Encryptor::fixedKeyFinder(sessionKey), v11EncryptedData, &workerPool));
+  };
+
+  BENCHMARK("decrypt 64 MiB with EncryptorV12 on 4 threads, " + cipher)
+  {
+    return AWAIT(EncryptorV12::decrypt(
+        decryptedData, Encryptor::fixedKeyFinder(sessionKey), encryptedData, &workerPool));
+  };
 }
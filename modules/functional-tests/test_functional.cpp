@@ -2,6 +2,7 @@
 #include <Tanker/DataStore/Errors/Errc.hpp>
 #include <Tanker/Encryptor/v10.hpp>
 #include <Tanker/Encryptor/v11.hpp>
+#include <Tanker/Encryptor/v12.hpp>
 #include <Tanker/Encryptor/v4.hpp>
 #include <Tanker/Encryptor/v5.hpp>
 #include <Tanker/Encryptor/v8.hpp>
@@ -385,6 +386,59 @@ TEST_CASE_METHOD(TrustchainFixture, "Alice can stream-encrypt with a padding of
   CHECK(decryptedData == clearData);
 }
 
+TEST_CASE_METHOD(TrustchainFixture, "Alice can encrypt/decrypt with a custom chunk size and stream threshold")
+{
+  std::vector<uint8_t> clearData(100 * 1024);
+  Crypto::randomFill(clearData);
+  Encryptor::StreamOptions const streamOptions{16 * 1024, 64 * 1024};
+  auto encryptedData = TC_AWAIT(
+      aliceSession->encrypt(clearData, {}, {}, Core::ShareWithSelf::Yes, Padding::Off, streamOptions));
+  CHECK(encryptedData.size() == EncryptorV11::encryptedSize(clearData.size(), Padding::Off, 16 * 1024));
+  auto decryptedData = TC_AWAIT(aliceSession->decrypt(encryptedData));
+
+  CHECK(decryptedData == clearData);
+}
+
+TEST_CASE_METHOD(TrustchainFixture, "Alice can stream-encrypt with a custom chunk size")
+{
+  std::vector<uint8_t> clearData(100 * 1024);
+  Crypto::randomFill(clearData);
+  auto [encryptorStream, encryptorResourceId] =
+      TC_AWAIT(aliceSession->makeEncryptionStream(Streams::bufferViewToInputSource(clearData),
+                                                  {},
+                                                  {},
+                                                  Core::ShareWithSelf::Yes,
+                                                  Padding::Off,
+                                                  Encryptor::StreamOptions{16 * 1024}));
+  auto encryptedData = TC_AWAIT(Streams::readAllStream(encryptorStream));
+  CHECK(encryptedData.size() == EncryptorV11::encryptedSize(clearData.size(), Padding::Off, 16 * 1024));
+  auto decryptedData = TC_AWAIT(aliceSession->decrypt(encryptedData));
+
+  CHECK(decryptedData == clearData);
+}
+
+TEST_CASE_METHOD(TrustchainFixture, "Alice can encrypt/decrypt with AES-256-GCM")
+{
+  std::vector<uint8_t> clearData(100 * 1024);
+  Crypto::randomFill(clearData);
+  Encryptor::StreamOptions const streamOptions{16 * 1024, 64 * 1024, true};
+  auto encryptedData = TC_AWAIT(
+      aliceSession->encrypt(clearData, {}, {}, Core::ShareWithSelf::Yes, Padding::Off, streamOptions));
+  CHECK(encryptedData[0] == EncryptorV12::version());
+  auto decryptedData = TC_AWAIT(aliceSession->decrypt(encryptedData));
+
+  CHECK(decryptedData == clearData);
+}
+
+TEST_CASE_METHOD(TrustchainFixture, "Alice cannot encrypt with chunks too small to hold data")
+{
+  auto const clearData = make_buffer("my clear data is clear");
+  Encryptor::StreamOptions const streamOptions{EncryptorV11::chunkOverhead};
+  TANKER_CHECK_THROWS_WITH_CODE(
+      TC_AWAIT(aliceSession->encrypt(clearData, {}, {}, Core::ShareWithSelf::Yes, std::nullopt, streamOptions)),
+      Errc::InvalidArgument);
+}
+
 TEST_CASE_METHOD(TrustchainFixture, "Bob can encrypt and share with both of Alice's devices")
 {
   auto const clearData = "my clear data is clear";
@@ -141,9 +141,10 @@ struct tanker_options
 
 #define TANKER_OPTIONS_INIT                                    \
   {                                                            \
-    4, NULL, NULL, NULL, NULL, NULL, NULL, {NULL, NULL, NULL}, \
+    5, NULL, NULL, NULL, NULL, NULL, NULL, {NULL, NULL, NULL}, \
     {                                                          \
-      NULL, NULL, NULL, NULL, NULL, NULL, NULL                 \
+      NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,    \
+      0, 0, 0                                                  \
     }                                                          \
   }
 
@@ -259,11 +260,22 @@ struct tanker_encrypt_options
   // else if padding_step == 1 then padding disabled
   // else pad to a multiple of padding_step
   uint32_t padding_step;
+
+  // Since version 5, 0 means the default (1MiB for both)
+  // The size of the encrypted chunks of streams and of large data
+  uint32_t encrypted_chunk_size;
+  // Data at least this large once padded is encrypted in chunks
+  uint64_t stream_threshold;
+
+  // Since version 6
+  // Encrypt large data with AES-256-GCM instead of XChaCha20-Poly1305, which
+  // is faster when tanker_aes_256_gcm_is_accelerated() is true
+  bool aes_256_gcm;
 };
 
-#define TANKER_ENCRYPT_OPTIONS_INIT \
-  {                                 \
-    4, NULL, 0, NULL, 0, true, 0    \
+#define TANKER_ENCRYPT_OPTIONS_INIT           \
+  {                                           \
+    6, NULL, 0, NULL, 0, true, 0, 0, 0, false \
   }
 
 struct tanker_sharing_options
@@ -485,6 +497,24 @@ CTANKER_EXPORT tanker_future_t* tanker_get_verification_methods(tanker_t* sessio
  */
 CTANKER_EXPORT uint64_t tanker_encrypted_size(uint64_t clear_size, uint32_t padding_step);
 
+/*!
+ * Tell whether AES-256-GCM runs on hardware instructions on this CPU. Without
+ * them, the aes_256_gcm encryption option is slower than the default.
+ */
+CTANKER_EXPORT bool tanker_aes_256_gcm_is_accelerated(void);
+
+/*!
+ * Get the encrypted size from the clear size, when encrypting with options.
+ * Must be called instead of tanker_encrypted_size when the options change the
+ * chunk size or the stream threshold.
+ * \param clear_size The length of the clear data.
+ * \param options The same options that should be provided to encrypt, can be
+ * NULL.
+ * \return an already ready future of the size, cast to a void*
+ */
+CTANKER_EXPORT tanker_expected_t* tanker_encrypted_size_with_options(uint64_t clear_size,
+                                                                     tanker_encrypt_options_t const* options);
+
 /*!
  * Get the decrypted size.
  *
@@ -35,6 +35,7 @@ typedef void tanker_datastore_t;
 typedef void tanker_datastore_error_handle_t;
 typedef void tanker_datastore_device_get_result_handle_t;
 typedef void tanker_datastore_cache_get_result_handle_t;
+typedef void tanker_datastore_completion_handle_t;
 
 typedef void (*tanker_datastore_open_t)(tanker_datastore_error_handle_t* h,
                                         tanker_datastore_t** db,
@@ -65,6 +66,28 @@ typedef void (*tanker_datastore_find_cache_values_t)(tanker_datastore_t* datasto
                                                      uint32_t const* key_sizes,
                                                      uint32_t elem_count);
 
+/*!
+ * Asynchronous variants of put_cache_values and find_cache_values. They may
+ * return before the operation is done, and must call
+ * tanker_datastore_complete(done) exactly once when it is, from any thread.
+ * The arguments, the error handle and the result handle stay valid until then.
+ */
+typedef void (*tanker_datastore_put_cache_values_async_t)(tanker_datastore_t* datastore,
+                                                          tanker_datastore_error_handle_t* h,
+                                                          uint8_t const* const* keys,
+                                                          uint32_t const* key_sizes,
+                                                          uint8_t const* const* values,
+                                                          uint32_t const* value_sizes,
+                                                          uint32_t elem_count,
+                                                          uint8_t onconflict,
+                                                          tanker_datastore_completion_handle_t* done);
+typedef void (*tanker_datastore_find_cache_values_async_t)(tanker_datastore_t* datastore,
+                                                           tanker_datastore_cache_get_result_handle_t* h,
+                                                           uint8_t const* const* keys,
+                                                           uint32_t const* key_sizes,
+                                                           uint32_t elem_count,
+                                                           tanker_datastore_completion_handle_t* done);
+
 struct tanker_datastore_options
 {
   tanker_datastore_open_t open;
@@ -75,6 +98,21 @@ struct tanker_datastore_options
   tanker_datastore_find_serialized_device_t find_serialized_device;
   tanker_datastore_put_cache_values_t put_cache_values;
   tanker_datastore_find_cache_values_t find_cache_values;
+
+  /* Optional, both or none. Since tanker_options_t version 5. */
+  tanker_datastore_put_cache_values_async_t put_cache_values_async;
+  tanker_datastore_find_cache_values_async_t find_cache_values_async;
+
+  /* Keep the databases in memory, for as long as the Tanker instance lives,
+   * instead of calling the handlers above, which must then be NULL. Since
+   * tanker_options_t version 5. */
+  uint8_t in_memory;
+  /* Bound on the cache of the built-in datastores, in bytes, 0 means no bound.
+   * The on-disk datastore evicts the least recently used entries first, the
+   * in-memory one the oldest writes first. */
+  uint64_t max_cache_size;
+  /* Encrypt the in-memory values like the ones on disk */
+  uint8_t in_memory_encrypt_values;
 };
 
 typedef struct tanker_datastore_options tanker_datastore_options_t;
@@ -85,6 +123,7 @@ void tanker_datastore_allocate_cache_buffer(tanker_datastore_cache_get_result_ha
                                             uint8_t** out_ptrs,
                                             uint32_t* sizes);
 void tanker_datastore_report_error(tanker_datastore_error_handle_t* handle, uint8_t error_code, char const* message);
+void tanker_datastore_complete(tanker_datastore_completion_handle_t* done);
 
 #ifdef __cplusplus
 }
@@ -22,14 +22,14 @@ public:
   CTankerStorageDataStore(tanker_datastore_options_t options, tanker_datastore_t* store);
   ~CTankerStorageDataStore();
 
-  void nuke() override;
+  tc::cotask<void> nuke() override;
 
-  void putSerializedDevice(gsl::span<uint8_t const> device) override;
-  std::optional<std::vector<uint8_t>> findSerializedDevice() override;
+  tc::cotask<void> putSerializedDevice(gsl::span<uint8_t const> device) override;
+  tc::cotask<std::optional<std::vector<uint8_t>>> findSerializedDevice() override;
 
-  void putCacheValues(gsl::span<std::pair<Key, Value> const> keyValues,
-                      Tanker::DataStore::OnConflict onConflict) override;
-  std::vector<std::optional<std::vector<uint8_t>>> findCacheValues(gsl::span<Key const> keys) override;
+  tc::cotask<void> putCacheValues(gsl::span<std::pair<Key, Value> const> keyValues,
+                                  Tanker::DataStore::OnConflict onConflict) override;
+  tc::cotask<std::vector<std::optional<std::vector<uint8_t>>>> findCacheValues(gsl::span<Key const> keys) override;
 
 private:
   tanker_datastore_options_t _options;
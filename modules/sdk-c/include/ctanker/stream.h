@@ -13,6 +13,7 @@ extern "C" {
 
 typedef struct tanker_stream tanker_stream_t;
 typedef struct tanker_stream_read_operation tanker_stream_read_operation_t;
+typedef struct tanker_range_decryptor tanker_range_decryptor_t;
 
 /*!
  * Function pointer called whenever a tanker streams need to read input.
@@ -27,6 +28,22 @@ typedef void (*tanker_stream_input_source_t)(uint8_t* buffer,
                                              tanker_stream_read_operation_t* operation,
                                              void* additional_data);
 
+/*!
+ * Function pointer called whenever a range decryptor needs to read encrypted
+ * data.
+ *
+ * \param buffer Buffer with a capacity of *buffer_size* bytes
+ * \param buffer_size The maximum number of bytes to read, always positive
+ * \param offset The position in the encrypted data to read from
+ * \param operation The current read operation
+ * \param additional_data additional data
+ */
+typedef void (*tanker_stream_positional_input_source_t)(uint8_t* buffer,
+                                                        int64_t buffer_size,
+                                                        uint64_t offset,
+                                                        tanker_stream_read_operation_t* operation,
+                                                        void* additional_data);
+
 /*!
  * Create an encryption stream
  *
@@ -58,6 +75,78 @@ CTANKER_EXPORT tanker_future_t* tanker_stream_decrypt(tanker_t* tanker,
                                                       tanker_stream_input_source_t cb,
                                                       void* additional_data);
 
+/*!
+ * Create a range decryptor, which decrypts any part of a stream without
+ * reading it from the start
+ *
+ * \param tanker A tanker_t* instance
+ * \param cb The input callback, which reads the encrypted data at a given
+ * offset
+ * \param additional_data Additional data to give to cb
+ *
+ * \pre tanker_status == TANKER_STATUS_READY
+ * \pre the data was encrypted with a stream
+ * \return A new range decryptor, to be closed with tanker_range_decryptor_close
+ */
+CTANKER_EXPORT tanker_future_t* tanker_stream_open_range_decryptor(tanker_t* tanker,
+                                                                   tanker_stream_positional_input_source_t cb,
+                                                                   void* additional_data);
+
+/*!
+ * Decrypt a range of the clear data
+ *
+ * \param decryptor A tanker_range_decryptor_t* instance
+ * \param buffer The output buffer
+ * \param offset The position of the range in the clear data
+ * \param buffer_size The size of the range
+ *
+ * Only the chunks holding the range are read and decrypted. A truncation of the
+ * encrypted data is only detected when it is inside the range.
+ *
+ * \pre buffer must be capable to hold *buffer_size* bytes
+ * \return The number of bytes decrypted, less than buffer_size only when the
+ * range goes past the end of the data
+ * \throws TANKER_ERROR_INVALID_ARGUMENT \p offset is past the end of the data
+ */
+CTANKER_EXPORT tanker_future_t* tanker_range_decryptor_decrypt(tanker_range_decryptor_t* decryptor,
+                                                               uint8_t* buffer,
+                                                               uint64_t offset,
+                                                               int64_t buffer_size);
+
+/*!
+ * Get the resource id from a range decryptor
+ *
+ * \param decryptor the range decryptor
+ * \return the resource id
+ */
+CTANKER_EXPORT tanker_expected_t* tanker_range_decryptor_get_resource_id(tanker_range_decryptor_t* decryptor);
+
+/*!
+ * Close a range decryptor
+ *
+ * \param decryptor A tanker_range_decryptor_t* instance
+ *
+ * \post decryptor must not be reused
+ *
+ * \return An empty future
+ */
+CTANKER_EXPORT tanker_future_t* tanker_range_decryptor_close(tanker_range_decryptor_t* decryptor);
+
+/*!
+ * Make the streams created afterwards read ahead of their consumer
+ *
+ * \param tanker A tanker_t* instance
+ * \param depth The number of chunks read in advance, 0 disables the read-ahead
+ * \param process_ahead Also encrypt or decrypt the chunks in advance, not only
+ * read their input
+ *
+ * The input callback is then called while the previous chunks are still being
+ * read with tanker_stream_read.
+ *
+ * \return An empty future
+ */
+CTANKER_EXPORT tanker_future_t* tanker_stream_set_read_ahead(tanker_t* tanker, uint32_t depth, uint8_t process_ahead);
+
 /*!
  * Finish a read operation
  *
@@ -104,6 +193,10 @@ CTANKER_EXPORT tanker_expected_t* tanker_stream_get_resource_id(tanker_stream_t*
  * \pre stream was returned by tanker_stream_encrypt or tanker_stream_decrypt
  * \post stream must not be reused
  *
+ * The input callback is not called once the stream is closed, even by the
+ * reads made ahead. The read operations it already started must still be
+ * finished with tanker_stream_read_operation_finish.
+ *
  * \return An empty future
  */
 CTANKER_EXPORT tanker_future_t* tanker_stream_close(tanker_stream_t* stream);
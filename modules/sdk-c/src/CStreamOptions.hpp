@@ -0,0 +1,8 @@
+#pragma once
+
+#include <Tanker/Encryptor.hpp>
+
+#include <ctanker/ctanker.h>
+
+// Version 4 options have no stream options, they use the defaults
+Tanker::Encryptor::StreamOptions cStreamOptions(tanker_encrypt_options_t const* options);
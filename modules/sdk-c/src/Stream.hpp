@@ -1,13 +1,22 @@
 #pragma once
 
+#include <Tanker/Errors/Errc.hpp>
+#include <Tanker/Errors/Exception.hpp>
 #include <Tanker/Streams/InputSource.hpp>
+#include <Tanker/Streams/RangeDecryptor.hpp>
 #include <Tanker/Types/SResourceId.hpp>
 
 #include <tconcurrent/task_canceler.hpp>
 
-inline auto wrapCallback(tanker_stream_input_source_t cb, void* additional_data)
+#include <memory>
+
+// closed is set by tanker_stream_close. With read-ahead, reads can still be in
+// flight afterwards, they must not call back into the application anymore.
+inline auto wrapCallback(tanker_stream_input_source_t cb, void* additional_data, std::shared_ptr<bool const> closed)
 {
   return [=](gsl::span<std::uint8_t> out) -> tc::cotask<std::int64_t> {
+    if (*closed)
+      throw Tanker::Errors::Exception(make_error_code(Tanker::Errors::Errc::OperationCanceled), "the stream is closed");
     tc::promise<std::int64_t> p;
     // Do not forget to take the promise by ref, the lambda will be deleted as
     // soon as it has run.
@@ -20,9 +29,29 @@ inline auto wrapCallback(tanker_stream_input_source_t cb, void* additional_data)
   };
 }
 
+inline auto wrapPositionalCallback(tanker_stream_positional_input_source_t cb, void* additional_data)
+{
+  return [=](std::uint64_t offset, gsl::span<std::uint8_t> out) -> tc::cotask<std::int64_t> {
+    // Same as wrapCallback
+    tc::promise<std::int64_t> p;
+    tc::dispatch_on_thread_context([=, &p]() mutable {
+      cb(out.data(), out.size(), offset, reinterpret_cast<tanker_stream_read_operation_t*>(&p), additional_data);
+    });
+    TC_RETURN(TC_AWAIT(p.get_future()));
+  };
+}
+
 struct tanker_stream
 {
   Tanker::Streams::InputSource inputSource;
   Tanker::SResourceId resourceId;
   tc::task_canceler canceler;
+  std::shared_ptr<bool> closed;
+};
+
+struct tanker_range_decryptor
+{
+  Tanker::Streams::RangeDecryptor decryptor;
+  Tanker::SResourceId resourceId;
+  tc::task_canceler canceler;
 };
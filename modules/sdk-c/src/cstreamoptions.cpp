@@ -0,0 +1,16 @@
+#include "CStreamOptions.hpp"
+
+Tanker::Encryptor::StreamOptions cStreamOptions(tanker_encrypt_options_t const* options)
+{
+  Tanker::Encryptor::StreamOptions streamOptions;
+  if (!options || options->version < 5)
+    return streamOptions;
+
+  if (options->encrypted_chunk_size != 0)
+    streamOptions.encryptedChunkSize = options->encrypted_chunk_size;
+  if (options->stream_threshold != 0)
+    streamOptions.streamThreshold = options->stream_threshold;
+  if (options->version >= 6)
+    streamOptions.aes256Gcm = options->aes_256_gcm;
+  return streamOptions;
+}
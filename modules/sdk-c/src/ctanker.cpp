@@ -22,7 +22,10 @@
 #include <ctanker/private/Utils.hpp>
 
 #include "CPadding.hpp"
+#include "CStreamOptions.hpp"
 
+#include <cstddef>
+#include <cstring>
 #include <optional>
 #include <string>
 #include <utility>
@@ -284,10 +287,10 @@ tanker_future_t* tanker_create(const tanker_options_t* options)
     {
       throw Exception(make_error_code(Errc::InvalidArgument), "options is null");
     }
-    if (options->version != 4)
+    if (options->version != 4 && options->version != 5)
     {
       throw Exception(make_error_code(Errc::InvalidArgument),
-                      fmt::format("options version should be {:d} instead of {:d}", 4, options->version));
+                      fmt::format("options version should be 4 or 5 instead of {:d}", options->version));
     }
     if (options->app_id == nullptr)
     {
@@ -312,7 +315,15 @@ tanker_future_t* tanker_create(const tanker_options_t* options)
     }
 
     std::unique_ptr<Tanker::Network::Backend> networkBackend = extractNetworkBackend(options->http_options);
-    std::unique_ptr<Tanker::DataStore::Backend> storageBackend = extractStorageBackend(options->datastore_options);
+    // Version 4 options end before the asynchronous datastore handlers
+    auto datastoreOptions = tanker_datastore_options_t{};
+    if (options->version == 4)
+      std::memcpy(&datastoreOptions,
+                  &options->datastore_options,
+                  offsetof(tanker_datastore_options_t, put_cache_values_async));
+    else
+      datastoreOptions = options->datastore_options;
+    std::unique_ptr<Tanker::DataStore::Backend> storageBackend = extractStorageBackend(datastoreOptions);
 
     if (options->cache_path == nullptr)
     {
@@ -526,6 +537,21 @@ uint64_t tanker_encrypted_size(uint64_t clear_size, uint32_t padding_step)
   return AsyncCore::encryptedSize(clear_size, paddingStepOpt);
 }
 
+bool tanker_aes_256_gcm_is_accelerated(void)
+{
+  return Crypto::aes256GcmIsAccelerated();
+}
+
+tanker_expected_t* tanker_encrypted_size_with_options(uint64_t clear_size, tanker_encrypt_options_t const* options)
+{
+  return makeFuture(tc::sync([&] {
+    if (options && (options->version < 4 || options->version > 6))
+      throw formatEx(Errc::InvalidArgument, "unsupported tanker_encrypt_options struct version");
+    auto const paddingStepOpt = options ? cPaddingToOptPadding(options->padding_step) : std::nullopt;
+    return reinterpret_cast<void*>(AsyncCore::encryptedSize(clear_size, paddingStepOpt, cStreamOptions(options)));
+  }));
+}
+
 tanker_expected_t* tanker_decrypted_size(uint8_t const* encrypted_data, uint64_t encrypted_size)
 {
   return makeFuture(
@@ -553,9 +579,10 @@ tanker_future_t* tanker_encrypt(tanker_t* ctanker,
         std::vector<SGroupId> sgroupIds{};
         bool shareWithSelf = true;
         std::optional<uint32_t> paddingStepOpt;
+        auto const streamOptions = cStreamOptions(options);
         if (options)
         {
-          if (options->version != 4)
+          if (options->version < 4 || options->version > 6)
           {
             throw formatEx(Errc::InvalidArgument, "unsupported tanker_encrypt_options struct version");
           }
@@ -568,12 +595,14 @@ tanker_future_t* tanker_encrypt(tanker_t* ctanker,
         }
 
         auto tanker = reinterpret_cast<AsyncCore*>(ctanker);
-        return tanker->encrypt(gsl::span(encrypted_data, AsyncCore::encryptedSize(data_size, paddingStepOpt)),
-                               gsl::make_span(data, data_size),
-                               spublicIdentities,
-                               sgroupIds,
-                               Core::ShareWithSelf{shareWithSelf},
-                               paddingStepOpt);
+        return tanker->encrypt(
+            gsl::span(encrypted_data, AsyncCore::encryptedSize(data_size, paddingStepOpt, streamOptions)),
+            gsl::make_span(data, data_size),
+            spublicIdentities,
+            sgroupIds,
+            Core::ShareWithSelf{shareWithSelf},
+            paddingStepOpt,
+            streamOptions);
       }).unwrap());
 }
 
@@ -1,6 +1,10 @@
 #include <ctanker/datastore.h>
 
 #include <Tanker/DataStore/Errors/Errc.hpp>
+#include <Tanker/DataStore/Memory/Backend.hpp>
+#ifdef TANKER_WITH_SQLITE
+#include <Tanker/DataStore/Sqlite/Backend.hpp>
+#endif
 #include <Tanker/Errors/Exception.hpp>
 #include <Tanker/Log/Log.hpp>
 #include <ctanker/private/CDataStore.hpp>
@@ -12,19 +16,56 @@
 #include <range/v3/view/iota.hpp>
 #include <range/v3/view/map.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
 TLOG_CATEGORY(CTankerStorage);
 
 using namespace Tanker::DataStore;
 namespace Errors = Tanker::Errors;
 
+namespace
+{
+// A bound that does not fit in a size_t is larger than any cache this process
+// can hold
+std::size_t toMaxCacheSize(uint64_t maxCacheSize)
+{
+  return static_cast<std::size_t>(std::min<uint64_t>(maxCacheSize, std::numeric_limits<std::size_t>::max()));
+}
+}
+
 std::unique_ptr<Tanker::DataStore::Backend> extractStorageBackend(tanker_datastore_options_t const& options)
 {
   auto const datastoreHandlersCount = !!options.open + !!options.close + !!options.nuke +
                                       !!options.put_serialized_device + !!options.find_serialized_device +
                                       !!options.put_cache_values + !!options.find_cache_values;
+  if (options.in_memory)
+  {
+    if (datastoreHandlersCount != 0 || options.put_cache_values_async || options.find_cache_values_async)
+      throw Errors::Exception(make_error_code(Errors::Errc::InvalidArgument),
+                              "an in-memory datastore cannot have datastore handlers");
+    return std::make_unique<MemoryBackend>(
+        MemoryOptions{toMaxCacheSize(options.max_cache_size), !!options.in_memory_encrypt_values});
+  }
   if (datastoreHandlersCount != 0 && datastoreHandlersCount != 7)
     throw Errors::Exception(make_error_code(Errors::Errc::InternalError),
                             "the provided datastore implementation is incomplete");
+  if (!!options.put_cache_values_async != !!options.find_cache_values_async)
+    throw Errors::Exception(make_error_code(Errors::Errc::InternalError),
+                            "the provided datastore implementation is incomplete");
+  if (datastoreHandlersCount == 0 && options.max_cache_size != 0)
+  {
+#ifdef TANKER_WITH_SQLITE
+    SqliteOptions sqliteOptions;
+    sqliteOptions.maxCacheSize = toMaxCacheSize(options.max_cache_size);
+    return std::make_unique<SqliteBackend>(sqliteOptions);
+#else
+    throw Errors::Exception(make_error_code(Errors::Errc::InvalidArgument),
+                            "max_cache_size needs a built-in datastore");
+#endif
+  }
   if (datastoreHandlersCount == 0)
     return nullptr;
   return std::make_unique<CTankerStorageBackend>(options);
@@ -64,6 +105,13 @@ void rethrowError(std::exception_ptr e)
   if (e)
     std::rethrow_exception(e);
 }
+
+// The error handles are cast to std::exception_ptr*, so err must come first
+struct PutResult
+{
+  std::exception_ptr err;
+  tc::promise<void> done;
+};
 }
 
 CTankerStorageBackend::CTankerStorageBackend(tanker_datastore_options_t const& options) : _options(options)
@@ -92,19 +140,21 @@ CTankerStorageDataStore::~CTankerStorageDataStore()
   tc::dispatch_on_thread_context([&] { _options.close(_datastore); });
 }
 
-void CTankerStorageDataStore::nuke()
+tc::cotask<void> CTankerStorageDataStore::nuke()
 {
   std::exception_ptr err;
   tc::dispatch_on_thread_context([&] { return _options.nuke(_datastore, &err); });
   rethrowError(err);
+  TC_RETURN();
 }
 
-void CTankerStorageDataStore::putSerializedDevice(gsl::span<uint8_t const> device)
+tc::cotask<void> CTankerStorageDataStore::putSerializedDevice(gsl::span<uint8_t const> device)
 {
   std::exception_ptr err;
   tc::dispatch_on_thread_context(
       [&] { return _options.put_serialized_device(_datastore, &err, device.data(), device.size()); });
   rethrowError(err);
+  TC_RETURN();
 }
 
 namespace
@@ -116,12 +166,12 @@ struct DeviceResult
 };
 }
 
-std::optional<std::vector<uint8_t>> CTankerStorageDataStore::findSerializedDevice()
+tc::cotask<std::optional<std::vector<uint8_t>>> CTankerStorageDataStore::findSerializedDevice()
 {
   DeviceResult result;
   tc::dispatch_on_thread_context([&] { return _options.find_serialized_device(_datastore, &result); });
   rethrowError(result.err);
-  return result.data;
+  TC_RETURN(std::move(result.data));
 }
 
 uint8_t* tanker_datastore_allocate_device_buffer(tanker_datastore_device_get_result_handle_t* result_handle,
@@ -132,7 +182,8 @@ uint8_t* tanker_datastore_allocate_device_buffer(tanker_datastore_device_get_res
   return optVec->data();
 }
 
-void CTankerStorageDataStore::putCacheValues(gsl::span<std::pair<Key, Value> const> keyValues, OnConflict onConflict)
+tc::cotask<void> CTankerStorageDataStore::putCacheValues(gsl::span<std::pair<Key, Value> const> keyValues,
+                                                         OnConflict onConflict)
 {
   auto const keyPtrs = keyValues | ranges::views::keys | ranges::views::transform(&Key::data) | ranges::to<std::vector>;
   auto const keySizes =
@@ -142,18 +193,37 @@ void CTankerStorageDataStore::putCacheValues(gsl::span<std::pair<Key, Value> con
   auto const valueSizes =
       keyValues | ranges::views::values | ranges::views::transform(&Value::size) | ranges::to<std::vector<uint32_t>>;
 
-  std::exception_ptr err;
-  tc::dispatch_on_thread_context([&] {
-    return _options.put_cache_values(_datastore,
-                                     &err,
-                                     keyPtrs.data(),
-                                     keySizes.data(),
-                                     valuePtrs.data(),
-                                     valueSizes.data(),
-                                     keyValues.size(),
-                                     static_cast<uint8_t>(onConflict));
-  });
-  rethrowError(err);
+  PutResult result;
+  if (_options.put_cache_values_async)
+  {
+    auto done = result.done.get_future();
+    tc::dispatch_on_thread_context([&] {
+      return _options.put_cache_values_async(_datastore,
+                                             &result,
+                                             keyPtrs.data(),
+                                             keySizes.data(),
+                                             valuePtrs.data(),
+                                             valueSizes.data(),
+                                             keyValues.size(),
+                                             static_cast<uint8_t>(onConflict),
+                                             &result.done);
+    });
+    TC_AWAIT(done);
+  }
+  else
+  {
+    tc::dispatch_on_thread_context([&] {
+      return _options.put_cache_values(_datastore,
+                                       &result,
+                                       keyPtrs.data(),
+                                       keySizes.data(),
+                                       valuePtrs.data(),
+                                       valueSizes.data(),
+                                       keyValues.size(),
+                                       static_cast<uint8_t>(onConflict));
+    });
+  }
+  rethrowError(result.err);
 }
 
 namespace
@@ -162,10 +232,11 @@ struct CacheResult
 {
   std::exception_ptr err;
   std::vector<std::optional<std::vector<uint8_t>>> data;
+  tc::promise<void> done;
 };
 }
 
-std::vector<std::optional<std::vector<uint8_t>>> CTankerStorageDataStore::findCacheValues(
+tc::cotask<std::vector<std::optional<std::vector<uint8_t>>>> CTankerStorageDataStore::findCacheValues(
     gsl::span<gsl::span<uint8_t const> const> keys)
 {
   std::vector<uint8_t const*> keyPtrs;
@@ -180,13 +251,25 @@ std::vector<std::optional<std::vector<uint8_t>>> CTankerStorageDataStore::findCa
 
   CacheResult result;
   result.data.resize(keys.size());
-  tc::dispatch_on_thread_context(
-      [&] { return _options.find_cache_values(_datastore, &result, keyPtrs.data(), keySizes.data(), keys.size()); });
+  if (_options.find_cache_values_async)
+  {
+    auto done = result.done.get_future();
+    tc::dispatch_on_thread_context([&] {
+      return _options.find_cache_values_async(
+          _datastore, &result, keyPtrs.data(), keySizes.data(), keys.size(), &result.done);
+    });
+    TC_AWAIT(done);
+  }
+  else
+  {
+    tc::dispatch_on_thread_context(
+        [&] { return _options.find_cache_values(_datastore, &result, keyPtrs.data(), keySizes.data(), keys.size()); });
+  }
   rethrowError(result.err);
   if (result.data.size() != keys.size())
     throw Errors::formatEx(Errc::DatabaseError, "the database backend didn't return enough results");
 
-  return result.data;
+  TC_RETURN(std::move(result.data));
 }
 
 void tanker_datastore_allocate_cache_buffer(tanker_datastore_cache_get_result_handle_t* result_handle,
@@ -210,3 +293,10 @@ void tanker_datastore_report_error(tanker_datastore_error_handle_t* handle, uint
   auto const err = static_cast<std::exception_ptr*>(handle);
   *err = std::make_exception_ptr(Errors::formatEx(static_cast<Errc>(error_code), "{}", message));
 }
+
+void tanker_datastore_complete(tanker_datastore_completion_handle_t* done)
+{
+  // The awaiting task can destroy the promise as soon as it is set, set a copy
+  auto promise = *static_cast<tc::promise<void>*>(done);
+  promise.set_value({});
+}
@@ -25,7 +25,7 @@ CTANKER_EXPORT tanker_future_t* tanker_encryption_session_open(tanker_t* ctanker
         std::optional<uint32_t> paddingStepOpt;
         if (options)
         {
-          if (options->version != 4)
+          if (options->version < 4 || options->version > 6)
           {
             throw formatEx(Errc::InvalidArgument, "unsupported tanker_encrypt_options struct version");
           }
@@ -87,12 +87,14 @@ tanker_future_t* tanker_encryption_session_stream_encrypt(tanker_encryption_sess
 {
   auto session = reinterpret_cast<EncryptionSession*>(csession);
   return makeFuture(tc::sync([&] {
-    auto wrappedCb = wrapCallback(cb, additional_data);
+    auto const closed = std::make_shared<bool>(false);
+    auto wrappedCb = wrapCallback(cb, additional_data, closed);
     auto [encryptor, resourceId] = session->makeEncryptionStream(std::move(wrappedCb));
 
     auto c_stream = new tanker_stream;
     c_stream->resourceId = SResourceId{mgs::base64::encode(resourceId)};
     c_stream->inputSource = std::move(encryptor);
+    c_stream->closed = closed;
     return static_cast<void*>(c_stream);
   }));
 }
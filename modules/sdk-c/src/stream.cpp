@@ -8,6 +8,7 @@
 #include <mgs/base64.hpp>
 
 #include "CPadding.hpp"
+#include "CStreamOptions.hpp"
 #include "Stream.hpp"
 #include <ctanker/private/Utils.hpp>
 
@@ -32,15 +33,17 @@ tanker_future_t* tanker_stream_encrypt(tanker_t* session,
                                        void* additional_data,
                                        tanker_encrypt_options_t const* options)
 {
+  auto const closed = std::make_shared<bool>(false);
   return makeFuture(tc::sync([&] {
                       std::vector<SPublicIdentity> spublicIdentities{};
                       std::vector<SGroupId> sgroupIds{};
                       bool shareWithSelf = true;
                       std::optional<uint32_t> paddingStepOpt;
+                      auto const streamOptions = cStreamOptions(options);
 
                       if (options)
                       {
-                        if (options->version != 4)
+                        if (options->version < 4 || options->version > 6)
                         {
                           throw formatEx(Errc::InvalidArgument, "unsupported tanker_encrypt_options struct version");
                         }
@@ -54,17 +57,19 @@ tanker_future_t* tanker_stream_encrypt(tanker_t* session,
                       }
 
                       auto tanker = reinterpret_cast<AsyncCore*>(session);
-                      return tanker->makeEncryptionStream(wrapCallback(cb, additional_data),
+                      return tanker->makeEncryptionStream(wrapCallback(cb, additional_data, closed),
                                                           spublicIdentities,
                                                           sgroupIds,
                                                           Core::ShareWithSelf{shareWithSelf},
-                                                          paddingStepOpt);
+                                                          paddingStepOpt,
+                                                          streamOptions);
                     })
                         .unwrap()
-                        .and_then(tc::get_synchronous_executor(), [](auto encryptor) {
+                        .and_then(tc::get_synchronous_executor(), [closed](auto encryptor) {
                           auto c_stream = new tanker_stream;
                           c_stream->resourceId = SResourceId{mgs::base64::encode(std::get<1>(encryptor))};
                           c_stream->inputSource = std::move(std::get<0>(encryptor));
+                          c_stream->closed = closed;
                           return static_cast<void*>(c_stream);
                         }));
 }
@@ -72,13 +77,57 @@ tanker_future_t* tanker_stream_encrypt(tanker_t* session,
 tanker_future_t* tanker_stream_decrypt(tanker_t* session, tanker_stream_input_source_t cb, void* data)
 {
   auto tanker = reinterpret_cast<AsyncCore*>(session);
-  return makeFuture(
-      tanker->makeDecryptionStream(wrapCallback(cb, data)).and_then(tc::get_synchronous_executor(), [](auto decryptor) {
-        auto c_stream = new tanker_stream;
-        c_stream->resourceId = SResourceId{mgs::base64::encode(std::get<1>(decryptor))};
-        c_stream->inputSource = std::move(std::get<0>(decryptor));
-        return static_cast<void*>(c_stream);
-      }));
+  auto const closed = std::make_shared<bool>(false);
+  return makeFuture(tanker->makeDecryptionStream(wrapCallback(cb, data, closed))
+                        .and_then(tc::get_synchronous_executor(), [closed](auto decryptor) {
+                          auto c_stream = new tanker_stream;
+                          c_stream->resourceId = SResourceId{mgs::base64::encode(std::get<1>(decryptor))};
+                          c_stream->inputSource = std::move(std::get<0>(decryptor));
+                          c_stream->closed = closed;
+                          return static_cast<void*>(c_stream);
+                        }));
+}
+
+tanker_future_t* tanker_stream_open_range_decryptor(tanker_t* session,
+                                                    tanker_stream_positional_input_source_t cb,
+                                                    void* additional_data)
+{
+  auto tanker = reinterpret_cast<AsyncCore*>(session);
+  return makeFuture(tanker->makeRangeDecryptor(wrapPositionalCallback(cb, additional_data))
+                        .and_then(tc::get_synchronous_executor(), [](auto decryptor) {
+                          auto const resourceId = SResourceId{mgs::base64::encode(decryptor.resourceId())};
+                          auto c_decryptor = new tanker_range_decryptor{std::move(decryptor), resourceId};
+                          return static_cast<void*>(c_decryptor);
+                        }));
+}
+
+tanker_future_t* tanker_range_decryptor_decrypt(tanker_range_decryptor_t* decryptor,
+                                                uint8_t* buffer,
+                                                uint64_t offset,
+                                                int64_t buffer_size)
+{
+  return makeFuture(decryptor->canceler.run([&]() mutable {
+    return tc::async_resumable([=]() -> tc::cotask<void*> {
+      TC_RETURN(reinterpret_cast<void*>(
+          TC_AWAIT(decryptor->decryptor.decryptRange(offset, gsl::make_span(buffer, buffer_size)))));
+    });
+  }));
+}
+
+tanker_expected_t* tanker_range_decryptor_get_resource_id(tanker_range_decryptor_t* decryptor)
+{
+  return makeFuture(tc::make_ready_future(static_cast<void*>(duplicateString(decryptor->resourceId.string()))));
+}
+
+tanker_future_t* tanker_range_decryptor_close(tanker_range_decryptor_t* decryptor)
+{
+  return makeFuture(tc::async([=] { delete decryptor; }));
+}
+
+tanker_future_t* tanker_stream_set_read_ahead(tanker_t* session, uint32_t depth, uint8_t process_ahead)
+{
+  auto tanker = reinterpret_cast<AsyncCore*>(session);
+  return makeFuture(tanker->setStreamReadAhead(Streams::ReadAheadOptions{depth, process_ahead != 0}));
 }
 
 tanker_future_t* tanker_stream_read(tanker_stream_t* stream, uint8_t* buffer, int64_t buffer_size)
@@ -97,5 +146,8 @@ tanker_expected_t* tanker_stream_get_resource_id(tanker_stream_t* stream)
 
 tanker_future_t* tanker_stream_close(tanker_stream_t* stream)
 {
-  return makeFuture(tc::async([=] { delete stream; }));
+  return makeFuture(tc::async([=] {
+    *stream->closed = true;
+    delete stream;
+  }));
 }
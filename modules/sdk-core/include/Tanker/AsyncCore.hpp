@@ -90,19 +90,26 @@ public:
                            std::vector<SPublicIdentity> const& publicIdentities = {},
                            std::vector<SGroupId> const& groupIds = {},
                            Core::ShareWithSelf shareWithSelf = Core::ShareWithSelf::Yes,
-                           std::optional<uint32_t> paddingStep = std::nullopt);
+                           std::optional<uint32_t> paddingStep = std::nullopt,
+                           Encryptor::StreamOptions const& streamOptions = {});
   tc::future<uint64_t> decrypt(gsl::span<uint8_t> decryptedData, gsl::span<uint8_t const> encryptedData);
 
   tc::future<std::vector<uint8_t>> encrypt(gsl::span<uint8_t const> clearData,
                                            std::vector<SPublicIdentity> const& publicIdentities = {},
                                            std::vector<SGroupId> const& groupIds = {},
                                            Core::ShareWithSelf shareWithSelf = Core::ShareWithSelf::Yes,
-                                           std::optional<uint32_t> paddingStep = std::nullopt);
+                                           std::optional<uint32_t> paddingStep = std::nullopt,
+                                           Encryptor::StreamOptions const& streamOptions = {});
   tc::future<std::vector<uint8_t>> decrypt(gsl::span<uint8_t const> encryptedData);
 
   tc::future<void> share(std::vector<SResourceId> const& resourceId,
                          std::vector<SPublicIdentity> const& publicIdentities,
                          std::vector<SGroupId> const& groupIds);
+  // onProgress is called from the Tanker thread
+  tc::future<void> bulkShare(std::vector<SResourceId> const& resourceIds,
+                             std::vector<SPublicIdentity> const& publicIdentities,
+                             std::vector<SGroupId> const& groupIds,
+                             Share::ProgressHandler onProgress = nullptr);
 
   tc::future<SGroupId> createGroup(std::vector<SPublicIdentity> const& members);
   tc::future<void> updateGroupMembers(SGroupId const& groupId,
@@ -127,7 +134,9 @@ public:
 
   static void setLogHandler(Log::LogHandler handler);
 
-  static uint64_t encryptedSize(uint64_t clearSize, std::optional<uint32_t> paddingStep = std::nullopt);
+  static uint64_t encryptedSize(uint64_t clearSize,
+                                std::optional<uint32_t> paddingStep = std::nullopt,
+                                Encryptor::StreamOptions const& streamOptions = {});
 
   static expected<uint64_t> decryptedSize(gsl::span<uint8_t const> encryptedData);
 
@@ -136,9 +145,11 @@ public:
       std::vector<SPublicIdentity> const& suserIds = {},
       std::vector<SGroupId> const& sgroupIds = {},
       Core::ShareWithSelf shareWithSelf = Core::ShareWithSelf::Yes,
-      std::optional<uint32_t> paddingStep = std::nullopt);
+      std::optional<uint32_t> paddingStep = std::nullopt,
+      Encryptor::StreamOptions const& streamOptions = {});
 
   tc::future<std::tuple<Streams::InputSource, Crypto::ResourceId>> makeDecryptionStream(Streams::InputSource);
+  tc::future<Streams::RangeDecryptor> makeRangeDecryptor(Streams::PositionalInputSource);
 
   tc::future<EncryptionSession> makeEncryptionSession(std::vector<SPublicIdentity> const& publicIdentities = {},
                                                       std::vector<SGroupId> const& groupIds = {},
@@ -151,6 +162,13 @@ public:
   SdkInfo const& sdkInfo();
 
   tc::future<void> setHttpSessionToken(std::string token);
+  tc::future<void> setWorkerThreadCount(unsigned int threadCount);
+  tc::future<void> setUserCacheMaxAge(std::optional<std::chrono::seconds> maxAge);
+  tc::future<void> setResourceKeyWriteBehind(std::optional<ResourceKeys::WriteBehindOptions> options);
+  tc::future<void> setHttpConcurrency(std::size_t concurrentRequestCount);
+  tc::future<void> setStreamReadAhead(Streams::ReadAheadOptions options);
+
+  tc::future<CacheOccupancy> cacheOccupancy();
 
 private:
   Core _core;
@@ -169,7 +187,7 @@ private:
   // [[noreturn]] also means noco_await, according to clang, which makes the
   // keyword useless on coroutines.
   tc::cotask<void> handleDeviceUnrecoverable();
-  void nukeAndStop();
+  void terminateAndStop();
 
   template <typename F>
   auto runResumable(F&& f);
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Tanker/DataStore/Backend.hpp>
+
+namespace Tanker
+{
+// What the local cache holds, per category. The index entries count with the
+// category they index.
+struct CacheOccupancy
+{
+  DataStore::CacheUsage resourceKeys;
+  DataStore::CacheUsage groups;
+  DataStore::CacheUsage users;
+  DataStore::CacheUsage provisionalUserKeys;
+  DataStore::CacheUsage transparentSessions;
+};
+}
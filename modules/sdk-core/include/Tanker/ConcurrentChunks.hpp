@@ -0,0 +1,71 @@
+#pragma once
+
+#include <gsl/gsl-lite.hpp>
+#include <tconcurrent/async.hpp>
+#include <tconcurrent/coroutine.hpp>
+#include <tconcurrent/future.hpp>
+#include <tconcurrent/when.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace Tanker
+{
+namespace detail
+{
+template <typename F, typename Id>
+using ChunkResult = typename tc::detail::task_return_type<std::invoke_result_t<F&, gsl::span<Id const>>>::type;
+}
+
+/**
+ * Splits ids in chunks of chunkSize and runs f on all of them concurrently.
+ * This is meant for server requests: how many actually run at once is bounded
+ * by the HttpClient.
+ *
+ * Returns the results of f in chunk order. All the tasks are done when it
+ * returns, even when one of them failed, in which case the first error is
+ * rethrown.
+ */
+template <typename Id, typename F>
+auto mapChunksConcurrently(gsl::span<Id const> ids, std::size_t chunkSize, F&& f)
+    -> tc::cotask<std::vector<detail::ChunkResult<F, Id>>>
+{
+  using Result = detail::ChunkResult<F, Id>;
+
+  std::vector<Result> results;
+  if (ids.empty())
+    TC_RETURN(results);
+
+  // A single chunk does not need another task
+  if (ids.size() <= chunkSize)
+  {
+    results.push_back(TC_AWAIT(f(ids)));
+    TC_RETURN(results);
+  }
+
+  // The tasks own f and their chunk: if this coroutine is cancelled while it
+  // waits for them, they keep running after it returned
+  auto const sharedF = std::make_shared<std::decay_t<F>>(std::forward<F>(f));
+  std::vector<tc::future<Result>> futures;
+  futures.reserve((ids.size() + chunkSize - 1) / chunkSize);
+  for (std::size_t i = 0; i < ids.size(); i += chunkSize)
+  {
+    auto const chunk = ids.subspan(i, std::min(chunkSize, ids.size() - i));
+    futures.push_back(tc::async_resumable(
+        [sharedF, chunk = std::vector<std::remove_const_t<Id>>(chunk.begin(), chunk.end())]() -> tc::cotask<Result> {
+          TC_RETURN(TC_AWAIT((*sharedF)(gsl::span<Id const>(chunk))));
+        }));
+  }
+
+  // when_all is ready once every task is done, failed or not
+  auto done = TC_AWAIT(tc::when_all(std::make_move_iterator(futures.begin()), std::make_move_iterator(futures.end())));
+  results.reserve(done.size());
+  for (auto& future : done)
+    results.push_back(future.get());
+  TC_RETURN(results);
+}
+}
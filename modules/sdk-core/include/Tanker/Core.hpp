@@ -1,15 +1,20 @@
 #pragma once
 
 #include <Tanker/AttachResult.hpp>
+#include <Tanker/CacheOccupancy.hpp>
 #include <Tanker/Crypto/Padding.hpp>
 #include <Tanker/Crypto/ResourceId.hpp>
 #include <Tanker/DataStore/Backend.hpp>
 #include <Tanker/EncryptionSession.hpp>
+#include <Tanker/Encryptor.hpp>
 #include <Tanker/Network/HttpClient.hpp>
 #include <Tanker/Oidc/NonceManager.hpp>
 #include <Tanker/ResourceKeys/Store.hpp>
 #include <Tanker/SdkInfo.hpp>
+#include <Tanker/Share.hpp>
 #include <Tanker/Streams/InputSource.hpp>
+#include <Tanker/Streams/RangeDecryptor.hpp>
+#include <Tanker/Streams/ReadAheadInputSource.hpp>
 #include <Tanker/Trustchain/DeviceId.hpp>
 #include <Tanker/Types/OidcAuthorizationCode.hpp>
 #include <Tanker/Types/OidcNonce.hpp>
@@ -20,10 +25,13 @@
 #include <Tanker/Types/VerificationKey.hpp>
 #include <Tanker/Users/Device.hpp>
 #include <Tanker/Verification/Verification.hpp>
+#include <Tanker/WorkerPool.hpp>
 
 #include <gsl/gsl-lite.hpp>
 #include <tconcurrent/coroutine.hpp>
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
 #include <optional>
 #include <string>
@@ -90,13 +98,15 @@ public:
                            std::vector<SPublicIdentity> const& spublicIdentities,
                            std::vector<SGroupId> const& sgroupIds,
                            ShareWithSelf shareWithSelf,
-                           std::optional<uint32_t> paddingStep);
+                           std::optional<uint32_t> paddingStep,
+                           Encryptor::StreamOptions const& streamOptions);
 
   tc::cotask<std::vector<uint8_t>> encrypt(gsl::span<uint8_t const> clearData,
                                            std::vector<SPublicIdentity> const& spublicIdentities,
                                            std::vector<SGroupId> const& sgroupIds,
                                            ShareWithSelf shareWithSelf,
-                                           std::optional<uint32_t> paddingStep);
+                                           std::optional<uint32_t> paddingStep,
+                                           Encryptor::StreamOptions const& streamOptions);
 
   tc::cotask<uint64_t> decrypt(gsl::span<uint8_t> decryptedData, gsl::span<uint8_t const> encryptedData);
 
@@ -105,6 +115,12 @@ public:
   tc::cotask<void> share(std::vector<SResourceId> const& sresourceIds,
                          std::vector<SPublicIdentity> const& publicIdentities,
                          std::vector<SGroupId> const& groupIds);
+  // Same as share(), without the limit on the number of resources: they are
+  // shared in batches, and onProgress is called after each of them
+  tc::cotask<void> bulkShare(std::vector<SResourceId> const& sresourceIds,
+                             std::vector<SPublicIdentity> const& publicIdentities,
+                             std::vector<SGroupId> const& groupIds,
+                             Share::ProgressHandler onProgress = nullptr);
 
   tc::cotask<SGroupId> createGroup(std::vector<SPublicIdentity> const& spublicIdentities);
   tc::cotask<void> updateGroupMembers(SGroupId const& groupIdString,
@@ -127,9 +143,12 @@ public:
       std::vector<SPublicIdentity> const& suserIds,
       std::vector<SGroupId> const& sgroupIds,
       ShareWithSelf shareWithSelf,
-      std::optional<uint32_t> paddingStep);
+      std::optional<uint32_t> paddingStep,
+      Encryptor::StreamOptions const& streamOptions);
 
   tc::cotask<std::tuple<Streams::InputSource, Crypto::ResourceId>> makeDecryptionStream(Streams::InputSource);
+  // Only for the stream formats, which are chunked
+  tc::cotask<Streams::RangeDecryptor> makeRangeDecryptor(Streams::PositionalInputSource);
 
   tc::cotask<EncryptionSession> makeEncryptionSession(std::vector<SPublicIdentity> const& spublicIdentities,
                                                       std::vector<SGroupId> const& sgroupIds,
@@ -144,10 +163,29 @@ public:
 
   tc::cotask<void> stop();
   void quickStop();
-  void nukeDatabase();
+  tc::cotask<void> nukeDatabase();
   void setSessionClosedHandler(SessionClosedHandler);
 
   void setHttpSessionToken(std::string_view);
+  // Number of threads used to encrypt and decrypt large buffers, 0 or 1 keeps
+  // everything on the calling thread (the default)
+  void setWorkerThreadCount(unsigned int threadCount);
+  // Users fetched less than maxAge ago are not fetched again, by default they
+  // always are
+  void setUserCacheMaxAge(std::optional<std::chrono::seconds> maxAge);
+  // Received resource keys are written to the cache in batches instead of one
+  // by one, the pending ones are written when the Core is stopped. Disabled by
+  // default.
+  void setResourceKeyWriteBehind(std::optional<ResourceKeys::WriteBehindOptions> options);
+  // Maximum number of requests sent to the server at once, the Core must be
+  // stopped
+  void setHttpConcurrency(std::size_t concurrentRequestCount);
+  // Applies to the streams made afterwards, by default they read their input
+  // only when their output has been consumed
+  void setStreamReadAhead(Streams::ReadAheadOptions options);
+
+  // Not all datastore backends support it, the built-in ones do
+  tc::cotask<CacheOccupancy> cacheOccupancy();
 
 private:
   tc::cotask<Status> startImpl(std::string const& b64Identity);
@@ -165,6 +203,7 @@ private:
                                                  std::optional<std::string> const& withTokenNonce);
   tc::cotask<std::optional<Crypto::SymmetricKey>> tryGetResourceKey(Crypto::SimpleResourceId const&);
   tc::cotask<Crypto::SymmetricKey> getResourceKey(Crypto::SimpleResourceId const&);
+  tc::cotask<ResourceKeys::KeysResult> findKeysToShare(std::vector<SResourceId> const& sresourceIds);
 
   std::optional<std::string> makeWithTokenRandomNonce(VerifyWithToken wanted);
   tc::cotask<std::string> getSessionToken(Verification::Verification const& verification,
@@ -187,5 +226,10 @@ private:
   std::unique_ptr<DataStore::Backend> _datastoreBackend;
   std::shared_ptr<Session> _session;
   std::shared_ptr<Oidc::NonceManager> _oidcManager;
+  std::shared_ptr<WorkerPool> _workerPool;
+  std::optional<std::chrono::seconds> _userCacheMaxAge;
+  std::optional<ResourceKeys::WriteBehindOptions> _resourceKeyWriteBehind;
+  std::size_t _httpConcurrency = Network::DefaultConcurrentRequestCount;
+  Streams::ReadAheadOptions _streamReadAhead;
 };
 }
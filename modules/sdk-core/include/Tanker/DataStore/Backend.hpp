@@ -1,7 +1,9 @@
 #pragma once
 
 #include <gsl/gsl-lite.hpp>
+#include <tconcurrent/coroutine.hpp>
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -20,6 +22,13 @@ enum class OnConflict
 
 class DataStore;
 
+struct CacheUsage
+{
+  std::uint64_t entries = 0;
+  // Keys and values, without the storage overhead
+  std::uint64_t bytes = 0;
+};
+
 class Backend
 {
 public:
@@ -28,6 +37,8 @@ public:
   virtual std::unique_ptr<DataStore> open(std::string const& dataPath, std::string const& cachePath) = 0;
 };
 
+// Operations are awaitable so that backends can run them away from the event
+// loop. The spans they are given only need to stay valid until they complete.
 class DataStore
 {
 public:
@@ -36,12 +47,25 @@ public:
 
   virtual ~DataStore() = default;
 
-  virtual void nuke() = 0;
+  virtual tc::cotask<void> nuke() = 0;
+
+  virtual tc::cotask<void> putSerializedDevice(gsl::span<uint8_t const> device) = 0;
+  virtual tc::cotask<std::optional<std::vector<uint8_t>>> findSerializedDevice() = 0;
+
+  virtual tc::cotask<void> putCacheValues(gsl::span<std::pair<Key, Value> const> keyValues,
+                                          OnConflict onConflict) = 0;
+  virtual tc::cotask<std::vector<std::optional<std::vector<uint8_t>>>> findCacheValues(
+      gsl::span<Key const> keys) = 0;
 
-  virtual void putSerializedDevice(gsl::span<uint8_t const> device) = 0;
-  virtual std::optional<std::vector<uint8_t>> findSerializedDevice() = 0;
+  // Counts the cache entries whose key starts with prefix. Not all backends
+  // support it.
+  virtual tc::cotask<CacheUsage> findCacheUsage(Key prefix);
 
-  virtual void putCacheValues(gsl::span<std::pair<Key, Value> const> keyValues, OnConflict onConflict) = 0;
-  virtual std::vector<std::optional<std::vector<uint8_t>>> findCacheValues(gsl::span<Key const> keys) = 0;
+  // Whether the stores must encrypt the values they put. Only backends whose
+  // data never leaves the process may return false.
+  virtual bool needsValueEncryption() const
+  {
+    return true;
+  }
 };
 }
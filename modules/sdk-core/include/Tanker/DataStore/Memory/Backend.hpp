@@ -0,0 +1,80 @@
+#pragma once
+
+#include <Tanker/DataStore/Backend.hpp>
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace Tanker::DataStore
+{
+struct MemoryOptions
+{
+  // Bound on the bytes of cached keys and values, 0 means no bound. The oldest
+  // written resource keys, groups and transparent sessions are dropped first,
+  // they are fetched again when needed.
+  std::size_t maxCacheSize = 0;
+  // The values never leave the process, so by default the stores do not
+  // encrypt them
+  bool encryptValues = false;
+};
+
+namespace detail
+{
+struct MemoryDevice;
+struct MemoryCache;
+}
+
+/**
+ * Keeps the databases in memory, for processes that do not need to persist
+ * anything, e.g. ephemeral server workers.
+ *
+ * The databases are kept as long as the backend lives: opening the same paths
+ * again gives back the same data, and a database cannot be opened twice at the
+ * same time.
+ */
+class MemoryBackend : public Backend
+{
+public:
+  explicit MemoryBackend(MemoryOptions options = {});
+
+  std::unique_ptr<DataStore> open(std::string const& dataPath, std::string const& cachePath) override;
+
+private:
+  MemoryOptions _options;
+  std::map<std::string, std::shared_ptr<detail::MemoryDevice>> _devices;
+  std::map<std::string, std::shared_ptr<detail::MemoryCache>> _caches;
+};
+
+class MemoryDataStore : public DataStore
+{
+public:
+  MemoryDataStore(MemoryDataStore const&) = delete;
+  MemoryDataStore& operator=(MemoryDataStore const&) = delete;
+  ~MemoryDataStore() override;
+
+  tc::cotask<void> nuke() override;
+
+  tc::cotask<void> putSerializedDevice(gsl::span<uint8_t const> device) override;
+  tc::cotask<std::optional<std::vector<uint8_t>>> findSerializedDevice() override;
+
+  tc::cotask<void> putCacheValues(gsl::span<std::pair<Key, Value> const> keyValues, OnConflict onConflict) override;
+  tc::cotask<std::vector<std::optional<std::vector<uint8_t>>>> findCacheValues(gsl::span<Key const> keys) override;
+
+  tc::cotask<CacheUsage> findCacheUsage(Key prefix) override;
+
+  bool needsValueEncryption() const override;
+
+private:
+  std::shared_ptr<detail::MemoryDevice> _device;
+  std::shared_ptr<detail::MemoryCache> _cache;
+  bool _encryptValues;
+
+  MemoryDataStore(std::shared_ptr<detail::MemoryDevice> device,
+                  std::shared_ptr<detail::MemoryCache> cache,
+                  bool encryptValues);
+
+  friend class MemoryBackend;
+};
+}
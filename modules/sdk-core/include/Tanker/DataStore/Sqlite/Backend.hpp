@@ -3,32 +3,118 @@
 #include <Tanker/DataStore/Backend.hpp>
 #include <Tanker/DataStore/Connection.hpp>
 
+#include <tconcurrent/future.hpp>
+#include <tconcurrent/thread_pool.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+struct sqlite3_stmt;
+
 namespace Tanker::DataStore
 {
 inline constexpr auto MemoryPath = ":memory:";
 
+struct SqliteOptions
+{
+  // Run the cache database with a write-ahead log and synchronous=NORMAL
+  // instead of a rollback journal and synchronous=FULL. Commits no longer wait
+  // for an fsync, the database stays consistent but the last writes can be lost
+  // on power failure. The device database always keeps the safe defaults.
+  bool writeAheadLog = false;
+  // Bound on the size of the cache database file, in bytes, 0 means no bound.
+  // The least recently used resource keys, groups and transparent sessions are
+  // evicted when it is exceeded, they are fetched again when needed.
+  std::size_t maxCacheSize = 0;
+};
+
 class SqliteBackend : public Backend
 {
 public:
+  explicit SqliteBackend(SqliteOptions options = {});
+
   std::unique_ptr<DataStore> open(std::string const& dataPath, std::string const& cachePath) override;
+
+private:
+  SqliteOptions _options;
+};
+
+namespace detail
+{
+struct StatementDeleter
+{
+  void operator()(sqlite3_stmt* statement) const;
 };
+}
 
+using StatementPtr = std::unique_ptr<sqlite3_stmt, detail::StatementDeleter>;
+
+/**
+ * All the SQLite calls run on a storage thread owned by the store, so that disk
+ * I/O never blocks the event loop. Operations are queued in the order they are
+ * made: a read always sees the writes made before it.
+ *
+ * Writes that pile up while the storage thread is busy are committed in a
+ * single transaction. When the cache is bounded, the evictions run after the
+ * commits.
+ */
 class SqliteDataStore : public DataStore
 {
 public:
-  void nuke() override;
+  SqliteDataStore(SqliteDataStore const&) = delete;
+  SqliteDataStore& operator=(SqliteDataStore const&) = delete;
+  ~SqliteDataStore() override;
+
+  tc::cotask<void> nuke() override;
+
+  tc::cotask<void> putSerializedDevice(gsl::span<uint8_t const> device) override;
+  tc::cotask<std::optional<std::vector<uint8_t>>> findSerializedDevice() override;
 
-  void putSerializedDevice(gsl::span<uint8_t const> device) override;
-  std::optional<std::vector<uint8_t>> findSerializedDevice() override;
+  tc::cotask<void> putCacheValues(gsl::span<std::pair<Key, Value> const> keyValues, OnConflict onConflict) override;
+  tc::cotask<std::vector<std::optional<std::vector<uint8_t>>>> findCacheValues(gsl::span<Key const> keys) override;
 
-  void putCacheValues(gsl::span<std::pair<Key, Value> const> keyValues, OnConflict onConflict) override;
-  std::vector<std::optional<std::vector<uint8_t>>> findCacheValues(gsl::span<Key const> keys) override;
+  tc::cotask<CacheUsage> findCacheUsage(Key prefix) override;
 
 private:
+  struct PendingWrite
+  {
+    std::function<void()> run;
+    std::exception_ptr error;
+  };
+
   ConnPtr _dbDevice;
   ConnPtr _dbCache;
+  // Declared after the connection so that they are finalized before it closes
+  std::array<StatementPtr, static_cast<std::size_t>(OnConflict::Last)> _putStatements;
+  StatementPtr _findStatement;
+  StatementPtr _recordAccessStatement;
+  StatementPtr _evictionStatement;
+  std::size_t _maxCacheSize;
+
+  std::mutex _pendingMutex;
+  std::vector<std::shared_ptr<PendingWrite>> _pendingWrites;
+  tc::shared_future<void> _pendingFlush;
+
+  tc::thread_pool _storageThread;
+
+  SqliteDataStore(ConnPtr dbDevice, ConnPtr dbCache, std::size_t maxCacheSize);
+
+  tc::executor storageExecutor();
+  tc::shared_future<void> enqueueWrite(std::shared_ptr<PendingWrite> write);
+  void flushWrites();
 
-  SqliteDataStore(ConnPtr dbDevice, ConnPtr dbCache);
+  sqlite3_stmt* putStatement(OnConflict onConflict);
+  void executeOnCache(char const* sql);
+  void putCacheValuesNow(gsl::span<std::pair<Key, Value> const> keyValues, OnConflict onConflict);
+  std::vector<std::optional<std::vector<uint8_t>>> findCacheValuesNow(gsl::span<Key const> keys);
+  void recordAccessesNow(gsl::span<Key const> keys, std::int64_t accessTime);
+  std::uint64_t cacheFileSize();
+  void evictNow();
 
   friend class SqliteBackend;
 };
@@ -8,6 +8,7 @@
 #include <gsl/gsl-lite.hpp>
 
 #include <cstdint>
+#include <string_view>
 #include <vector>
 
 namespace Tanker
@@ -20,10 +21,22 @@ T extractBlob(Field const& f)
   return T(f.blob, f.blob + f.len);
 }
 
+class DataStore;
+
 [[noreturn]] void handleError(Errors::Exception const& e);
 
-std::vector<uint8_t> encryptValue(Crypto::SymmetricKey const& userSecret, gsl::span<uint8_t const> value);
-tc::cotask<std::vector<uint8_t>> decryptValue(Crypto::SymmetricKey const& userSecret,
+// A bounded cache only evicts the entries that are fetched again when they are
+// missing: resource keys, groups and transparent sessions, with their indexes.
+// The others, e.g. the provisional user keys or the session's version, stay.
+gsl::span<std::string_view const> evictableKeyPrefixes();
+bool isEvictableKey(gsl::span<uint8_t const> key);
+
+// The values are left as is when db does not need them encrypted
+std::vector<uint8_t> encryptValue(DataStore const& db,
+                                  Crypto::SymmetricKey const& userSecret,
+                                  gsl::span<uint8_t const> value);
+tc::cotask<std::vector<uint8_t>> decryptValue(DataStore const& db,
+                                              Crypto::SymmetricKey const& userSecret,
                                               gsl::span<uint8_t const> encryptedValue);
 }
 }
@@ -71,6 +71,10 @@ private:
   tc::cotask<std::vector<Trustchain::GroupAction>> getGroupEntries(gsl::span<Trustchain::GroupId const>);
   tc::cotask<void> fetch(gsl::span<Trustchain::GroupId const> groupIds);
   tc::cotask<Accessor::GroupPullResult> getGroups(std::vector<Trustchain::GroupId> groupIds);
+  // The entries to apply on top of a stored group, or nullopt if its history
+  // must be replayed from the start
+  static std::optional<gsl::span<Trustchain::GroupAction const>> entriesAfterHead(
+      Group const& storedGroup, gsl::span<Trustchain::GroupAction const> entries);
   tc::cotask<std::vector<Group>> processGroupEntries(GroupMap const& groups);
   tc::cotask<std::vector<EncryptionKeyPairEntry>> getEncryptionKeyPairsImpl(
       gsl::span<Crypto::PublicEncryptionKey const> publicEncryptionKeys);
@@ -12,8 +12,15 @@
 #include <Tanker/Trustchain/TrustchainId.hpp>
 #include <Tanker/Users/User.hpp>
 
+#include <tconcurrent/coroutine.hpp>
+
 #include <vector>
 
+namespace Tanker
+{
+class WorkerPool;
+}
+
 namespace Tanker::Groups
 {
 Trustchain::Actions::UserGroupCreation::v1::SealedPrivateEncryptionKeysForUsers generateGroupKeysForUsers1(
@@ -38,6 +45,18 @@ Trustchain::Actions::UserGroupCreation::v3::ProvisionalMembers generateGroupKeys
     Crypto::PrivateEncryptionKey const& groupPrivateEncryptionKey,
     std::vector<Trustchain::Actions::RawUserGroupProvisionalMember3> const& users);
 
+// Same as above, the keys are sealed on the worker pool when there is one. The
+// members are in the order of users either way.
+tc::cotask<Trustchain::Actions::UserGroupCreation::v2::Members> generateGroupKeysForUsers2(
+    WorkerPool* workerPool,
+    Crypto::PrivateEncryptionKey const& groupPrivateEncryptionKey,
+    std::vector<Users::User> const& users);
+
+tc::cotask<Trustchain::Actions::UserGroupCreation::v3::ProvisionalMembers> generateGroupKeysForProvisionalUsers3(
+    WorkerPool* workerPool,
+    Crypto::PrivateEncryptionKey const& groupPrivateEncryptionKey,
+    std::vector<ProvisionalUsers::PublicUser> const& users);
+
 Trustchain::Actions::UserGroupCreation1 createUserGroupCreationV1Action(
     Crypto::SignatureKeyPair const& signatureKeyPair,
     Crypto::PublicEncryptionKey const& publicEncryptionKey,
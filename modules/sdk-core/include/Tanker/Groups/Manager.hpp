@@ -20,6 +20,11 @@
 #include <string>
 #include <vector>
 
+namespace Tanker
+{
+class WorkerPool;
+}
+
 namespace Tanker::Users
 {
 class IUserAccessor;
@@ -54,29 +59,33 @@ struct MembersToRemove
 tc::cotask<MembersToRemove> fetchMembersToRemove(Users::IUserAccessor& userAccessor,
                                                  ProcessedIdentities const& identities);
 
-Trustchain::Actions::UserGroupCreation makeUserGroupCreationAction(
+// The member keys are sealed on the worker pool when there is one
+tc::cotask<Trustchain::Actions::UserGroupCreation> makeUserGroupCreationAction(
     std::vector<Users::User> const& memberUsers,
     std::vector<ProvisionalUsers::PublicUser> const& memberProvisionalUsers,
     Crypto::SignatureKeyPair const& groupSignatureKeyPair,
     Crypto::EncryptionKeyPair const& groupEncryptionKeyPair,
     Trustchain::TrustchainId const& trustchainId,
     Trustchain::DeviceId const& deviceId,
-    Crypto::PrivateSignatureKey const& privateSignatureKey);
+    Crypto::PrivateSignatureKey const& privateSignatureKey,
+    WorkerPool* workerPool = nullptr);
 
 tc::cotask<SGroupId> create(Users::IUserAccessor& userAccessor,
                             IRequester& requester,
                             std::vector<SPublicIdentity> spublicIdentities,
                             Trustchain::TrustchainId const& trustchainId,
                             Trustchain::DeviceId const& deviceId,
-                            Crypto::PrivateSignatureKey const& privateSignatureKey);
+                            Crypto::PrivateSignatureKey const& privateSignatureKey,
+                            WorkerPool* workerPool = nullptr);
 
-Trustchain::Actions::UserGroupAddition makeUserGroupAdditionAction(
+tc::cotask<Trustchain::Actions::UserGroupAddition> makeUserGroupAdditionAction(
     std::vector<Users::User> const& memberUsers,
     std::vector<ProvisionalUsers::PublicUser> const& memberProvisionalUsers,
     InternalGroup const& group,
     Trustchain::TrustchainId const& trustchainId,
     Trustchain::DeviceId const& deviceId,
-    Crypto::PrivateSignatureKey const& privateSignatureKey);
+    Crypto::PrivateSignatureKey const& privateSignatureKey,
+    WorkerPool* workerPool = nullptr);
 
 Trustchain::Actions::UserGroupRemoval makeUserGroupRemovalAction(
     std::vector<Trustchain::UserId> const& membersToRemove,
@@ -94,5 +103,6 @@ tc::cotask<void> updateMembers(Users::IUserAccessor& userAccessor,
                                std::vector<SPublicIdentity> spublicIdentitiesToRemove,
                                Trustchain::TrustchainId const& trustchainId,
                                Trustchain::DeviceId const& deviceId,
-                               Crypto::PrivateSignatureKey const& privateSignatureKey);
+                               Crypto::PrivateSignatureKey const& privateSignatureKey,
+                               WorkerPool* workerPool = nullptr);
 }
@@ -5,6 +5,8 @@
 #include <Tanker/Groups/Group.hpp>
 #include <Tanker/Trustchain/GroupId.hpp>
 
+#include <gsl/gsl-lite.hpp>
+
 #include <optional>
 
 #include <tconcurrent/coroutine.hpp>
@@ -27,6 +29,8 @@ public:
   Store(Crypto::SymmetricKey const& userSecret, DataStore::DataStore* db);
 
   tc::cotask<void> put(Group const& group);
+  // All the groups are written at once
+  tc::cotask<void> put(gsl::span<Group const> groups);
 
   tc::cotask<std::optional<Group>> findById(Trustchain::GroupId const& groupId) const;
   tc::cotask<std::optional<InternalGroup>> findInternalByPublicEncryptionKey(
@@ -34,6 +38,9 @@ public:
   tc::cotask<std::optional<Group>> findByPublicEncryptionKey(
       Crypto::PublicEncryptionKey const& publicEncryptionKey) const;
 
+  // Includes the index entries
+  tc::cotask<DataStore::CacheUsage> cacheUsage() const;
+
 private:
   Crypto::SymmetricKey _userSecret;
   DataStore::DataStore* _db;
@@ -5,8 +5,12 @@
 #include <Tanker/Trustchain/GroupAction.hpp>
 #include <Tanker/Trustchain/UserId.hpp>
 
+#include <gsl/gsl-lite.hpp>
 #include <tconcurrent/coroutine.hpp>
 
+#include <optional>
+#include <vector>
+
 namespace Tanker::Users
 {
 class IUserAccessor;
@@ -36,5 +40,20 @@ tc::cotask<std::optional<Group>> processGroupEntries(Users::ILocalUserAccessor&
                                                      ProvisionalUsers::IAccessor& provisionalUsersAccessor,
                                                      std::optional<Group> const& previousGroup,
                                                      gsl::span<Trustchain::GroupAction const> entries);
+
+struct GroupEntries
+{
+  std::optional<Group> previousGroup;
+  gsl::span<Trustchain::GroupAction const> entries;
+};
+
+// Same as processGroupEntries, but the authors of all the groups are pulled at
+// once, the provisional keys are refreshed once and the local user is pulled at
+// most once. The result is in the order of groups.
+tc::cotask<std::vector<std::optional<Group>>> processGroupsEntries(
+    Users::ILocalUserAccessor& localUserAccessor,
+    Users::IUserAccessor& userAccessor,
+    ProvisionalUsers::IAccessor& provisionalUsersAccessor,
+    gsl::span<GroupEntries const> groups);
 }
 }
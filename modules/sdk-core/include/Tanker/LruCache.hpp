@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <map>
+#include <utility>
+
+namespace Tanker
+{
+struct CacheStats
+{
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+};
+
+/**
+ * LruCache keeps at most `capacity` values, dropping the least recently used
+ * one when full.
+ *
+ * It is not thread-safe, it is meant to be used from the Core's executor only.
+ *
+ * The optional onDrop handler is called on every value that leaves the cache
+ * (eviction, replacement, erase, clear or destruction), e.g. to wipe secrets.
+ */
+template <typename Key, typename Value>
+class LruCache
+{
+public:
+  using DropHandler = std::function<void(Value&)>;
+
+  explicit LruCache(std::size_t capacity, DropHandler onDrop = nullptr)
+    : _capacity(capacity), _onDrop(std::move(onDrop))
+  {
+  }
+
+  ~LruCache()
+  {
+    clear();
+  }
+
+  LruCache(LruCache const&) = delete;
+  LruCache(LruCache&&) = delete;
+  LruCache& operator=(LruCache const&) = delete;
+  LruCache& operator=(LruCache&&) = delete;
+
+  // Returns nullptr on a miss. The pointer is invalidated by the next put()
+  Value* get(Key const& key)
+  {
+    return get(key, [](Value const&) { return true; });
+  }
+
+  // Same as get(), but values for which isValid returns false (e.g. expired
+  // ones) are dropped and count as a miss
+  template <typename Predicate>
+  Value* get(Key const& key, Predicate&& isValid)
+  {
+    auto const it = _index.find(key);
+    if (it != _index.end() && !isValid(std::as_const(it->second->second)))
+    {
+      drop(it->second);
+      _index.erase(it);
+    }
+    else if (it != _index.end())
+    {
+      ++_stats.hits;
+      _entries.splice(_entries.begin(), _entries, it->second);
+      return &it->second->second;
+    }
+    ++_stats.misses;
+    return nullptr;
+  }
+
+  void put(Key const& key, Value value)
+  {
+    if (_capacity == 0)
+    {
+      if (_onDrop)
+        _onDrop(value);
+      return;
+    }
+
+    if (auto const it = _index.find(key); it != _index.end())
+    {
+      if (_onDrop)
+        _onDrop(it->second->second);
+      it->second->second = std::move(value);
+      _entries.splice(_entries.begin(), _entries, it->second);
+      return;
+    }
+
+    if (_entries.size() == _capacity)
+    {
+      _index.erase(_entries.back().first);
+      drop(std::prev(_entries.end()));
+    }
+    _entries.emplace_front(key, std::move(value));
+    _index.emplace(key, _entries.begin());
+  }
+
+  void erase(Key const& key)
+  {
+    if (auto const it = _index.find(key); it != _index.end())
+    {
+      drop(it->second);
+      _index.erase(it);
+    }
+  }
+
+  void clear()
+  {
+    _index.clear();
+    while (!_entries.empty())
+      drop(_entries.begin());
+  }
+
+  std::size_t size() const
+  {
+    return _entries.size();
+  }
+
+  std::size_t capacity() const
+  {
+    return _capacity;
+  }
+
+  CacheStats const& stats() const
+  {
+    return _stats;
+  }
+
+private:
+  using Entries = std::list<std::pair<Key, Value>>;
+
+  void drop(typename Entries::iterator it)
+  {
+    if (_onDrop)
+      _onDrop(it->second);
+    _entries.erase(it);
+  }
+
+  std::size_t _capacity;
+  DropHandler _onDrop;
+  Entries _entries;
+  std::map<Key, typename Entries::iterator> _index;
+  CacheStats _stats;
+};
+}
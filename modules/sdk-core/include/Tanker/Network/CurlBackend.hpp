@@ -10,6 +10,22 @@
 
 namespace Tanker::Network
 {
+struct CurlBackendOptions
+{
+  // Whole request, including the connection
+  std::chrono::milliseconds timeout = std::chrono::seconds(30);
+  std::chrono::milliseconds connectTimeout = std::chrono::seconds(10);
+  // Idle connections kept open to be reused by the next requests
+  long maxIdleConnections = 8;
+  // Delay before TCP keep-alive probes are sent on an idle connection
+  std::chrono::seconds keepAliveIdle = std::chrono::seconds(60);
+  // Delay between two TCP keep-alive probes
+  std::chrono::seconds keepAliveInterval = std::chrono::seconds(60);
+  // Negotiate HTTP/2 over TLS and multiplex the requests on a single
+  // connection when the server supports it, HTTP/1.1 is used otherwise
+  bool http2 = true;
+};
+
 class CurlBackend : public Backend
 {
 public:
@@ -18,7 +34,7 @@ public:
   CurlBackend& operator=(CurlBackend const&) = delete;
   CurlBackend& operator=(CurlBackend&&) = delete;
 
-  CurlBackend(SdkInfo sdkInfo, std::chrono::nanoseconds timeout = std::chrono::seconds(30));
+  CurlBackend(SdkInfo sdkInfo, CurlBackendOptions options = {});
 
   tc::cotask<HttpResponse> fetch(HttpRequest req) override;
 
@@ -26,5 +42,6 @@ private:
   tcurl::read_all_result::header_type _headers;
   tcurl::multi _cl;
   SdkInfo _sdkInfo;
+  CurlBackendOptions _options;
 };
 }
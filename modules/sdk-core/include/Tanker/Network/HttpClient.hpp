@@ -18,6 +18,7 @@
 #include <tconcurrent/semaphore.hpp>
 
 #include <chrono>
+#include <cstddef>
 #include <optional>
 #include <string_view>
 
@@ -43,12 +44,18 @@ std::error_code make_error_code(HttpError const& e);
 
 using HttpResult = boost::outcome_v2::result<nlohmann::json, HttpError>;
 
-static inline constexpr auto ConcurrentRequestCount = 4;
+static inline constexpr std::size_t DefaultConcurrentRequestCount = 4;
 
 class HttpClient
 {
 public:
-  HttpClient(std::string baseUrl, std::string instanceId, Backend* backend, SdkInfo const& info);
+  // At most concurrentRequestCount requests are sent at once, the others wait
+  // for a slot
+  HttpClient(std::string baseUrl,
+             std::string instanceId,
+             Backend* backend,
+             SdkInfo const& info,
+             std::size_t concurrentRequestCount = DefaultConcurrentRequestCount);
   HttpClient(HttpClient const&) = delete;
   HttpClient(HttpClient&&) = delete;
   HttpClient& operator=(HttpClient const&) = delete;
@@ -80,7 +87,7 @@ private:
   std::string _instanceId;
   std::string _accessToken;
   Backend* _backend;
-  tc::semaphore _semaphore{ConcurrentRequestCount};
+  tc::semaphore _semaphore;
   SdkInfo const& _info;
 
   Trustchain::DeviceId _deviceId;
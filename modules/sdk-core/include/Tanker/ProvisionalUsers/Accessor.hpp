@@ -1,9 +1,14 @@
 #pragma once
 
 #include <Tanker/ProvisionalUsers/IAccessor.hpp>
+#include <Tanker/TaskCoalescer.hpp>
+#include <Tanker/Trustchain/Actions/ProvisionalIdentityClaim.hpp>
+#include <Tanker/Trustchain/UserId.hpp>
 #include <Tanker/Types/ProvisionalUserKeys.hpp>
 #include <Tanker/Users/IUserAccessor.hpp>
 
+#include <gsl/gsl-lite.hpp>
+
 namespace Tanker::Users
 {
 class ILocalUserAccessor;
@@ -37,12 +42,31 @@ public:
   tc::cotask<std::optional<ProvisionalUserKeys>> findEncryptionKeysFromCache(
       Crypto::PublicSignatureKey const& appPublicSigKey, Crypto::PublicSignatureKey const& tankerPublicSigKey) override;
 
+  // Concurrent refreshes share a single fetch, and only the claims after the
+  // last one processed are verified and stored
   tc::cotask<void> refreshKeys() override;
+  // Same as refreshKeys(), but processes all the claims, in case keys went
+  // missing after their claim was processed
+  tc::cotask<void> refreshAllKeys();
+
+  // The claims after lastClaimHash, or all of them when it is not found
+  static gsl::span<Trustchain::Actions::ProvisionalIdentityClaim const> claimsAfter(
+      gsl::span<Trustchain::Actions::ProvisionalIdentityClaim const> claims,
+      std::optional<Crypto::Hash> const& lastClaimHash);
 
 private:
+  struct RefreshResult
+  {
+    Trustchain::UserId id;
+  };
+
   IRequester* _requester;
   Users::IUserAccessor* _userAccessor;
   Users::ILocalUserAccessor* _localUserAccessor;
   ProvisionalUserKeysStore* _provisionalUserKeysStore;
+  TaskCoalescer<RefreshResult> _refreshCoalescer;
+  TaskCoalescer<RefreshResult> _fullRefreshCoalescer;
+
+  tc::cotask<void> refreshKeysImpl(bool allClaims);
 };
 }
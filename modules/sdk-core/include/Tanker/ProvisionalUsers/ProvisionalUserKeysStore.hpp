@@ -1,5 +1,6 @@
 #pragma once
 
+#include <Tanker/Crypto/Hash.hpp>
 #include <Tanker/Crypto/PublicSignatureKey.hpp>
 #include <Tanker/Crypto/SymmetricKey.hpp>
 #include <Tanker/DataStore/Backend.hpp>
@@ -28,6 +29,14 @@ public:
   tc::cotask<std::optional<Tanker::ProvisionalUserKeys>> findProvisionalUserKeysByAppPublicSignatureKey(
       Crypto::PublicSignatureKey const& appPublicSignatureKey) const;
 
+  // The hash of the last claim block whose keys were put, the claims up to it
+  // are not processed again
+  tc::cotask<void> putLastClaimHash(Crypto::Hash const& hash);
+  tc::cotask<std::optional<Crypto::Hash>> findLastClaimHash() const;
+
+  // Includes the index entries
+  tc::cotask<DataStore::CacheUsage> cacheUsage() const;
+
 private:
   Crypto::SymmetricKey _userSecret;
   DataStore::DataStore* _db;
@@ -4,7 +4,9 @@
 #include <Tanker/ProvisionalUsers/IAccessor.hpp>
 #include <Tanker/ResourceKeys/KeysResult.hpp>
 #include <Tanker/Trustchain/Actions/KeyPublish.hpp>
+#include <Tanker/Trustchain/KeyPublishAction.hpp>
 
+#include <gsl/gsl-lite.hpp>
 #include <tconcurrent/coroutine.hpp>
 
 namespace Tanker
@@ -27,10 +29,22 @@ class Store;
 
 namespace ReceiveKey
 {
+tc::cotask<ResourceKeys::KeyResult> decryptKey(Users::ILocalUserAccessor& localUserAccessor,
+                                               Groups::IAccessor& GroupAccessor,
+                                               ProvisionalUsers::IAccessor& provisionalUsersAccessor,
+                                               Trustchain::Actions::KeyPublish const& kp);
+
 tc::cotask<ResourceKeys::KeyResult> decryptAndStoreKey(ResourceKeys::Store& resourceKeyStore,
                                                        Users::ILocalUserAccessor& localUserAccessor,
                                                        Groups::IAccessor& GroupAccessor,
                                                        ProvisionalUsers::IAccessor& provisionalUsersAccessor,
                                                        Trustchain::Actions::KeyPublish const& kp);
+
+// Decrypts all the keys first, then stores them with a single Store::putKeys
+tc::cotask<ResourceKeys::KeysResult> decryptAndStoreKeys(ResourceKeys::Store& resourceKeyStore,
+                                                         Users::ILocalUserAccessor& localUserAccessor,
+                                                         Groups::IAccessor& GroupAccessor,
+                                                         ProvisionalUsers::IAccessor& provisionalUsersAccessor,
+                                                         gsl::span<Trustchain::KeyPublishAction const> kps);
 }
 }
@@ -2,6 +2,7 @@
 
 #include <Tanker/Crypto/SymmetricKey.hpp>
 #include <Tanker/Groups/IAccessor.hpp>
+#include <Tanker/LruCache.hpp>
 #include <Tanker/ProvisionalUsers/IAccessor.hpp>
 #include <Tanker/ResourceKeys/Store.hpp>
 #include <Tanker/TaskCoalescer.hpp>
@@ -19,11 +20,14 @@ namespace Tanker::ResourceKeys
 class Accessor
 {
 public:
+  static constexpr std::size_t DefaultKeyCacheCapacity = 4096;
+
   Accessor(Users::IRequester* client,
            Users::ILocalUserAccessor* localUserAccessor,
            Groups::IAccessor* groupAccessor,
            ProvisionalUsers::IAccessor* provisionalUsersAccessor,
-           Store* resourceKeyStore);
+           Store* resourceKeyStore,
+           std::size_t keyCacheCapacity = DefaultKeyCacheCapacity);
   Accessor() = delete;
   Accessor(Accessor const&) = delete;
   Accessor(Accessor&&) = delete;
@@ -35,7 +39,13 @@ public:
   tc::cotask<boost::container::flat_map<Crypto::SimpleResourceId, Crypto::SymmetricKey>> tryFindKeys(
       std::vector<Crypto::SimpleResourceId> const& resourceId);
 
+  // Lookups of the in-memory key cache, misses go to the Store
+  CacheStats const& keyCacheStats() const;
+  // Wipes the keys kept in memory
+  void clearKeyCache();
+
 private:
+  tc::cotask<KeysResult> getKeys(std::vector<Crypto::SimpleResourceId> const& resourceIds);
   tc::cotask<KeysResult> findOrFetchKeys(gsl::span<Crypto::SimpleResourceId const> resourceIds);
   [[noreturn]] void throwForMissingKeys(gsl::span<Crypto::SimpleResourceId const> resourceIds,
                                         KeysResult const& result);
@@ -46,5 +56,6 @@ private:
   ProvisionalUsers::IAccessor* _provisionalUsersAccessor;
   Store* _resourceKeyStore;
   Tanker::TaskCoalescer<KeyResult> _cache;
+  LruCache<Crypto::SimpleResourceId, Crypto::SymmetricKey> _keys;
 };
 }
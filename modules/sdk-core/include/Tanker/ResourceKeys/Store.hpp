@@ -4,10 +4,14 @@
 #include <Tanker/DataStore/Backend.hpp>
 #include <Tanker/ResourceKeys/KeysResult.hpp>
 
+#include <boost/container/flat_map.hpp>
 #include <tconcurrent/coroutine.hpp>
+#include <tconcurrent/future.hpp>
 
 #include <gsl/gsl-lite.hpp>
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
 #include <optional>
 
@@ -21,6 +25,14 @@ class SymmetricKey;
 
 namespace Tanker::ResourceKeys
 {
+struct WriteBehindOptions
+{
+  // The pending keys are written once there are this many
+  std::size_t maxPendingKeys = 256;
+  // or this long after the first one was put
+  std::chrono::milliseconds maxDelay{500};
+};
+
 class Store
 {
 public:
@@ -30,15 +42,41 @@ public:
   Store& operator=(Store&&) = delete;
 
   Store(Crypto::SymmetricKey const& userSecret, DataStore::DataStore* db);
+  ~Store();
 
   tc::cotask<void> putKey(Crypto::SimpleResourceId const& resourceId, Crypto::SymmetricKey const& key);
+  // Encrypts all the keys and writes them in a single DataStore call
+  tc::cotask<void> putKeys(gsl::span<KeyResult const> keys);
+
+  // With write-behind, the put keys are kept in memory and written later, all
+  // at once. They are found in the meantime, but are lost if the process
+  // dies, they are then fetched again. Disabled by default.
+  void setWriteBehind(std::optional<WriteBehindOptions> options);
+  // Writes the pending keys now. The delayed write is canceled and awaited
+  // first, once it returns no task uses the store anymore.
+  tc::cotask<void> flush();
 
   tc::cotask<Crypto::SymmetricKey> getKey(Crypto::SimpleResourceId const& resourceId) const;
 
   tc::cotask<std::optional<Crypto::SymmetricKey>> findKey(Crypto::SimpleResourceId const& resourceId) const;
+  // Looks all the keys up in a single query, keys that are not found are
+  // omitted from the result
+  tc::cotask<KeysResult> findKeys(gsl::span<Crypto::SimpleResourceId const> resourceIds) const;
+
+  tc::cotask<DataStore::CacheUsage> cacheUsage() const;
 
 private:
   Crypto::SymmetricKey _userSecret;
   DataStore::DataStore* _db;
+  std::optional<WriteBehindOptions> _writeBehind;
+  boost::container::flat_map<Crypto::SimpleResourceId, Crypto::SymmetricKey> _pendingKeys;
+  std::optional<tc::future<void>> _delayedFlush;
+  bool _flushScheduled = false;
+
+  tc::cotask<void> writeKeys(gsl::span<KeyResult const> keys);
+  tc::cotask<void> writePendingKeys();
+  tc::cotask<void> cancelDelayedFlush();
+  tc::cotask<KeysResult> findStoredKeys(gsl::span<Crypto::SimpleResourceId const> resourceIds) const;
+  void scheduleFlush();
 };
 }
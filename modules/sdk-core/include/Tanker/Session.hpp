@@ -20,11 +20,14 @@
 #include <Tanker/Users/LocalUserStore.hpp>
 #include <Tanker/Users/Requester.hpp>
 #include <Tanker/Users/UserAccessor.hpp>
+#include <Tanker/Users/UserStore.hpp>
 #include <Tanker/Verification/Requester.hpp>
 
 #include <tconcurrent/coroutine.hpp>
 
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -49,6 +52,7 @@ public:
 
     std::unique_ptr<DataStore::DataStore> db;
     Users::LocalUserStore localUserStore;
+    Users::UserStore userStore;
     Groups::Store groupStore;
     ResourceKeys::Store resourceKeyStore;
     ProvisionalUserKeysStore provisionalUserKeysStore;
@@ -60,7 +64,8 @@ public:
     Accessors(Storage& storage,
               Requesters* requesters,
               Users::LocalUserAccessor plocalUserAccessor,
-              TransparentSession::SessionShareCallback shareCallback);
+              TransparentSession::SessionShareCallback shareCallback,
+              std::optional<std::chrono::seconds> userCacheMaxAge);
     Users::LocalUserAccessor localUserAccessor;
     mutable Users::UserAccessor userAccessor;
     ProvisionalUsers::Accessor provisionalUsersAccessor;
@@ -80,9 +85,9 @@ public:
   Requesters const& requesters() const;
   Requesters& requesters();
 
-  void openStorage(Identity::SecretPermanentIdentity const& identity,
-                   std::string const& dataPath,
-                   std::string const& cachePath);
+  tc::cotask<void> openStorage(Identity::SecretPermanentIdentity const& identity,
+                               std::string const& dataPath,
+                               std::string const& cachePath);
   Storage const& storage() const;
   Storage& storage();
 
@@ -100,6 +105,9 @@ public:
 
   tc::cotask<std::optional<DeviceKeys>> findDeviceKeys() const;
 
+  void setUserCacheMaxAge(std::optional<std::chrono::seconds> maxAge);
+  void setResourceKeyWriteBehind(std::optional<ResourceKeys::WriteBehindOptions> options);
+
   tc::cotask<void> finalizeOpening();
   tc::cotask<void> finalizeCreation(Trustchain::DeviceId const& deviceId, DeviceKeys const& deviceKeys);
 
@@ -111,6 +119,8 @@ private:
   std::unique_ptr<Accessors> _accessors;
   std::optional<Identity::SecretPermanentIdentity> _identity;
   Status _status;
+  std::optional<std::chrono::seconds> _userCacheMaxAge;
+  std::optional<ResourceKeys::WriteBehindOptions> _resourceKeyWriteBehind;
 
   tc::cotask<void> transparentSessionShareImpl(TransparentSession::AccessorResult const& session,
                                                std::vector<SPublicIdentity> const& users,
@@ -16,6 +16,8 @@
 
 #include <gsl/gsl-lite.hpp>
 
+#include <cstddef>
+#include <functional>
 #include <vector>
 
 namespace Tanker::Users
@@ -26,6 +28,8 @@ class IRequester;
 
 namespace Tanker
 {
+class WorkerPool;
+
 namespace Groups
 {
 class IAccessor;
@@ -77,11 +81,14 @@ tc::cotask<KeyRecipients> generateRecipientList(Trustchain::TrustchainId const&
                                                 std::vector<SPublicIdentity> publicIdentities,
                                                 std::vector<SGroupId> groupIds);
 
-ShareActions generateShareBlocks(Trustchain::TrustchainId const& trustchainId,
-                                 Trustchain::DeviceId const& deviceId,
-                                 Crypto::PrivateSignatureKey const& signatureKey,
-                                 ResourceKeys::KeysResult const& resourceKeys,
-                                 KeyRecipients const& keyRecipients);
+// The blocks are sealed and signed on the worker pool when there is one, they
+// are returned in the same order either way
+tc::cotask<ShareActions> generateShareBlocks(Trustchain::TrustchainId const& trustchainId,
+                                             Trustchain::DeviceId const& deviceId,
+                                             Crypto::PrivateSignatureKey const& signatureKey,
+                                             ResourceKeys::KeysResult const& resourceKeys,
+                                             KeyRecipients const& keyRecipients,
+                                             WorkerPool* workerPool = nullptr);
 
 tc::cotask<void> share(Users::IUserAccessor& userAccessor,
                        Groups::IAccessor& groupAccessor,
@@ -91,7 +98,27 @@ tc::cotask<void> share(Users::IUserAccessor& userAccessor,
                        Users::IRequester& requester,
                        ResourceKeys::KeysResult const& resourceKeys,
                        std::vector<SPublicIdentity> const& publicIdentities,
-                       std::vector<SGroupId> const& groupIds);
+                       std::vector<SGroupId> const& groupIds,
+                       WorkerPool* workerPool = nullptr);
+
+// Called after each uploaded batch, with the number of resource keys shared
+// with all the recipients so far
+using ProgressHandler = std::function<void(std::size_t sharedKeys, std::size_t totalKeys)>;
 
+// Same as share(), for any number of resource keys and recipients: the
+// resource x recipient pairs are split in batches that fit in the server's
+// share limit, and uploaded one after the other while the blocks of the next
+// batch are generated
+tc::cotask<void> shareInBatches(Users::IUserAccessor& userAccessor,
+                                Groups::IAccessor& groupAccessor,
+                                Trustchain::TrustchainId const& trustchainId,
+                                Trustchain::DeviceId const& deviceId,
+                                Crypto::PrivateSignatureKey const& signatureKey,
+                                Users::IRequester& requester,
+                                ResourceKeys::KeysResult const& resourceKeys,
+                                std::vector<SPublicIdentity> const& publicIdentities,
+                                std::vector<SGroupId> const& groupIds,
+                                ProgressHandler const& onProgress = nullptr,
+                                WorkerPool* workerPool = nullptr);
 }
 }
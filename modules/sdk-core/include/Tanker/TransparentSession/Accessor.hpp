@@ -2,6 +2,7 @@
 
 #include <Tanker/Crypto/SimpleResourceId.hpp>
 #include <Tanker/Crypto/SymmetricKey.hpp>
+#include <Tanker/LruCache.hpp>
 #include <Tanker/ResourceKeys/KeysResult.hpp>
 #include <Tanker/TaskCoalescer.hpp>
 #include <Tanker/TransparentSession/Store.hpp>
@@ -28,7 +29,10 @@ using SessionShareCallback = std::function<tc::cotask<void>(
 class Accessor
 {
 public:
-  Accessor(Store* store, SessionShareCallback shareCallback);
+  static constexpr std::size_t DefaultCacheCapacity = 256;
+  static constexpr std::uint64_t SessionExpirationSeconds = 12 * 3600;
+
+  Accessor(Store* store, SessionShareCallback shareCallback, std::size_t cacheCapacity = DefaultCacheCapacity);
   Accessor() = delete;
   Accessor(Accessor const&) = delete;
   Accessor(Accessor&&) = delete;
@@ -39,9 +43,13 @@ public:
   tc::cotask<AccessorResult> getOrCreateTransparentSession(std::vector<SPublicIdentity> const& users,
                                                            std::vector<SGroupId> const& groups);
 
+  // Lookups of the in-memory session cache, misses go to the Store
+  CacheStats const& cacheStats() const;
+
 private:
   SessionShareCallback _shareCallback;
   Store* _store;
   Tanker::TaskCoalescer<AccessorResult, Crypto::Hash, &AccessorResult::recipientsHash> _cache;
+  LruCache<Crypto::Hash, TransparentSessionData> _sessions;
 };
 }
@@ -46,6 +46,8 @@ public:
                        std::uint64_t creationTimestamp = secondsSinceEpoch());
   tc::cotask<std::optional<TransparentSessionData>> get(Crypto::Hash const& recipientsHash) const;
 
+  tc::cotask<DataStore::CacheUsage> cacheUsage() const;
+
 private:
   Crypto::SymmetricKey _userSecret;
   DataStore::DataStore* _db;
@@ -6,12 +6,14 @@
 #include <Tanker/Trustchain/UserId.hpp>
 #include <Tanker/Users/IRequester.hpp>
 #include <Tanker/Users/IUserAccessor.hpp>
+#include <Tanker/Users/UserStore.hpp>
 
 #include <gsl/gsl-lite.hpp>
 #include <tconcurrent/coroutine.hpp>
 
 #include <boost/container/flat_map.hpp>
 
+#include <chrono>
 #include <optional>
 #include <vector>
 
@@ -23,7 +25,13 @@ using DevicesMap = boost::container::flat_map<Trustchain::DeviceId, Device>;
 class UserAccessor : public IUserAccessor
 {
 public:
-  UserAccessor(Trustchain::Context trustchainCtx, IRequester* requester);
+  // Verified users are kept in userStore when given. Users fetched less than
+  // cacheMaxAge ago are then used without asking the server, the others are
+  // fetched again and only their new blocks are verified.
+  UserAccessor(Trustchain::Context trustchainCtx,
+               IRequester* requester,
+               UserStore* userStore = nullptr,
+               std::optional<std::chrono::seconds> cacheMaxAge = std::nullopt);
 
   UserAccessor() = delete;
   UserAccessor(UserAccessor const&) = delete;
@@ -36,6 +44,8 @@ public:
   tc::cotask<std::vector<ProvisionalUsers::PublicUser>> pullProvisional(
       std::vector<Identity::PublicProvisionalIdentity> appProvisionalIdentities) override;
 
+  void setCacheMaxAge(std::optional<std::chrono::seconds> cacheMaxAge);
+
 private:
   auto fetch(gsl::span<Trustchain::UserId const> userIds) -> tc::cotask<UsersMap>;
   auto fetch(gsl::span<Trustchain::DeviceId const> deviceIds) -> tc::cotask<DevicesMap>;
@@ -48,5 +58,7 @@ private:
 private:
   Trustchain::Context _context;
   Users::IRequester* _requester;
+  UserStore* _userStore;
+  std::optional<std::chrono::seconds> _cacheMaxAge;
 };
 }
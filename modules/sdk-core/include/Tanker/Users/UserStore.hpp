@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Tanker/Crypto/Hash.hpp>
+#include <Tanker/Crypto/SymmetricKey.hpp>
+#include <Tanker/DataStore/Backend.hpp>
+#include <Tanker/Trustchain/DeviceId.hpp>
+#include <Tanker/Trustchain/UserId.hpp>
+#include <Tanker/Users/User.hpp>
+
+#include <boost/container/flat_map.hpp>
+#include <gsl/gsl-lite.hpp>
+#include <tconcurrent/coroutine.hpp>
+
+#include <cstdint>
+
+namespace Tanker::Users
+{
+// A user whose history has been verified up to lastBlockHash
+struct CachedUser
+{
+  User user;
+  Crypto::Hash lastBlockHash;
+  std::uint64_t fetchTimestamp;
+};
+
+bool operator==(CachedUser const& lhs, CachedUser const& rhs);
+bool operator!=(CachedUser const& lhs, CachedUser const& rhs);
+
+using CachedUsersMap = boost::container::flat_map<Trustchain::UserId, CachedUser>;
+
+class UserStore
+{
+public:
+  UserStore(UserStore const&) = delete;
+  UserStore(UserStore&&) = delete;
+  UserStore& operator=(UserStore const&) = delete;
+  UserStore& operator=(UserStore&&) = delete;
+
+  UserStore(Crypto::SymmetricKey const& userSecret, DataStore::DataStore* db);
+
+  tc::cotask<void> put(gsl::span<CachedUser const> users);
+
+  // Users that are not in the cache are omitted from the result
+  tc::cotask<CachedUsersMap> findByUserIds(gsl::span<Trustchain::UserId const> userIds) const;
+  tc::cotask<CachedUsersMap> findByDeviceIds(gsl::span<Trustchain::DeviceId const> deviceIds) const;
+
+  // Includes the index entries
+  tc::cotask<DataStore::CacheUsage> cacheUsage() const;
+
+private:
+  Crypto::SymmetricKey _userSecret;
+  DataStore::DataStore* _db;
+};
+}
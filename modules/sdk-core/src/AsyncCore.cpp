@@ -197,10 +197,12 @@ tc::future<void> AsyncCore::encrypt(gsl::span<uint8_t> encryptedData,
                                     std::vector<SPublicIdentity> const& publicIdentities,
                                     std::vector<SGroupId> const& groupIds,
                                     Core::ShareWithSelf shareWithSelf,
-                                    std::optional<uint32_t> paddingStep)
+                                    std::optional<uint32_t> paddingStep,
+                                    Encryptor::StreamOptions const& streamOptions)
 {
   return runResumable([=, this]() -> tc::cotask<void> {
-    TC_AWAIT(this->_core.encrypt(encryptedData, clearData, publicIdentities, groupIds, shareWithSelf, paddingStep));
+    TC_AWAIT(this->_core.encrypt(
+        encryptedData, clearData, publicIdentities, groupIds, shareWithSelf, paddingStep, streamOptions));
   });
 }
 
@@ -214,10 +216,12 @@ tc::future<std::vector<uint8_t>> AsyncCore::encrypt(gsl::span<uint8_t const> cle
                                                     std::vector<SPublicIdentity> const& publicIdentities,
                                                     std::vector<SGroupId> const& groupIds,
                                                     Core::ShareWithSelf shareWithSelf,
-                                                    std::optional<uint32_t> paddingStep)
+                                                    std::optional<uint32_t> paddingStep,
+                                                    Encryptor::StreamOptions const& streamOptions)
 {
   return runResumable([=, this]() -> tc::cotask<std::vector<uint8_t>> {
-    TC_RETURN(TC_AWAIT(_core.encrypt(clearData, publicIdentities, groupIds, shareWithSelf, paddingStep)));
+    TC_RETURN(
+        TC_AWAIT(_core.encrypt(clearData, publicIdentities, groupIds, shareWithSelf, paddingStep, streamOptions)));
   });
 }
 
@@ -239,6 +243,16 @@ tc::future<void> AsyncCore::share(std::vector<SResourceId> const& resourceId,
       [=, this]() -> tc::cotask<void> { TC_AWAIT(this->_core.share(resourceId, publicIdentities, groupIds)); });
 }
 
+tc::future<void> AsyncCore::bulkShare(std::vector<SResourceId> const& resourceIds,
+                                      std::vector<SPublicIdentity> const& publicIdentities,
+                                      std::vector<SGroupId> const& groupIds,
+                                      Share::ProgressHandler onProgress)
+{
+  return runResumable([=, this]() -> tc::cotask<void> {
+    TC_AWAIT(this->_core.bulkShare(resourceIds, publicIdentities, groupIds, onProgress));
+  });
+}
+
 tc::future<SGroupId> AsyncCore::createGroup(std::vector<SPublicIdentity> const& members)
 {
   return runResumable([=, this]() -> tc::cotask<SGroupId> { TC_RETURN(TC_AWAIT(this->_core.createGroup(members))); });
@@ -312,9 +326,11 @@ void AsyncCore::setLogHandler(Log::LogHandler handler)
       [handler](Log::Record const& record) { tc::dispatch_on_thread_context([&] { handler(record); }); });
 }
 
-uint64_t AsyncCore::encryptedSize(uint64_t clearSize, std::optional<uint32_t> paddingStep)
+uint64_t AsyncCore::encryptedSize(uint64_t clearSize,
+                                  std::optional<uint32_t> paddingStep,
+                                  Encryptor::StreamOptions const& streamOptions)
 {
-  return Encryptor::encryptedSize(clearSize, paddingStep);
+  return Encryptor::encryptedSize(clearSize, paddingStep, streamOptions);
 }
 
 expected<uint64_t> AsyncCore::decryptedSize(gsl::span<uint8_t const> encryptedData)
@@ -332,12 +348,13 @@ tc::future<std::tuple<Streams::InputSource, Crypto::ResourceId>> AsyncCore::make
     std::vector<SPublicIdentity> const& suserIds,
     std::vector<SGroupId> const& sgroupIds,
     Core::ShareWithSelf shareWithSelf,
-    std::optional<uint32_t> paddingStep)
+    std::optional<uint32_t> paddingStep,
+    Encryptor::StreamOptions const& streamOptions)
 {
   return runResumable(
       [=, this, cb = std::move(cb)]() -> tc::cotask<std::tuple<Streams::InputSource, Crypto::ResourceId>> {
-        TC_RETURN(
-            TC_AWAIT(this->_core.makeEncryptionStream(std::move(cb), suserIds, sgroupIds, shareWithSelf, paddingStep)));
+        TC_RETURN(TC_AWAIT(this->_core.makeEncryptionStream(
+            std::move(cb), suserIds, sgroupIds, shareWithSelf, paddingStep, streamOptions)));
       });
 }
 
@@ -349,6 +366,13 @@ tc::future<std::tuple<Streams::InputSource, Crypto::ResourceId>> AsyncCore::make
   });
 }
 
+tc::future<Streams::RangeDecryptor> AsyncCore::makeRangeDecryptor(Streams::PositionalInputSource cb)
+{
+  return runResumable([this, cb = std::move(cb)]() -> tc::cotask<Streams::RangeDecryptor> {
+    TC_RETURN(TC_AWAIT(this->_core.makeRangeDecryptor(cb)));
+  });
+}
+
 tc::future<EncryptionSession> AsyncCore::makeEncryptionSession(std::vector<SPublicIdentity> const& publicIdentities,
                                                                std::vector<SGroupId> const& groupIds,
                                                                Core::ShareWithSelf shareWithSelf,
@@ -363,10 +387,13 @@ tc::cotask<void> AsyncCore::handleDeviceUnrecoverable()
 {
   auto const lock = TC_AWAIT(_quickStopSemaphore.get_scope_lock());
 
-  nukeAndStop();
+  // The database is erased first, this coroutine can't await anymore once the
+  // running tasks are terminated
+  TC_AWAIT(_core.nukeDatabase());
+  terminateAndStop();
 }
 
-void AsyncCore::nukeAndStop()
+void AsyncCore::terminateAndStop()
 {
   // - This device has been deemed unusable, we need to stop so
   // that Session gets destroyed.
@@ -379,7 +406,6 @@ void AsyncCore::nukeAndStop()
   _taskCanceler.terminate();
   // We have asked for termination of all running tasks, including this one.
   // From now on, we must not TC_AWAIT or we will be canceled.
-  _core.nukeDatabase();
   _core.quickStop();
 }
 
@@ -397,4 +423,34 @@ tc::future<void> AsyncCore::setHttpSessionToken(std::string token)
 {
   return tc::async([this, tk = std::move(token)] { this->_core.setHttpSessionToken(std::move(tk)); });
 }
+
+tc::future<void> AsyncCore::setWorkerThreadCount(unsigned int threadCount)
+{
+  return tc::async([this, threadCount] { this->_core.setWorkerThreadCount(threadCount); });
+}
+
+tc::future<void> AsyncCore::setUserCacheMaxAge(std::optional<std::chrono::seconds> maxAge)
+{
+  return tc::async([this, maxAge] { this->_core.setUserCacheMaxAge(maxAge); });
+}
+
+tc::future<void> AsyncCore::setResourceKeyWriteBehind(std::optional<ResourceKeys::WriteBehindOptions> options)
+{
+  return tc::async([this, options] { this->_core.setResourceKeyWriteBehind(options); });
+}
+
+tc::future<void> AsyncCore::setHttpConcurrency(std::size_t concurrentRequestCount)
+{
+  return tc::async([this, concurrentRequestCount] { this->_core.setHttpConcurrency(concurrentRequestCount); });
+}
+
+tc::future<void> AsyncCore::setStreamReadAhead(Streams::ReadAheadOptions options)
+{
+  return tc::async([this, options] { this->_core.setStreamReadAhead(options); });
+}
+
+tc::future<CacheOccupancy> AsyncCore::cacheOccupancy()
+{
+  return runResumable([this]() -> tc::cotask<CacheOccupancy> { TC_RETURN(TC_AWAIT(this->_core.cacheOccupancy())); });
+}
 }
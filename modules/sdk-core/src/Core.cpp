@@ -21,13 +21,17 @@
 #include <Tanker/Log/Log.hpp>
 #include <Tanker/Oidc/Nonce.hpp>
 #include <Tanker/ProvisionalUsers/Requester.hpp>
+#include <Tanker/Serialization/Serialization.hpp>
 #include <Tanker/Session.hpp>
 #include <Tanker/Share.hpp>
 #include <Tanker/Streams/DecryptionStreamV11.hpp>
 #include <Tanker/Streams/DecryptionStreamV4.hpp>
 #include <Tanker/Streams/DecryptionStreamV8.hpp>
 #include <Tanker/Streams/EncryptionStreamV11.hpp>
+#include <Tanker/Streams/Header.hpp>
 #include <Tanker/Streams/PeekableInputSource.hpp>
+#include <Tanker/Streams/ReadAheadInputSource.hpp>
+#include <Tanker/Streams/TransparentSessionHeader.hpp>
 #include <Tanker/Tracer/ScopeTimer.hpp>
 #include <Tanker/Trustchain/Actions/SessionCertificate.hpp>
 #include <Tanker/Types/Overloaded.hpp>
@@ -74,14 +78,16 @@ namespace
 std::unique_ptr<Network::HttpClient> createHttpClient(std::string_view url,
                                                       std::string instanceId,
                                                       SdkInfo const& info,
-                                                      Network::Backend* backend)
+                                                      Network::Backend* backend,
+                                                      std::size_t concurrentRequestCount)
 {
 
   auto client = std::make_unique<Network::HttpClient>(
       fmt::format("{url}/v2/apps/{appId:#S}/", fmt::arg("url", url), fmt::arg("appId", info.trustchainId)),
       std::move(instanceId),
       backend,
-      info);
+      info,
+      concurrentRequestCount);
   return client;
 }
 
@@ -186,6 +192,57 @@ tc::cotask<std::vector<uint8_t>> decryptVerificationKeyWithUserCreds(
       },
       encVerifKey)));
 }
+
+// Stream formats use 1MiB chunks by default, reading them ahead with the same
+// granularity keeps each read a whole chunk
+Streams::InputSource readAhead(
+    Streams::InputSource source,
+    Streams::ReadAheadOptions const& options,
+    std::uint32_t chunkSize = Streams::TransparentSessionHeader::defaultEncryptedChunkSize)
+{
+  return Streams::readAhead(std::move(source), chunkSize, options.depth);
+}
+
+Streams::InputSource processAhead(
+    Streams::InputSource stream,
+    Streams::ReadAheadOptions const& options,
+    std::uint32_t chunkSize = Streams::TransparentSessionHeader::defaultEncryptedChunkSize)
+{
+  if (!options.processing)
+    return stream;
+  return readAhead(std::move(stream), options, chunkSize);
+}
+
+// The chunk size of a stream, so that it is read ahead in whole chunks. An
+// invalid header is reported by the decryption stream, not here.
+template <typename HeaderType>
+std::uint32_t parseEncryptedChunkSize(gsl::span<std::uint8_t const> serializedHeader)
+{
+  try
+  {
+    if (serializedHeader.size() == HeaderType::serializedSize)
+      return Serialization::deserialize<HeaderType>(serializedHeader).encryptedChunkSize();
+  }
+  catch (Errors::Exception const&)
+  {
+  }
+  return HeaderType::defaultEncryptedChunkSize;
+}
+
+tc::cotask<std::uint32_t> peekEncryptedChunkSize(Streams::PeekableInputSource& source, std::uint8_t version)
+{
+  switch (version)
+  {
+  case 4:
+  case 8:
+    TC_RETURN(parseEncryptedChunkSize<Streams::Header>(TC_AWAIT(source.peek(Streams::Header::serializedSize))));
+  case 11:
+    TC_RETURN(parseEncryptedChunkSize<Streams::TransparentSessionHeader>(
+        TC_AWAIT(source.peek(Streams::TransparentSessionHeader::serializedSize))));
+  default:
+    TC_RETURN(Streams::TransparentSessionHeader::defaultEncryptedChunkSize);
+  }
+}
 }
 
 Core::~Core()
@@ -221,8 +278,10 @@ Core::Core(std::string url,
                                          nullptr
 #endif
                           ),
-    _session(std::make_shared<Session>(createHttpClient(_url, _instanceId, _info, _networkBackend.get()),
-                                       _datastoreBackend.get())),
+    // _httpConcurrency is declared after _session, it is not initialized yet
+    _session(std::make_shared<Session>(
+        createHttpClient(_url, _instanceId, _info, _networkBackend.get(), Network::DefaultConcurrentRequestCount),
+        _datastoreBackend.get())),
     _oidcManager(std::make_shared<Oidc::NonceManager>())
 {
   TDEBUG("Creating core {}", static_cast<void*>(this));
@@ -255,8 +314,10 @@ Status Core::status() const
 
 void Core::reset()
 {
-  _session = std::make_shared<Session>(createHttpClient(_url, _instanceId, _info, _networkBackend.get()),
-                                       _datastoreBackend.get());
+  _session = std::make_shared<Session>(
+      createHttpClient(_url, _instanceId, _info, _networkBackend.get(), _httpConcurrency), _datastoreBackend.get());
+  _session->setUserCacheMaxAge(_userCacheMaxAge);
+  _session->setResourceKeyWriteBehind(_resourceKeyWriteBehind);
 }
 
 template <typename F>
@@ -606,9 +667,11 @@ tc::cotask<void> Core::encrypt(gsl::span<uint8_t> encryptedData,
                                std::vector<SPublicIdentity> const& spublicIdentities,
                                std::vector<SGroupId> const& sgroupIds,
                                ShareWithSelf shareWithSelf,
-                               std::optional<uint32_t> paddingStep)
+                               std::optional<uint32_t> paddingStep,
+                               Encryptor::StreamOptions const& streamOptions)
 {
   assertStatus(Status::Ready, "encrypt");
+  Encryptor::checkStreamOptions(streamOptions);
 
   auto spublicIdentitiesWithUs = spublicIdentities;
   if (shareWithSelf == ShareWithSelf::Yes)
@@ -619,18 +682,22 @@ tc::cotask<void> Core::encrypt(gsl::span<uint8_t> encryptedData,
 
   auto const session = TC_AWAIT(_session->accessors().transparentSessionAccessor.getOrCreateTransparentSession(
       spublicIdentitiesWithUs, sgroupIds));
-  TC_AWAIT(Encryptor::encrypt(encryptedData, clearData, paddingStep, session.id, session.key));
+  auto const workerPool = _workerPool;
+  TC_AWAIT(Encryptor::encrypt(
+      encryptedData, clearData, paddingStep, session.id, session.key, workerPool.get(), streamOptions));
 }
 
 tc::cotask<std::vector<uint8_t>> Core::encrypt(gsl::span<uint8_t const> clearData,
                                                std::vector<SPublicIdentity> const& spublicIdentities,
                                                std::vector<SGroupId> const& sgroupIds,
                                                ShareWithSelf shareWithSelf,
-                                               std::optional<uint32_t> paddingStep)
+                                               std::optional<uint32_t> paddingStep,
+                                               Encryptor::StreamOptions const& streamOptions)
 {
   assertStatus(Status::Ready, "encrypt");
-  std::vector<uint8_t> encryptedData(Encryptor::encryptedSize(clearData.size(), paddingStep));
-  TC_AWAIT(encrypt(encryptedData, clearData, spublicIdentities, sgroupIds, shareWithSelf, paddingStep));
+  Encryptor::checkStreamOptions(streamOptions);
+  std::vector<uint8_t> encryptedData(Encryptor::encryptedSize(clearData.size(), paddingStep, streamOptions));
+  TC_AWAIT(encrypt(encryptedData, clearData, spublicIdentities, sgroupIds, shareWithSelf, paddingStep, streamOptions));
   TC_RETURN(std::move(encryptedData));
 }
 
@@ -640,7 +707,8 @@ tc::cotask<uint64_t> Core::decrypt(gsl::span<uint8_t> decryptedData, gsl::span<u
   auto finder = [this](Crypto::SimpleResourceId const& resourceId) -> Encryptor::ResourceKeyFinder::result_type {
     TC_RETURN(TC_AWAIT(this->tryGetResourceKey(resourceId)));
   };
-  TC_RETURN(TC_AWAIT(Encryptor::decrypt(decryptedData, finder, encryptedData)));
+  auto const workerPool = _workerPool;
+  TC_RETURN(TC_AWAIT(Encryptor::decrypt(decryptedData, finder, encryptedData, workerPool.get())));
 }
 
 tc::cotask<std::vector<uint8_t>> Core::decrypt(gsl::span<uint8_t const> encryptedData)
@@ -653,14 +721,8 @@ tc::cotask<std::vector<uint8_t>> Core::decrypt(gsl::span<uint8_t const> encrypte
   TC_RETURN(std::move(decryptedData));
 }
 
-tc::cotask<void> Core::share(std::vector<SResourceId> const& sresourceIds,
-                             std::vector<SPublicIdentity> const& spublicIdentities,
-                             std::vector<SGroupId> const& sgroupIds)
+tc::cotask<ResourceKeys::KeysResult> Core::findKeysToShare(std::vector<SResourceId> const& sresourceIds)
 {
-  assertStatus(Status::Ready, "share");
-  if (sresourceIds.empty() || (spublicIdentities.empty() && sgroupIds.empty()))
-    TC_RETURN();
-
   auto const resourceIds = sresourceIds | ranges::views::transform([](auto&& resourceId) {
                              return decodeArgument<mgs::base64, Crypto::ResourceId>(resourceId, "resource id");
                            }) |
@@ -676,13 +738,28 @@ tc::cotask<void> Core::share(std::vector<SResourceId> const& sresourceIds,
     else if (auto const rid = boost::variant2::get_if<Crypto::CompositeResourceId>(&ridVariant))
       sessionIds.push_back(rid->sessionId());
   }
-  auto const localUser = _session->accessors().localUserAccessor.get();
-  std::vector<ResourceKeys::KeyResult> resourceKeys =
-      TC_AWAIT(_session->accessors().resourceKeyAccessor.findKeys(simpleResourceIds));
+
+  // Look both kinds of keys up at once, so that the store is only queried once
+  auto lookedUpIds = simpleResourceIds;
+  lookedUpIds.insert(lookedUpIds.end(), sessionIds.begin(), sessionIds.end());
+  auto const keysMap = TC_AWAIT(_session->accessors().resourceKeyAccessor.tryFindKeys(lookedUpIds));
+
+  std::vector<ResourceKeys::KeyResult> resourceKeys;
+  std::vector<Crypto::SimpleResourceId> missingSimpleIds;
+  for (auto const& resourceId : simpleResourceIds)
+  {
+    if (auto const key = keysMap.find(resourceId); key != keysMap.end())
+      resourceKeys.push_back({key->second, resourceId});
+    else
+      missingSimpleIds.push_back(resourceId);
+  }
+  if (!missingSimpleIds.empty())
+    throw formatEx(
+        Errors::Errc::InvalidArgument, "can't find keys for resource IDs: {:s}", fmt::join(missingSimpleIds, ", "));
 
   // If we fail to find the session key for some composites resource IDs, we may
   // still have access to the individual resource key
-  auto sessionKeysMap = TC_AWAIT(_session->accessors().resourceKeyAccessor.tryFindKeys(sessionIds));
+  auto const& sessionKeysMap = keysMap;
   std::vector<Crypto::SimpleResourceId> resourcesWithoutSession;
   for (auto const& ridVariant : resourceIds)
   {
@@ -734,7 +811,20 @@ tc::cotask<void> Core::share(std::vector<SResourceId> const& sresourceIds,
       }
     }
   }
+  TC_RETURN(resourceKeys);
+}
 
+tc::cotask<void> Core::share(std::vector<SResourceId> const& sresourceIds,
+                             std::vector<SPublicIdentity> const& spublicIdentities,
+                             std::vector<SGroupId> const& sgroupIds)
+{
+  assertStatus(Status::Ready, "share");
+  if (sresourceIds.empty() || (spublicIdentities.empty() && sgroupIds.empty()))
+    TC_RETURN();
+
+  auto const resourceKeys = TC_AWAIT(findKeysToShare(sresourceIds));
+  auto const localUser = _session->accessors().localUserAccessor.get();
+  auto const workerPool = _workerPool;
   TC_AWAIT(Share::share(_session->accessors().userAccessor,
                         _session->accessors().groupAccessor,
                         _session->trustchainId(),
@@ -743,19 +833,47 @@ tc::cotask<void> Core::share(std::vector<SResourceId> const& sresourceIds,
                         _session->requesters(),
                         resourceKeys,
                         spublicIdentities,
-                        sgroupIds));
+                        sgroupIds,
+                        workerPool.get()));
+}
+
+tc::cotask<void> Core::bulkShare(std::vector<SResourceId> const& sresourceIds,
+                                 std::vector<SPublicIdentity> const& spublicIdentities,
+                                 std::vector<SGroupId> const& sgroupIds,
+                                 Share::ProgressHandler onProgress)
+{
+  assertStatus(Status::Ready, "bulkShare");
+  if (sresourceIds.empty() || (spublicIdentities.empty() && sgroupIds.empty()))
+    TC_RETURN();
+
+  auto const resourceKeys = TC_AWAIT(findKeysToShare(sresourceIds));
+  auto const localUser = _session->accessors().localUserAccessor.get();
+  auto const workerPool = _workerPool;
+  TC_AWAIT(Share::shareInBatches(_session->accessors().userAccessor,
+                                 _session->accessors().groupAccessor,
+                                 _session->trustchainId(),
+                                 localUser.deviceId(),
+                                 localUser.deviceKeys().signatureKeyPair.privateKey,
+                                 _session->requesters(),
+                                 resourceKeys,
+                                 spublicIdentities,
+                                 sgroupIds,
+                                 onProgress,
+                                 workerPool.get()));
 }
 
 tc::cotask<SGroupId> Core::createGroup(std::vector<SPublicIdentity> const& spublicIdentities)
 {
   assertStatus(Status::Ready, "createGroup");
   auto const& localUser = _session->accessors().localUserAccessor.get();
+  auto const workerPool = _workerPool;
   auto const groupId = TC_AWAIT(Groups::Manager::create(_session->accessors().userAccessor,
                                                         _session->requesters(),
                                                         spublicIdentities,
                                                         _session->trustchainId(),
                                                         localUser.deviceId(),
-                                                        localUser.deviceKeys().signatureKeyPair.privateKey));
+                                                        localUser.deviceKeys().signatureKeyPair.privateKey,
+                                                        workerPool.get()));
   TC_RETURN(groupId);
 }
 
@@ -767,6 +885,7 @@ tc::cotask<void> Core::updateGroupMembers(SGroupId const& groupIdString,
   auto const groupId = decodeArgument<mgs::base64, Trustchain::GroupId>(groupIdString, "group id");
 
   auto const& localUser = _session->accessors().localUserAccessor.get();
+  auto const workerPool = _workerPool;
   TC_AWAIT(Groups::Manager::updateMembers(_session->accessors().userAccessor,
                                           _session->requesters(),
                                           _session->accessors().groupAccessor,
@@ -775,7 +894,8 @@ tc::cotask<void> Core::updateGroupMembers(SGroupId const& groupIdString,
                                           spublicIdentitiesToRemove,
                                           _session->trustchainId(),
                                           localUser.deviceId(),
-                                          localUser.deviceKeys().signatureKeyPair.privateKey));
+                                          localUser.deviceKeys().signatureKeyPair.privateKey,
+                                          workerPool.get()));
 }
 
 tc::cotask<std::optional<std::string>> Core::setVerificationMethod(Verification::Verification const& method,
@@ -961,10 +1081,10 @@ tc::cotask<OidcAuthorizationCode> Core::authenticateWithIdp(std::string const& p
   TC_RETURN(TC_AWAIT(_session->requesters().oidcSignIn(_session->userId(), providerId, cookie)));
 }
 
-void Core::nukeDatabase()
+tc::cotask<void> Core::nukeDatabase()
 {
   if (_session)
-    _session->storage().db->nuke();
+    TC_AWAIT(_session->storage().db->nuke());
 }
 
 Crypto::ResourceId Core::getResourceId(gsl::span<uint8_t const> encryptedData)
@@ -982,6 +1102,55 @@ void Core::setHttpSessionToken(std::string_view token)
   this->_session->httpClient().setAccessToken(token);
 }
 
+void Core::setUserCacheMaxAge(std::optional<std::chrono::seconds> maxAge)
+{
+  _userCacheMaxAge = maxAge;
+  _session->setUserCacheMaxAge(maxAge);
+}
+
+void Core::setResourceKeyWriteBehind(std::optional<ResourceKeys::WriteBehindOptions> options)
+{
+  _resourceKeyWriteBehind = options;
+  _session->setResourceKeyWriteBehind(options);
+}
+
+void Core::setHttpConcurrency(std::size_t concurrentRequestCount)
+{
+  assertStatus(Status::Stopped, "setHttpConcurrency");
+  if (concurrentRequestCount == 0)
+    throw Errors::formatEx(Errors::Errc::InvalidArgument, "the HTTP concurrency must be at least 1");
+  _httpConcurrency = concurrentRequestCount;
+  // The HttpClient belongs to the session, a stopped one can be replaced
+  reset();
+}
+
+tc::cotask<CacheOccupancy> Core::cacheOccupancy()
+{
+  assertStatus(Status::Ready, "cacheOccupancy");
+  auto& storage = _session->storage();
+  CacheOccupancy occupancy;
+  occupancy.resourceKeys = TC_AWAIT(storage.resourceKeyStore.cacheUsage());
+  occupancy.groups = TC_AWAIT(storage.groupStore.cacheUsage());
+  occupancy.users = TC_AWAIT(storage.userStore.cacheUsage());
+  occupancy.provisionalUserKeys = TC_AWAIT(storage.provisionalUserKeysStore.cacheUsage());
+  occupancy.transparentSessions = TC_AWAIT(storage.transparentSessionStore.cacheUsage());
+  TC_RETURN(occupancy);
+}
+
+void Core::setStreamReadAhead(Streams::ReadAheadOptions options)
+{
+  _streamReadAhead = options;
+}
+
+void Core::setWorkerThreadCount(unsigned int threadCount)
+{
+  // Operations in progress keep their own reference to the previous pool
+  if (threadCount <= 1)
+    _workerPool.reset();
+  else if (!_workerPool || _workerPool->threadCount() != threadCount)
+    _workerPool = std::make_shared<WorkerPool>(threadCount);
+}
+
 SdkInfo const& Core::sdkInfo()
 {
   return this->_info;
@@ -992,9 +1161,13 @@ tc::cotask<std::tuple<Streams::InputSource, Crypto::ResourceId>> Core::makeEncry
     std::vector<SPublicIdentity> const& spublicIdentities,
     std::vector<SGroupId> const& sgroupIds,
     ShareWithSelf shareWithSelf,
-    std::optional<uint32_t> paddingStep)
+    std::optional<uint32_t> paddingStep,
+    Encryptor::StreamOptions const& streamOptions)
 {
   assertStatus(Status::Ready, "makeEncryptionStream");
+  Encryptor::checkStreamOptions(streamOptions);
+  if (streamOptions.aes256Gcm)
+    throw Errors::formatEx(Errors::Errc::InvalidArgument, "AES-256-GCM is not supported by encryption streams");
   auto spublicIdentitiesWithUs = spublicIdentities;
   if (shareWithSelf == ShareWithSelf::Yes)
     spublicIdentitiesWithUs.emplace_back(
@@ -1005,9 +1178,13 @@ tc::cotask<std::tuple<Streams::InputSource, Crypto::ResourceId>> Core::makeEncry
   auto const session = TC_AWAIT(_session->accessors().transparentSessionAccessor.getOrCreateTransparentSession(
       spublicIdentitiesWithUs, sgroupIds));
 
-  Streams::EncryptionStreamV11 encryptor(std::move(cb), session.id, session.key, paddingStep);
+  // The stream threshold does not apply here, streams always use the chunked
+  // format
+  auto const chunkSize = streamOptions.encryptedChunkSize;
+  Streams::EncryptionStreamV11 encryptor(
+      readAhead(std::move(cb), _streamReadAhead, chunkSize), session.id, session.key, paddingStep, chunkSize);
   auto resourceId = encryptor.resourceId();
-  Streams::InputSource encryptorStream = std::move(encryptor);
+  auto encryptorStream = processAhead(std::move(encryptor), _streamReadAhead, chunkSize);
 
   TC_RETURN(std::make_tuple(std::move(encryptorStream), resourceId));
 }
@@ -1030,32 +1207,44 @@ tc::cotask<Crypto::SymmetricKey> Core::getResourceKey(Crypto::SimpleResourceId c
 tc::cotask<std::tuple<Streams::InputSource, Crypto::ResourceId>> Core::makeDecryptionStream(Streams::InputSource cb)
 {
   assertStatus(Status::Ready, "makeDecryptionStream");
+  // The header is peeked before the read-ahead, which then reads whole chunks
   auto peekableSource = Streams::PeekableInputSource(std::move(cb));
-  auto const version = TC_AWAIT(peekableSource.peek(1));
-  if (version.empty())
+  auto const peekedVersion = TC_AWAIT(peekableSource.peek(1));
+  if (peekedVersion.empty())
     throw formatEx(Errc::InvalidArgument, "empty stream");
+  auto const version = peekedVersion[0];
+  auto const chunkSize = TC_AWAIT(peekEncryptedChunkSize(peekableSource, version));
+  auto source = readAhead(std::move(peekableSource), _streamReadAhead, chunkSize);
 
   auto resourceKeyFinder =
       [this](Crypto::SimpleResourceId const& resourceId) -> tc::cotask<std::optional<Crypto::SymmetricKey>> {
     TC_RETURN(TC_AWAIT(this->tryGetResourceKey(resourceId)));
   };
-  switch (version[0])
+  switch (version)
   {
   case 4: {
-    auto streamDecryptor = TC_AWAIT(Streams::DecryptionStreamV4::create(std::move(peekableSource), resourceKeyFinder));
+    auto streamDecryptor = TC_AWAIT(Streams::DecryptionStreamV4::create(std::move(source), resourceKeyFinder));
     auto const resourceId = streamDecryptor.resourceId();
-    TC_RETURN(std::make_tuple(std::move(streamDecryptor), resourceId));
+    auto const encryptedChunkSize = streamDecryptor.encryptedChunkSize();
+    TC_RETURN(std::make_tuple(processAhead(std::move(streamDecryptor), _streamReadAhead, encryptedChunkSize),
+                              resourceId));
   }
   case 8: {
-    auto streamDecryptor = TC_AWAIT(Streams::DecryptionStreamV8::create(std::move(peekableSource), resourceKeyFinder));
-    TC_RETURN(std::make_tuple(std::move(streamDecryptor), streamDecryptor.resourceId()));
+    auto streamDecryptor = TC_AWAIT(Streams::DecryptionStreamV8::create(std::move(source), resourceKeyFinder));
+    auto const resourceId = streamDecryptor.resourceId();
+    auto const encryptedChunkSize = streamDecryptor.encryptedChunkSize();
+    TC_RETURN(std::make_tuple(processAhead(std::move(streamDecryptor), _streamReadAhead, encryptedChunkSize),
+                              resourceId));
   }
   case 11: {
-    auto streamDecryptor = TC_AWAIT(Streams::DecryptionStreamV11::create(std::move(peekableSource), resourceKeyFinder));
-    TC_RETURN(std::make_tuple(std::move(streamDecryptor), streamDecryptor.resourceId()));
+    auto streamDecryptor = TC_AWAIT(Streams::DecryptionStreamV11::create(std::move(source), resourceKeyFinder));
+    auto const resourceId = streamDecryptor.resourceId();
+    auto const encryptedChunkSize = streamDecryptor.encryptedChunkSize();
+    TC_RETURN(std::make_tuple(processAhead(std::move(streamDecryptor), _streamReadAhead, encryptedChunkSize),
+                              resourceId));
   }
   default: {
-    auto encryptedData = TC_AWAIT(Streams::readAllStream(std::move(peekableSource)));
+    auto encryptedData = TC_AWAIT(Streams::readAllStream(std::move(source)));
     auto const resourceId = Encryptor::extractResourceId(encryptedData);
     TC_RETURN(std::make_tuple(Streams::bufferToInputSource(TC_AWAIT(decrypt(encryptedData))), resourceId));
   }
@@ -1063,6 +1252,16 @@ tc::cotask<std::tuple<Streams::InputSource, Crypto::ResourceId>> Core::makeDecry
   throw AssertionError("makeDecryptionStream: unreachable code");
 }
 
+tc::cotask<Streams::RangeDecryptor> Core::makeRangeDecryptor(Streams::PositionalInputSource cb)
+{
+  assertStatus(Status::Ready, "makeRangeDecryptor");
+  auto resourceKeyFinder =
+      [this](Crypto::SimpleResourceId const& resourceId) -> tc::cotask<std::optional<Crypto::SymmetricKey>> {
+    TC_RETURN(TC_AWAIT(this->tryGetResourceKey(resourceId)));
+  };
+  TC_RETURN(TC_AWAIT(Streams::RangeDecryptor::create(std::move(cb), resourceKeyFinder)));
+}
+
 tc::cotask<EncryptionSession> Core::makeEncryptionSession(std::vector<SPublicIdentity> const& spublicIdentities,
                                                           std::vector<SGroupId> const& sgroupIds,
                                                           ShareWithSelf shareWithSelf,
@@ -1083,6 +1282,7 @@ tc::cotask<EncryptionSession> Core::makeEncryptionSession(std::vector<SPublicIde
   }
 
   auto const& localUser = _session->accessors().localUserAccessor.get();
+  auto const workerPool = _workerPool;
   TC_AWAIT(Share::share(_session->accessors().userAccessor,
                         _session->accessors().groupAccessor,
                         _session->trustchainId(),
@@ -1091,7 +1291,8 @@ tc::cotask<EncryptionSession> Core::makeEncryptionSession(std::vector<SPublicIde
                         _session->requesters(),
                         {{sess.sessionKey(), sess.resourceId()}},
                         spublicIdentitiesWithUs,
-                        sgroupIds));
+                        sgroupIds,
+                        workerPool.get()));
   TC_RETURN(sess);
 }
 
@@ -0,0 +1,287 @@
+#include <Tanker/DataStore/Memory/Backend.hpp>
+
+#include <Tanker/DataStore/Errors/Errc.hpp>
+#include <Tanker/DataStore/Utils.hpp>
+#include <Tanker/Errors/Errc.hpp>
+#include <Tanker/Errors/Exception.hpp>
+
+#include <algorithm>
+#include <list>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Tanker::DataStore
+{
+namespace
+{
+constexpr std::size_t ArenaBlockSize = 64 * 1024;
+
+std::string_view asStringView(gsl::span<uint8_t const> bytes)
+{
+  return {reinterpret_cast<char const*>(bytes.data()), bytes.size()};
+}
+
+gsl::span<uint8_t const> asBytes(std::string_view str)
+{
+  return {reinterpret_cast<uint8_t const*>(str.data()), str.size()};
+}
+
+// Bump allocator for the keys and values, so that a put does not allocate once
+// per buffer. Replaced and evicted entries leave holes, which are reclaimed by
+// copying the live entries to a new arena.
+class Arena
+{
+public:
+  gsl::span<uint8_t const> copy(gsl::span<uint8_t const> bytes)
+  {
+    auto const dest = allocate(bytes.size());
+    std::copy(bytes.begin(), bytes.end(), dest);
+    return {dest, bytes.size()};
+  }
+
+  std::size_t capacity() const
+  {
+    return _capacity;
+  }
+
+private:
+  std::vector<std::unique_ptr<uint8_t[]>> _blocks;
+  std::vector<std::unique_ptr<uint8_t[]>> _bigBuffers;
+  std::size_t _blockUsed = 0;
+  std::size_t _capacity = 0;
+
+  uint8_t* allocate(std::size_t size)
+  {
+    // Big buffers are allocated on their own, so that they do not waste the
+    // end of a block
+    if (size > ArenaBlockSize / 4)
+    {
+      _capacity += size;
+      return _bigBuffers.emplace_back(new uint8_t[size]).get();
+    }
+    if (_blocks.empty() || _blockUsed + size > ArenaBlockSize)
+    {
+      _blocks.emplace_back(new uint8_t[ArenaBlockSize]);
+      _blockUsed = 0;
+      _capacity += ArenaBlockSize;
+    }
+    auto const dest = _blocks.back().get() + _blockUsed;
+    _blockUsed += size;
+    return dest;
+  }
+};
+}
+
+namespace detail
+{
+struct MemoryDevice
+{
+  bool opened = false;
+  std::optional<std::vector<uint8_t>> device;
+};
+
+struct MemoryCache
+{
+  struct Entry
+  {
+    gsl::span<uint8_t const> value;
+    std::list<std::string_view>::iterator writeOrder;
+  };
+
+  std::size_t maxSize = 0;
+  bool opened = false;
+  Arena arena;
+  // The keys point to the arena
+  std::unordered_map<std::string_view, Entry> entries;
+  // Oldest write first, for the eviction
+  std::list<std::string_view> writeOrder;
+  std::size_t liveSize = 0;
+
+  void put(gsl::span<uint8_t const> key, gsl::span<uint8_t const> value)
+  {
+    if (auto const it = entries.find(asStringView(key)); it != entries.end())
+    {
+      liveSize -= it->second.value.size();
+      it->second.value = arena.copy(value);
+      liveSize += value.size();
+      writeOrder.splice(writeOrder.end(), writeOrder, it->second.writeOrder);
+      return;
+    }
+
+    auto const ownedKey = asStringView(arena.copy(key));
+    auto const ownedValue = arena.copy(value);
+    auto const order = writeOrder.insert(writeOrder.end(), ownedKey);
+    entries.emplace(ownedKey, Entry{ownedValue, order});
+    liveSize += key.size() + value.size();
+  }
+
+  // Keeps at least the keep most recent writes, and the entries that cannot be
+  // evicted
+  void evictOldest(std::size_t keep)
+  {
+    if (maxSize == 0)
+      return;
+    auto candidates = writeOrder.size() - std::min(keep, writeOrder.size());
+    for (auto order = writeOrder.begin(); liveSize > maxSize && candidates > 0; --candidates)
+    {
+      if (!isEvictableKey(asBytes(*order)))
+      {
+        ++order;
+        continue;
+      }
+      auto const it = entries.find(*order);
+      liveSize -= it->first.size() + it->second.value.size();
+      entries.erase(it);
+      order = writeOrder.erase(order);
+    }
+  }
+
+  void compactIfNeeded()
+  {
+    if (arena.capacity() <= 2 * std::max(liveSize, ArenaBlockSize))
+      return;
+
+    Arena compacted;
+    std::unordered_map<std::string_view, Entry> compactedEntries;
+    compactedEntries.reserve(entries.size());
+    for (auto& ownedKey : writeOrder)
+    {
+      auto const& entry = entries.at(ownedKey);
+      ownedKey = asStringView(compacted.copy(asBytes(ownedKey)));
+      compactedEntries.emplace(ownedKey, Entry{compacted.copy(entry.value), entry.writeOrder});
+    }
+    entries = std::move(compactedEntries);
+    arena = std::move(compacted);
+  }
+
+  void clear()
+  {
+    entries.clear();
+    writeOrder.clear();
+    arena = Arena{};
+    liveSize = 0;
+  }
+};
+}
+
+MemoryBackend::MemoryBackend(MemoryOptions options) : _options(options)
+{
+}
+
+std::unique_ptr<DataStore> MemoryBackend::open(std::string const& dataPath, std::string const& cachePath)
+{
+  auto& device = _devices[dataPath];
+  if (!device)
+    device = std::make_shared<detail::MemoryDevice>();
+  auto& cache = _caches[cachePath];
+  if (!cache)
+  {
+    cache = std::make_shared<detail::MemoryCache>();
+    cache->maxSize = _options.maxCacheSize;
+  }
+
+  // Same behavior as the exclusive lock of the SQLite backend
+  if (device->opened || cache->opened)
+    throw Errors::formatEx(Errc::DatabaseLocked, "database is already opened: {}", dataPath);
+
+  return std::unique_ptr<MemoryDataStore>(new MemoryDataStore(device, cache, _options.encryptValues));
+}
+
+MemoryDataStore::MemoryDataStore(std::shared_ptr<detail::MemoryDevice> device,
+                                 std::shared_ptr<detail::MemoryCache> cache,
+                                 bool encryptValues)
+  : _device(std::move(device)), _cache(std::move(cache)), _encryptValues(encryptValues)
+{
+  _device->opened = true;
+  _cache->opened = true;
+}
+
+MemoryDataStore::~MemoryDataStore()
+{
+  _device->opened = false;
+  _cache->opened = false;
+}
+
+tc::cotask<void> MemoryDataStore::nuke()
+{
+  _device->device.reset();
+  _cache->clear();
+  TC_RETURN();
+}
+
+tc::cotask<void> MemoryDataStore::putSerializedDevice(gsl::span<uint8_t const> device)
+{
+  _device->device.emplace(device.begin(), device.end());
+  TC_RETURN();
+}
+
+tc::cotask<std::optional<std::vector<uint8_t>>> MemoryDataStore::findSerializedDevice()
+{
+  TC_RETURN(_device->device);
+}
+
+tc::cotask<void> MemoryDataStore::putCacheValues(gsl::span<std::pair<Key, Value> const> keyValues,
+                                                 OnConflict onConflict)
+{
+  auto& cache = *_cache;
+
+  // Check everything first, a put is atomic
+  if (onConflict == OnConflict::Fail)
+  {
+    std::unordered_set<std::string_view> putKeys;
+    for (auto const& keyValue : keyValues)
+    {
+      auto const key = asStringView(keyValue.first);
+      if (cache.entries.count(key) || !putKeys.insert(key).second)
+        throw Errors::formatEx(Errc::ConstraintFailed, "a value already exists for this key");
+    }
+  }
+
+  for (auto const& [key, value] : keyValues)
+  {
+    if (onConflict == OnConflict::Ignore && cache.entries.count(asStringView(key)))
+      continue;
+    cache.put(key, value);
+  }
+
+  // Never evict what was just put, e.g. a value and its index
+  cache.evictOldest(keyValues.size());
+  cache.compactIfNeeded();
+  TC_RETURN();
+}
+
+tc::cotask<std::vector<std::optional<std::vector<uint8_t>>>> MemoryDataStore::findCacheValues(
+    gsl::span<Key const> keys)
+{
+  std::vector<std::optional<std::vector<uint8_t>>> out;
+  out.reserve(keys.size());
+  for (auto const& key : keys)
+  {
+    if (auto const it = _cache->entries.find(asStringView(key)); it != _cache->entries.end())
+      out.emplace_back(std::in_place, it->second.value.begin(), it->second.value.end());
+    else
+      out.emplace_back(std::nullopt);
+  }
+  TC_RETURN(out);
+}
+
+tc::cotask<CacheUsage> MemoryDataStore::findCacheUsage(Key prefix)
+{
+  auto const prefixView = asStringView(prefix);
+  CacheUsage usage;
+  for (auto const& [key, entry] : _cache->entries)
+  {
+    if (key.substr(0, prefixView.size()) != prefixView)
+      continue;
+    ++usage.entries;
+    usage.bytes += key.size() + entry.value.size();
+  }
+  TC_RETURN(usage);
+}
+
+bool MemoryDataStore::needsValueEncryption() const
+{
+  return _encryptValues;
+}
+}
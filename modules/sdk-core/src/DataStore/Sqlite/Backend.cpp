@@ -2,22 +2,41 @@
 
 #include <Tanker/DataStore/Errors/Errc.hpp>
 #include <Tanker/DataStore/Utils.hpp>
+#include <Tanker/Errors/Errc.hpp>
+#include <Tanker/Errors/Exception.hpp>
+#include <Tanker/Log/Log.hpp>
+
+#include <fmt/format.h>
 
 #include <sqlpp11/ppgen.h>
 #include <sqlpp11/sqlite3/insert_or.h>
 #include <sqlpp11/sqlpp11.h>
 
-#include <boost/container/flat_map.hpp>
+#include <sqlite3.h>
+
+#include <tconcurrent/async.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
 
-#include <range/v3/range/conversion.hpp>
-#include <range/v3/view/transform.hpp>
+TLOG_CATEGORY(SqliteDataStore);
 
 namespace Tanker::DataStore
 {
 namespace
 {
 constexpr auto LatestDeviceVersion = 1;
-constexpr auto LatestCacheVersion = 1;
+constexpr auto LatestCacheVersion = 2;
+
+// Reading an entry only records the access when the last one is older than
+// this, so that reads seldom turn into writes
+constexpr std::int64_t AccessGranularity = 3600;
+// Entries are evicted by groups of this size
+constexpr int EvictionBatchSize = 256;
 
 // clang-format off
 SQLPP_DECLARE_TABLE(
@@ -34,6 +53,12 @@ SQLPP_DECLARE_TABLE(
 )
 // clang-format on
 
+void checkResult(sqlite3* db, int result)
+{
+  if (result != SQLITE_OK)
+    throw Errors::formatEx(Errc::DatabaseError, "{}", sqlite3_errmsg(db));
+}
+
 std::string appendDbSuffix(std::string db, std::string_view suffix)
 {
   if (db != ":memory:")
@@ -60,12 +85,28 @@ void createDeviceTable(Connection& db)
 
 void createCacheTable(Connection& db)
 {
+  // Must be set before the first table is created, the file then gives the
+  // pages freed by an eviction back incrementally
+  db.execute("PRAGMA auto_vacuum = INCREMENTAL");
   db.execute(R"(
     CREATE TABLE cache (
       key BLOB PRIMARY KEY,
-      value BLOB NOT NULL
+      value BLOB NOT NULL,
+      last_access INTEGER NOT NULL DEFAULT 0
     )
   )");
+  db.execute("CREATE INDEX cache_last_access ON cache (last_access)");
+}
+
+// Version 1 had no access time and no auto_vacuum. The existing entries are
+// considered the oldest ones.
+void migrateCacheTableToV2(Connection& db)
+{
+  db.execute("ALTER TABLE cache ADD COLUMN last_access INTEGER NOT NULL DEFAULT 0");
+  db.execute("CREATE INDEX cache_last_access ON cache (last_access)");
+  db.execute("PRAGMA auto_vacuum = INCREMENTAL");
+  // Switching an existing database to auto_vacuum needs a full vacuum, once
+  db.execute("VACUUM");
 }
 
 ConnPtr openDeviceDb(std::string dataPath)
@@ -89,9 +130,17 @@ ConnPtr openDeviceDb(std::string dataPath)
   return dbDevice;
 }
 
-ConnPtr openCacheDb(std::string cachePath)
+ConnPtr openCacheDb(std::string cachePath, SqliteOptions const& options)
 {
+  auto const inMemory = cachePath == MemoryPath;
   auto dbCache = createConnection(appendDbSuffix(std::move(cachePath), "-cache.db"), {}, true);
+  // The exclusive lock is already taken, so the log does not need shared memory
+  if (options.writeAheadLog && !inMemory)
+  {
+    auto const db = dbCache->native_handle();
+    checkResult(db, sqlite3_exec(db, "PRAGMA journal_mode = WAL", nullptr, nullptr, nullptr));
+    checkResult(db, sqlite3_exec(db, "PRAGMA synchronous = NORMAL", nullptr, nullptr, nullptr));
+  }
   auto cacheVersion = getDbVersion(*dbCache);
   switch (cacheVersion)
   {
@@ -99,6 +148,10 @@ ConnPtr openCacheDb(std::string cachePath)
     createCacheTable(*dbCache);
     dbCache->execute(fmt::format("PRAGMA user_version = {}", LatestCacheVersion));
     break;
+  case 1:
+    migrateCacheTableToV2(*dbCache);
+    dbCache->execute(fmt::format("PRAGMA user_version = {}", LatestCacheVersion));
+    break;
   case LatestCacheVersion:
     break;
   default:
@@ -114,130 +167,467 @@ ConnPtr openCacheDb(std::string cachePath)
 using DeviceTable = device::device;
 using CacheTable = cache::cache;
 
+SqliteBackend::SqliteBackend(SqliteOptions options) : _options(options)
+{
+}
+
 std::unique_ptr<DataStore> SqliteBackend::open(std::string const& dataPath, std::string const& cachePath)
 {
   auto dbDevice = openDeviceDb(dataPath);
-  auto dbCache = openCacheDb(cachePath);
+  auto dbCache = openCacheDb(cachePath, _options);
+
+  return std::unique_ptr<SqliteDataStore>(
+      new SqliteDataStore(std::move(dbDevice), std::move(dbCache), _options.maxCacheSize));
+}
 
-  return std::unique_ptr<SqliteDataStore>(new SqliteDataStore(std::move(dbDevice), std::move(dbCache)));
+SqliteDataStore::SqliteDataStore(ConnPtr dbDevice, ConnPtr dbCache, std::size_t maxCacheSize)
+  : _dbDevice(std::move(dbDevice)), _dbCache(std::move(dbCache)), _maxCacheSize(maxCacheSize)
+{
+  _storageThread.start(1);
+}
+
+SqliteDataStore::~SqliteDataStore()
+{
+  // The queued operations use the connections: stop() lets them run before it
+  // joins the storage thread
+  _storageThread.stop();
 }
 
-SqliteDataStore::SqliteDataStore(ConnPtr dbDevice, ConnPtr dbCache)
-  : _dbDevice(std::move(dbDevice)), _dbCache(std::move(dbCache))
+tc::executor SqliteDataStore::storageExecutor()
 {
+  return tc::executor(_storageThread);
 }
 
-void SqliteDataStore::nuke()
+tc::cotask<void> SqliteDataStore::nuke()
 {
-  DeviceTable deviceTable{};
-  (*_dbDevice)(remove_from(deviceTable).unconditionally());
-  CacheTable cacheTable{};
-  (*_dbCache)(remove_from(cacheTable).unconditionally());
+  TC_AWAIT(tc::async(storageExecutor(), [this] {
+    DeviceTable deviceTable{};
+    (*_dbDevice)(remove_from(deviceTable).unconditionally());
+    CacheTable cacheTable{};
+    (*_dbCache)(remove_from(cacheTable).unconditionally());
+  }));
 }
 
-void SqliteDataStore::putSerializedDevice(gsl::span<uint8_t const> device)
+tc::cotask<void> SqliteDataStore::putSerializedDevice(gsl::span<uint8_t const> device)
 {
-  DeviceTable tab{};
-  (*_dbDevice)(sqlpp::sqlite3::insert_or_replace_into(tab).set(
-      tab.id = 1, tab.deviceblob = std::vector<uint8_t>(device.begin(), device.end())));
+  TC_AWAIT(tc::async(storageExecutor(), [this, blob = std::vector<uint8_t>(device.begin(), device.end())] {
+    DeviceTable tab{};
+    (*_dbDevice)(sqlpp::sqlite3::insert_or_replace_into(tab).set(tab.id = 1, tab.deviceblob = blob));
+  }));
 }
 
-std::optional<std::vector<uint8_t>> SqliteDataStore::findSerializedDevice()
+tc::cotask<std::optional<std::vector<uint8_t>>> SqliteDataStore::findSerializedDevice()
 {
-  DeviceTable tab{};
-  auto rows = (*_dbDevice)(select(tab.deviceblob).from(tab).unconditionally());
-  if (rows.empty())
-    return std::nullopt;
+  TC_RETURN(TC_AWAIT(tc::async(storageExecutor(), [this]() -> std::optional<std::vector<uint8_t>> {
+    DeviceTable tab{};
+    auto rows = (*_dbDevice)(select(tab.deviceblob).from(tab).unconditionally());
+    if (rows.empty())
+      return std::nullopt;
 
-  auto const& row = rows.front();
-  return extractBlob<std::vector<uint8_t>>(row.deviceblob);
+    auto const& row = rows.front();
+    return extractBlob<std::vector<uint8_t>>(row.deviceblob);
+  })));
 }
 
 namespace
 {
+StatementPtr prepare(sqlite3* db, std::string_view sql)
+{
+  sqlite3_stmt* statement = nullptr;
+  checkResult(
+      db,
+      sqlite3_prepare_v3(
+          db, sql.data(), static_cast<int>(sql.size()), SQLITE_PREPARE_PERSISTENT, &statement, nullptr));
+  return StatementPtr(statement);
+}
+
+// Binds without a copy, the span must outlive the step
+void bindBlob(sqlite3_stmt* statement, int index, gsl::span<uint8_t const> blob)
+{
+  // A null pointer would bind NULL instead of an empty blob
+  static uint8_t const empty = 0;
+  checkResult(sqlite3_db_handle(statement),
+              sqlite3_bind_blob(
+                  statement, index, blob.empty() ? &empty : blob.data(), static_cast<int>(blob.size()), SQLITE_STATIC));
+}
+
+std::int64_t now()
+{
+  return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+std::int64_t queryInteger(sqlite3* db, char const* sql)
+{
+  auto const statement = prepare(db, sql);
+  if (sqlite3_step(statement.get()) != SQLITE_ROW)
+    throw Errors::formatEx(Errc::DatabaseError, "{}", sqlite3_errmsg(db));
+  return sqlite3_column_int64(statement.get(), 0);
+}
+
+// The first key that does not start with prefix, empty when there is none
+std::vector<uint8_t> prefixUpperBound(gsl::span<uint8_t const> prefix)
+{
+  std::vector<uint8_t> bound(prefix.begin(), prefix.end());
+  while (!bound.empty() && bound.back() == 0xff)
+    bound.pop_back();
+  if (!bound.empty())
+    ++bound.back();
+  return bound;
+}
+
+std::string toBlobLiteral(gsl::span<uint8_t const> bytes)
+{
+  std::string out = "X'";
+  for (auto const byte : bytes)
+    out += fmt::format("{:02X}", byte);
+  return out + "'";
+}
+
+// Matches the keys that start with one of the evictable prefixes, as ranges on
+// the primary key
+std::string evictableKeysCondition()
+{
+  std::vector<std::string> conditions;
+  for (auto const prefix : evictableKeyPrefixes())
+  {
+    auto const bytes = gsl::span<uint8_t const>(reinterpret_cast<uint8_t const*>(prefix.data()), prefix.size());
+    conditions.push_back(
+        fmt::format("(key >= {} AND key < {})", toBlobLiteral(bytes), toBlobLiteral(prefixUpperBound(bytes))));
+  }
+  return fmt::format("({})", fmt::join(conditions, " OR "));
+}
+
+// Makes a cached statement ready for the next use
+struct StatementScope
+{
+  sqlite3_stmt* statement;
+
+  ~StatementScope()
+  {
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
+  }
+};
+
+std::string_view putStatementSql(OnConflict onConflict)
+{
+  switch (onConflict)
+  {
+  case OnConflict::Fail:
+    return "INSERT INTO cache (key, value, last_access) VALUES (?, ?, ?)";
+  case OnConflict::Ignore:
+    return "INSERT OR IGNORE INTO cache (key, value, last_access) VALUES (?, ?, ?)";
+  case OnConflict::Replace:
+    return "INSERT OR REPLACE INTO cache (key, value, last_access) VALUES (?, ?, ?)";
+  case OnConflict::Last:
+    break;
+  }
+  throw Errors::formatEx(Errors::Errc::InternalError, "unknown OnConflict value: {}", static_cast<int>(onConflict));
+}
+
+// The caller's buffers are copied: a write can outlive the task that made it,
+// e.g. when that task is canceled.
 template <typename T>
-void fillMultiInsert(T& multi_insert, gsl::span<std::pair<DataStore::Key, DataStore::Value> const> keyValues)
+struct OwnedSpans
+{
+  std::vector<uint8_t> buffer;
+  std::vector<T> spans;
+};
+
+std::shared_ptr<OwnedSpans<DataStore::Key> const> copyKeys(gsl::span<DataStore::Key const> keys)
+{
+  auto owned = std::make_shared<OwnedSpans<DataStore::Key>>();
+  std::size_t size = 0;
+  for (auto const& key : keys)
+    size += key.size();
+  owned->buffer.resize(size);
+  owned->spans.reserve(keys.size());
+  auto it = owned->buffer.data();
+  for (auto const& key : keys)
+  {
+    owned->spans.emplace_back(it, key.size());
+    it = std::copy(key.begin(), key.end(), it);
+  }
+  return owned;
+}
+
+using KeyValue = std::pair<DataStore::Key, DataStore::Value>;
+
+std::shared_ptr<OwnedSpans<KeyValue> const> copyKeyValues(gsl::span<KeyValue const> keyValues)
 {
-  CacheTable tab{};
+  auto owned = std::make_shared<OwnedSpans<KeyValue>>();
+  std::size_t size = 0;
   for (auto const& [key, value] : keyValues)
-    multi_insert.values.add(tab.key = key | ranges::to<std::vector>, tab.value = value | ranges::to<std::vector>);
+    size += key.size() + value.size();
+  owned->buffer.resize(size);
+  owned->spans.reserve(keyValues.size());
+  auto it = owned->buffer.data();
+  for (auto const& [key, value] : keyValues)
+  {
+    auto const ownedKey = gsl::span<uint8_t const>(it, key.size());
+    it = std::copy(key.begin(), key.end(), it);
+    auto const ownedValue = gsl::span<uint8_t const>(it, value.size());
+    it = std::copy(value.begin(), value.end(), it);
+    owned->spans.emplace_back(ownedKey, ownedValue);
+  }
+  return owned;
 }
 }
 
-void SqliteDataStore::putCacheValues(gsl::span<std::pair<Key, Value> const> keyValues, OnConflict onConflict)
+namespace detail
 {
-  if (keyValues.empty())
-    return;
+void StatementDeleter::operator()(sqlite3_stmt* statement) const
+{
+  sqlite3_finalize(statement);
+}
+}
 
-  CacheTable tab{};
+sqlite3_stmt* SqliteDataStore::putStatement(OnConflict onConflict)
+{
+  auto const sql = putStatementSql(onConflict);
+  auto& statement = _putStatements[static_cast<std::size_t>(onConflict)];
+  if (!statement)
+    statement = prepare(_dbCache->native_handle(), sql);
+  return statement.get();
+}
 
-  switch (onConflict)
+void SqliteDataStore::executeOnCache(char const* sql)
+{
+  auto const db = _dbCache->native_handle();
+  checkResult(db, sqlite3_exec(db, sql, nullptr, nullptr, nullptr));
+}
+
+tc::shared_future<void> SqliteDataStore::enqueueWrite(std::shared_ptr<PendingWrite> write)
+{
+  std::scoped_lock const lock(_pendingMutex);
+  // A flush is already scheduled when the queue is not empty, it will take this
+  // write too
+  if (_pendingWrites.empty())
+    _pendingFlush = tc::async(storageExecutor(), [this] { flushWrites(); }).to_shared();
+  _pendingWrites.push_back(std::move(write));
+  return _pendingFlush;
+}
+
+void SqliteDataStore::flushWrites()
+{
+  std::vector<std::shared_ptr<PendingWrite>> writes;
+  {
+    std::scoped_lock const lock(_pendingMutex);
+    writes.swap(_pendingWrites);
+  }
+
+  // One commit instead of one per write. Each put still has its own savepoint,
+  // so a failed one does not take the others down.
+  auto const inTransaction = writes.size() > 1;
+  if (inTransaction)
+    executeOnCache("BEGIN");
+
+  for (auto const& write : writes)
   {
-  case OnConflict::Fail: {
     try
     {
-      auto multi_insert = insert_into(tab).columns(tab.key, tab.value);
-      fillMultiInsert(multi_insert, keyValues);
-      (*_dbCache)(multi_insert);
+      write->run();
     }
-    catch (sqlpp::exception const& e)
+    catch (...)
     {
-      std::string const msg = e.what();
-      if (msg.find("UNIQUE constraint failed") != std::string::npos)
-        throw Errors::formatEx(Errc::ConstraintFailed, "{}", msg);
-      else
-        throw;
+      write->error = std::current_exception();
     }
-    return;
   }
-  case OnConflict::Ignore: {
-    auto multi_insert = sqlpp::sqlite3::insert_or_ignore_into(tab).columns(tab.key, tab.value);
-    fillMultiInsert(multi_insert, keyValues);
-    (*_dbCache)(multi_insert);
-    return;
+
+  if (inTransaction)
+  {
+    try
+    {
+      executeOnCache("COMMIT");
+    }
+    catch (...)
+    {
+      sqlite3_exec(_dbCache->native_handle(), "ROLLBACK", nullptr, nullptr, nullptr);
+      throw;
+    }
   }
-  case OnConflict::Replace: {
-    auto multi_insert = sqlpp::sqlite3::insert_or_replace_into(tab).columns(tab.key, tab.value);
-    fillMultiInsert(multi_insert, keyValues);
-    (*_dbCache)(multi_insert);
-    return;
+
+  // The writes are committed, an eviction failure must not fail them
+  try
+  {
+    evictNow();
   }
-  case OnConflict::Last:
-    break;
+  catch (std::exception const& e)
+  {
+    TERROR("Failed to evict cache entries: {}", e.what());
   }
-  throw Errors::formatEx(Errors::Errc::InternalError, "unknown OnConflict value: {}", static_cast<int>(onConflict));
 }
 
-namespace
+tc::cotask<void> SqliteDataStore::putCacheValues(gsl::span<std::pair<Key, Value> const> keyValues,
+                                                 OnConflict onConflict)
 {
-template <typename T>
-std::vector<std::optional<std::vector<uint8_t>>> sortResults(T& rows, std::vector<std::vector<uint8_t>> const& keys)
+  if (keyValues.empty())
+    TC_RETURN();
+
+  auto const write = std::make_shared<PendingWrite>();
+  write->run = [this, owned = copyKeyValues(keyValues), onConflict] { putCacheValuesNow(owned->spans, onConflict); };
+  TC_AWAIT(enqueueWrite(write));
+  if (write->error)
+    std::rethrow_exception(write->error);
+}
+
+tc::cotask<std::vector<std::optional<std::vector<uint8_t>>>> SqliteDataStore::findCacheValues(
+    gsl::span<Key const> keys)
+{
+  TC_RETURN(TC_AWAIT(
+      tc::async(storageExecutor(), [this, owned = copyKeys(keys)] { return findCacheValuesNow(owned->spans); })));
+}
+
+void SqliteDataStore::putCacheValuesNow(gsl::span<std::pair<Key, Value> const> keyValues, OnConflict onConflict)
+{
+  auto const db = _dbCache->native_handle();
+  auto const statement = putStatement(onConflict);
+  auto const accessTime = now();
+
+  // The savepoint makes the whole put atomic, like a single multi-row insert.
+  // Inside a transaction it does not commit anything by itself.
+  executeOnCache("SAVEPOINT put_cache_values");
+  try
+  {
+    for (auto const& [key, value] : keyValues)
+    {
+      StatementScope const scope{statement};
+      bindBlob(statement, 1, key);
+      bindBlob(statement, 2, value);
+      checkResult(db, sqlite3_bind_int64(statement, 3, accessTime));
+      auto const result = sqlite3_step(statement);
+      if ((result & 0xff) == SQLITE_CONSTRAINT)
+        throw Errors::formatEx(Errc::ConstraintFailed, "{}", sqlite3_errmsg(db));
+      else if (result != SQLITE_DONE)
+        throw Errors::formatEx(Errc::DatabaseError, "{}", sqlite3_errmsg(db));
+    }
+  }
+  catch (...)
+  {
+    executeOnCache("ROLLBACK TO put_cache_values");
+    executeOnCache("RELEASE put_cache_values");
+    throw;
+  }
+  executeOnCache("RELEASE put_cache_values");
+}
+
+std::vector<std::optional<std::vector<uint8_t>>> SqliteDataStore::findCacheValuesNow(gsl::span<Key const> keys)
 {
-  boost::container::flat_map<std::vector<uint8_t>, std::vector<uint8_t>> resultMap;
-  resultMap.reserve(keys.size());
-  for (auto const& row : rows)
-    resultMap[row.key] = extractBlob<std::vector<uint8_t>>(row.value);
+  auto const db = _dbCache->native_handle();
+  if (!_findStatement)
+    _findStatement = prepare(db, "SELECT value, last_access FROM cache WHERE key = ?");
+  auto const statement = _findStatement.get();
+  auto const accessTime = now();
+
+  // One lookup on the primary key per key, the results come in order
+  std::vector<std::optional<std::vector<uint8_t>>> out;
+  std::vector<Key> accessedKeys;
+  out.reserve(keys.size());
+  for (auto const& key : keys)
+  {
+    StatementScope const scope{statement};
+    bindBlob(statement, 1, key);
+    auto const result = sqlite3_step(statement);
+    if (result == SQLITE_ROW)
+    {
+      auto const blob = static_cast<uint8_t const*>(sqlite3_column_blob(statement, 0));
+      auto const size = sqlite3_column_bytes(statement, 0);
+      out.emplace_back(blob ? std::vector<uint8_t>(blob, blob + size) : std::vector<uint8_t>{});
+      if (accessTime - sqlite3_column_int64(statement, 1) >= AccessGranularity)
+        accessedKeys.push_back(key);
+    }
+    else if (result == SQLITE_DONE)
+      out.emplace_back(std::nullopt);
+    else
+      throw Errors::formatEx(Errc::DatabaseError, "{}", sqlite3_errmsg(db));
+  }
 
-  return keys | ranges::views::transform([&](auto const& key) -> std::optional<std::vector<uint8_t>> {
-           if (auto const it = resultMap.find(key); it != resultMap.end())
-             return it->second;
-           else
-             return std::nullopt;
-         }) |
-         ranges::to<std::vector>;
+  // Only the eviction needs the access times, they go with the next writes
+  if (_maxCacheSize != 0 && !accessedKeys.empty())
+  {
+    auto const write = std::make_shared<PendingWrite>();
+    write->run = [this, owned = copyKeys(accessedKeys), accessTime] { recordAccessesNow(owned->spans, accessTime); };
+    enqueueWrite(write);
+  }
+  return out;
+}
+
+void SqliteDataStore::recordAccessesNow(gsl::span<Key const> keys, std::int64_t accessTime)
+{
+  auto const db = _dbCache->native_handle();
+  if (!_recordAccessStatement)
+    _recordAccessStatement = prepare(db, "UPDATE cache SET last_access = ? WHERE key = ?");
+  auto const statement = _recordAccessStatement.get();
+  for (auto const& key : keys)
+  {
+    StatementScope const scope{statement};
+    checkResult(db, sqlite3_bind_int64(statement, 1, accessTime));
+    bindBlob(statement, 2, key);
+    if (sqlite3_step(statement) != SQLITE_DONE)
+      throw Errors::formatEx(Errc::DatabaseError, "{}", sqlite3_errmsg(db));
+  }
 }
+
+std::uint64_t SqliteDataStore::cacheFileSize()
+{
+  auto const db = _dbCache->native_handle();
+  auto const usedPages =
+      queryInteger(db, "PRAGMA page_count") - queryInteger(db, "PRAGMA freelist_count");
+  return static_cast<std::uint64_t>(usedPages * queryInteger(db, "PRAGMA page_size"));
 }
 
-std::vector<std::optional<std::vector<uint8_t>>> SqliteDataStore::findCacheValues(
-    gsl::span<gsl::span<uint8_t const> const> keysArg)
+// Evicts the least recently used evictable entries down to 90% of the bound, so
+// that it does not run again on the next write
+void SqliteDataStore::evictNow()
 {
-  // sqlpp needs vectors, so we convert the spans
-  auto const keys = keysArg | ranges::views::transform([](auto const& k) { return ranges::to<std::vector>(k); }) |
-                    ranges::to<std::vector>;
+  if (_maxCacheSize == 0 || cacheFileSize() <= _maxCacheSize)
+    return;
 
-  CacheTable tab{};
-  auto rows = (*_dbCache)(select(tab.key, tab.value).from(tab).where(tab.key.in(sqlpp::value_list(keys))));
+  auto const db = _dbCache->native_handle();
+  if (!_evictionStatement)
+    _evictionStatement = prepare(
+        db,
+        fmt::format("DELETE FROM cache WHERE rowid IN (SELECT rowid FROM cache WHERE {} ORDER BY last_access LIMIT {})",
+                    evictableKeysCondition(),
+                    EvictionBatchSize));
+  auto const statement = _evictionStatement.get();
+  auto const target = _maxCacheSize / 10 * 9;
+  std::uint64_t evicted = 0;
+  while (cacheFileSize() > target)
+  {
+    StatementScope const scope{statement};
+    if (sqlite3_step(statement) != SQLITE_DONE)
+      throw Errors::formatEx(Errc::DatabaseError, "{}", sqlite3_errmsg(db));
+    auto const changes = sqlite3_changes(db);
+    if (changes == 0)
+      break;
+    evicted += changes;
+  }
+  // Gives the freed pages back to the file system
+  executeOnCache("PRAGMA incremental_vacuum");
+  TINFO("Evicted {} cache entries", evicted);
+}
 
-  return sortResults(rows, keys);
+tc::cotask<CacheUsage> SqliteDataStore::findCacheUsage(Key prefix)
+{
+  TC_RETURN(TC_AWAIT(tc::async(
+      storageExecutor(), [this, lowerBound = std::vector<uint8_t>(prefix.begin(), prefix.end())]() -> CacheUsage {
+        auto const upperBound = prefixUpperBound(lowerBound);
+        auto const db = _dbCache->native_handle();
+        auto const statement = prepare(db,
+                                       upperBound.empty() ?
+                                           "SELECT count(*), coalesce(sum(length(key) + length(value)), 0) FROM cache "
+                                           "WHERE key >= ?" :
+                                           "SELECT count(*), coalesce(sum(length(key) + length(value)), 0) FROM cache "
+                                           "WHERE key >= ? AND key < ?");
+        bindBlob(statement.get(), 1, lowerBound);
+        if (!upperBound.empty())
+          bindBlob(statement.get(), 2, upperBound);
+        if (sqlite3_step(statement.get()) != SQLITE_ROW)
+          throw Errors::formatEx(Errc::DatabaseError, "{}", sqlite3_errmsg(db));
+        return {static_cast<std::uint64_t>(sqlite3_column_int64(statement.get(), 0)),
+                static_cast<std::uint64_t>(sqlite3_column_int64(statement.get(), 1))};
+      })));
 }
 }
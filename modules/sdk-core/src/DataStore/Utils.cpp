@@ -1,15 +1,26 @@
 #include <Tanker/DataStore/Utils.hpp>
 
 #include <Tanker/Crypto/Errors/ErrcCategory.hpp>
+#include <Tanker/DataStore/Backend.hpp>
 #include <Tanker/DataStore/Errors/Errc.hpp>
 #include <Tanker/Encryptor/v2.hpp>
+#include <Tanker/Errors/Errc.hpp>
 #include <Tanker/Log/Log.hpp>
 #include <Tanker/Serialization/Errors/ErrcCategory.hpp>
 
+#include <algorithm>
+#include <array>
+
 TLOG_CATEGORY(DataStore);
 
 namespace Tanker::DataStore
 {
+namespace
+{
+// Must be kept in sync with the prefixes of the stores
+constexpr std::array<std::string_view, 3> EvictableKeyPrefixes{"resourcekey-", "groups-", "transparent-session-"};
+}
+
 [[noreturn]] void handleError(Errors::Exception const& e)
 {
   if (e.errorCode().category() == Serialization::ErrcCategory() || e.errorCode().category() == Crypto::ErrcCategory() ||
@@ -23,6 +34,24 @@ namespace Tanker::DataStore
     throw;
 }
 
+gsl::span<std::string_view const> evictableKeyPrefixes()
+{
+  return EvictableKeyPrefixes;
+}
+
+bool isEvictableKey(gsl::span<uint8_t const> key)
+{
+  std::string_view const keyView(reinterpret_cast<char const*>(key.data()), key.size());
+  return std::any_of(EvictableKeyPrefixes.begin(), EvictableKeyPrefixes.end(), [&](auto const& prefix) {
+    return keyView.substr(0, prefix.size()) == prefix;
+  });
+}
+
+tc::cotask<CacheUsage> DataStore::findCacheUsage(Key)
+{
+  throw Errors::formatEx(Errors::Errc::InternalError, "this datastore does not report its cache usage");
+}
+
 // We chose the V2 format for storage encryption.
 // V1 is deprecated
 // V3 has a fixed nonce, so it's not meant to be used multiple times with the
@@ -31,16 +60,25 @@ namespace Tanker::DataStore
 // V5 has a resource ID which we don't need
 // See https://github.com/TankerHQ/spec/blob/master/encryption_formats.md
 
-std::vector<uint8_t> encryptValue(Crypto::SymmetricKey const& userSecret, gsl::span<uint8_t const> value)
+std::vector<uint8_t> encryptValue(DataStore const& db,
+                                  Crypto::SymmetricKey const& userSecret,
+                                  gsl::span<uint8_t const> value)
 {
+  if (!db.needsValueEncryption())
+    return {value.begin(), value.end()};
+
   std::vector<uint8_t> encryptedValue(EncryptorV2::encryptedSize(value.size()));
   EncryptorV2::encryptSync(encryptedValue, value, userSecret);
   return encryptedValue;
 }
 
-tc::cotask<std::vector<uint8_t>> decryptValue(Crypto::SymmetricKey const& userSecret,
+tc::cotask<std::vector<uint8_t>> decryptValue(DataStore const& db,
+                                              Crypto::SymmetricKey const& userSecret,
                                               gsl::span<uint8_t const> encryptedValue)
 {
+  if (!db.needsValueEncryption())
+    TC_RETURN((std::vector<uint8_t>(encryptedValue.begin(), encryptedValue.end())));
+
   std::vector<uint8_t> decryptedValue(EncryptorV2::decryptedSize(encryptedValue));
   TC_AWAIT(EncryptorV2::decrypt(decryptedValue, Encryptor::fixedKeyFinder(userSecret), encryptedValue));
   TC_RETURN(decryptedValue);
@@ -1,6 +1,7 @@
 #include <Tanker/Groups/Accessor.hpp>
 
 #include <Tanker/Actions/Deduplicate.hpp>
+#include <Tanker/ConcurrentChunks.hpp>
 #include <Tanker/Crypto/Format/Format.hpp>
 #include <Tanker/Errors/AssertionError.hpp>
 #include <Tanker/Errors/Errc.hpp>
@@ -8,15 +9,16 @@
 #include <Tanker/Groups/Store.hpp>
 #include <Tanker/Groups/Updater.hpp>
 #include <Tanker/Log/Log.hpp>
+#include <Tanker/Trustchain/Actions/UserGroupAddition.hpp>
 #include <Tanker/Trustchain/Actions/UserGroupCreation.hpp>
 #include <Tanker/Types/Overloaded.hpp>
 #include <Tanker/Users/ILocalUserAccessor.hpp>
 
 #include <range/v3/action/join.hpp>
 #include <range/v3/action/stable_sort.hpp>
+#include <range/v3/algorithm/find_if.hpp>
 #include <range/v3/functional/on.hpp>
 #include <range/v3/range/conversion.hpp>
-#include <range/v3/view/chunk.hpp>
 #include <range/v3/view/group_by.hpp>
 #include <range/v3/view/map.hpp>
 #include <range/v3/view/set_algorithm.hpp>
@@ -183,28 +185,87 @@ auto Accessor::partitionGroups(std::vector<Trustchain::GroupAction> entries) ->
 tc::cotask<std::vector<Trustchain::GroupAction>> Accessor::getGroupEntries(
     gsl::span<Trustchain::GroupId const> groupIds)
 {
-  std::vector<std::vector<Trustchain::GroupAction>> batchedEntries;
-
-  for (auto const chunk : groupIds | ranges::views::chunk(ChunkSize))
-    batchedEntries.push_back(TC_AWAIT(_requester->getGroupBlocks(chunk)));
+  auto batchedEntries = TC_AWAIT(mapChunksConcurrently(
+      groupIds, ChunkSize, [&](auto const chunk) { return _requester->getGroupBlocks(chunk); }));
   TC_RETURN(std::move(batchedEntries) | ranges::actions::join);
 }
 
+std::optional<gsl::span<Trustchain::GroupAction const>> Accessor::entriesAfterHead(
+    Group const& storedGroup, gsl::span<Trustchain::GroupAction const> entries)
+{
+  // An external group can become internal without any new block, when we
+  // claim a provisional identity that was added to it, only a full replay
+  // finds that out
+  if (!boost::variant2::holds_alternative<InternalGroup>(storedGroup))
+    return std::nullopt;
+
+  auto const& head = extractBaseGroup(storedGroup).lastBlockHash();
+  auto const headIt =
+      ranges::find_if(entries, [&](auto const& entry) { return Trustchain::getHash(entry) == head; });
+  if (headIt == entries.end())
+    return std::nullopt;
+
+  auto const newEntries = entries.subspan(std::distance(entries.begin(), headIt) + 1);
+  if (!newEntries.empty())
+  {
+    auto const addition = boost::variant2::get_if<Trustchain::Actions::UserGroupAddition>(&newEntries.front());
+    if (!addition || addition->previousGroupBlockHash() != head)
+      return std::nullopt;
+  }
+  return newEntries;
+}
+
 tc::cotask<std::vector<Group>> Accessor::processGroupEntries(GroupMap const& groups)
 {
-  std::vector<Group> ret;
+  std::vector<std::optional<Group>> ret;
   ret.reserve(groups.size());
+  // The groups that have new blocks are processed all at once, and their
+  // index in ret
+  std::vector<GroupUpdater::GroupEntries> toProcess;
+  std::vector<std::size_t> toProcessIndexes;
 
   for (auto const& [id, entries] : groups)
   {
-    auto group = TC_AWAIT(GroupUpdater::processGroupEntries(
-        *_localUserAccessor, *_userAccessor, *_provisionalUserAccessor, std::nullopt, entries));
-    if (!group)
-      throw Errors::AssertionError(fmt::format("group {} has no blocks", id));
-    ret.push_back(std::move(*group));
-    TC_AWAIT(_groupStore->put(ret.back()));
+    // The server always sends the whole history, but the blocks up to the
+    // stored head were verified when it was stored
+    if (auto storedGroup = TC_AWAIT(_groupStore->findById(id)))
+    {
+      if (auto const newEntries = entriesAfterHead(*storedGroup, entries))
+      {
+        if (newEntries->empty())
+        {
+          ret.push_back(std::move(storedGroup));
+          continue;
+        }
+        toProcessIndexes.push_back(ret.size());
+        toProcess.push_back({std::move(storedGroup), *newEntries});
+        ret.emplace_back();
+        continue;
+      }
+      TINFO("Stored group {:s} does not link up with its history, replaying it", id);
+    }
+
+    toProcessIndexes.push_back(ret.size());
+    toProcess.push_back({std::nullopt, entries});
+    ret.emplace_back();
   }
-  TC_RETURN(ret);
+
+  auto processedGroups = TC_AWAIT(
+      GroupUpdater::processGroupsEntries(*_localUserAccessor, *_userAccessor, *_provisionalUserAccessor, toProcess));
+  std::vector<Group> updatedGroups;
+  updatedGroups.reserve(processedGroups.size());
+  for (auto i = 0u; i < processedGroups.size(); ++i)
+  {
+    if (!processedGroups[i])
+      throw Errors::AssertionError(
+          fmt::format("group {} has no blocks", Trustchain::getGroupId(toProcess[i].entries.front())));
+    updatedGroups.push_back(*processedGroups[i]);
+    ret[toProcessIndexes[i]] = std::move(processedGroups[i]);
+  }
+  TC_AWAIT(_groupStore->put(updatedGroups));
+
+  TC_RETURN(ret | ranges::views::transform([](auto& group) { return std::move(*group); }) |
+            ranges::to<std::vector>);
 }
 
 tc::cotask<Accessor::GroupPullResult> Accessor::getGroups(std::vector<Trustchain::GroupId> groupIds)
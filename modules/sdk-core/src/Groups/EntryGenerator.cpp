@@ -2,6 +2,9 @@
 #include <Tanker/Groups/EntryGenerator.hpp>
 
 #include <Tanker/Crypto/Crypto.hpp>
+#include <Tanker/WorkerPool.hpp>
+
+#include <optional>
 
 using namespace Tanker::Trustchain;
 using namespace Tanker::Trustchain::Actions;
@@ -9,6 +12,47 @@ using namespace Tanker::Errors;
 
 namespace Tanker::Groups
 {
+namespace
+{
+UserGroupMember2 makeUserGroupMember2(Crypto::PrivateEncryptionKey const& groupPrivateEncryptionKey,
+                                      Users::User const& user)
+{
+  if (!user.userKey())
+    throw AssertionError("cannot create group for users without a user key");
+
+  return UserGroupMember2{user.id(), *user.userKey(), Crypto::sealEncrypt(groupPrivateEncryptionKey, *user.userKey())};
+}
+
+UserGroupProvisionalMember3 makeUserGroupProvisionalMember3(
+    Crypto::PrivateEncryptionKey const& groupPrivateEncryptionKey, ProvisionalUsers::PublicUser const& user)
+{
+  auto const encryptedKeyOnce = Crypto::sealEncrypt(groupPrivateEncryptionKey, user.appEncryptionPublicKey());
+  auto const encryptedKeyTwice = Crypto::sealEncrypt(encryptedKeyOnce, user.tankerEncryptionPublicKey());
+
+  return UserGroupProvisionalMember3{user.appSignaturePublicKey(),
+                                     user.tankerSignaturePublicKey(),
+                                     user.appEncryptionPublicKey(),
+                                     user.tankerEncryptionPublicKey(),
+                                     encryptedKeyTwice};
+}
+
+// Members are not default constructible, each slot is filled by its own index
+template <typename Member, typename User, typename MakeMember>
+tc::cotask<std::vector<Member>> generateMembers(WorkerPool* workerPool,
+                                                std::vector<User> const& users,
+                                                MakeMember const& makeMember)
+{
+  std::vector<std::optional<Member>> members(users.size());
+  TC_AWAIT(parallelFor(workerPool, users.size(), [&](std::size_t i) { members[i].emplace(makeMember(users[i])); }));
+
+  std::vector<Member> out;
+  out.reserve(members.size());
+  for (auto& member : members)
+    out.push_back(std::move(*member));
+  TC_RETURN(out);
+}
+}
+
 UserGroupCreation::v1::SealedPrivateEncryptionKeysForUsers generateGroupKeysForUsers1(
     Crypto::PrivateEncryptionKey const& groupPrivateEncryptionKey, std::vector<Users::User> const& users)
 {
@@ -27,13 +71,7 @@ UserGroupCreation::v2::Members generateGroupKeysForUsers2(Crypto::PrivateEncrypt
 {
   UserGroupCreation::v2::Members keysForUsers;
   for (auto const& user : users)
-  {
-    if (!user.userKey())
-      throw AssertionError("cannot create group for users without a user key");
-
-    keysForUsers.emplace_back(
-        user.id(), *user.userKey(), Crypto::sealEncrypt(groupPrivateEncryptionKey, *user.userKey()));
-  }
+    keysForUsers.push_back(makeUserGroupMember2(groupPrivateEncryptionKey, user));
   return keysForUsers;
 }
 
@@ -70,16 +108,7 @@ UserGroupCreation::v3::ProvisionalMembers generateGroupKeysForProvisionalUsers3(
 {
   UserGroupCreation::v3::ProvisionalMembers keysForProvUsers;
   for (auto const& user : users)
-  {
-    auto const encryptedKeyOnce = Crypto::sealEncrypt(groupPrivateEncryptionKey, user.appEncryptionPublicKey());
-    auto const encryptedKeyTwice = Crypto::sealEncrypt(encryptedKeyOnce, user.tankerEncryptionPublicKey());
-
-    keysForProvUsers.emplace_back(user.appSignaturePublicKey(),
-                                  user.tankerSignaturePublicKey(),
-                                  user.appEncryptionPublicKey(),
-                                  user.tankerEncryptionPublicKey(),
-                                  encryptedKeyTwice);
-  }
+    keysForProvUsers.push_back(makeUserGroupProvisionalMember3(groupPrivateEncryptionKey, user));
   return keysForProvUsers;
 }
 
@@ -102,6 +131,25 @@ UserGroupCreation::v3::ProvisionalMembers generateGroupKeysForProvisionalUsers3(
   return keysForUsers;
 }
 
+tc::cotask<UserGroupCreation::v2::Members> generateGroupKeysForUsers2(
+    WorkerPool* workerPool,
+    Crypto::PrivateEncryptionKey const& groupPrivateEncryptionKey,
+    std::vector<Users::User> const& users)
+{
+  TC_RETURN(TC_AWAIT(generateMembers<UserGroupMember2>(
+      workerPool, users, [&](auto const& user) { return makeUserGroupMember2(groupPrivateEncryptionKey, user); })));
+}
+
+tc::cotask<UserGroupCreation::v3::ProvisionalMembers> generateGroupKeysForProvisionalUsers3(
+    WorkerPool* workerPool,
+    Crypto::PrivateEncryptionKey const& groupPrivateEncryptionKey,
+    std::vector<ProvisionalUsers::PublicUser> const& users)
+{
+  TC_RETURN(TC_AWAIT(generateMembers<UserGroupProvisionalMember3>(workerPool, users, [&](auto const& user) {
+    return makeUserGroupProvisionalMember3(groupPrivateEncryptionKey, user);
+  })));
+}
+
 Trustchain::Actions::UserGroupCreation1 createUserGroupCreationV1Action(
     Crypto::SignatureKeyPair const& groupSignatureKeyPair,
     Crypto::PublicEncryptionKey const& groupPublicEncryptionKey,
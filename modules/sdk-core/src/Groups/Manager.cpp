@@ -75,14 +75,15 @@ tc::cotask<MembersToRemove> fetchMembersToRemove(Users::IUserAccessor& userAcces
   TC_RETURN(std::move(ret));
 }
 
-Trustchain::Actions::UserGroupCreation makeUserGroupCreationAction(
+tc::cotask<Trustchain::Actions::UserGroupCreation> makeUserGroupCreationAction(
     std::vector<Users::User> const& memberUsers,
     std::vector<ProvisionalUsers::PublicUser> const& memberProvisionalUsers,
     Crypto::SignatureKeyPair const& groupSignatureKeyPair,
     Crypto::EncryptionKeyPair const& groupEncryptionKeyPair,
     Trustchain::TrustchainId const& trustchainId,
     Trustchain::DeviceId const& deviceId,
-    Crypto::PrivateSignatureKey const& deviceSignatureKey)
+    Crypto::PrivateSignatureKey const& deviceSignatureKey,
+    WorkerPool* workerPool)
 {
   auto const groupSize = memberUsers.size() + memberProvisionalUsers.size();
   if (groupSize == 0)
@@ -95,16 +96,16 @@ Trustchain::Actions::UserGroupCreation makeUserGroupCreationAction(
                    MAX_GROUP_SIZE);
   }
 
-  auto groupMembers = generateGroupKeysForUsers2(groupEncryptionKeyPair.privateKey, memberUsers);
-  auto groupProvisionalMembers =
-      generateGroupKeysForProvisionalUsers3(groupEncryptionKeyPair.privateKey, memberProvisionalUsers);
-  return createUserGroupCreationV3Action(groupSignatureKeyPair,
-                                         groupEncryptionKeyPair.publicKey,
-                                         groupMembers,
-                                         groupProvisionalMembers,
-                                         trustchainId,
-                                         deviceId,
-                                         deviceSignatureKey);
+  auto groupMembers = TC_AWAIT(generateGroupKeysForUsers2(workerPool, groupEncryptionKeyPair.privateKey, memberUsers));
+  auto groupProvisionalMembers = TC_AWAIT(
+      generateGroupKeysForProvisionalUsers3(workerPool, groupEncryptionKeyPair.privateKey, memberProvisionalUsers));
+  TC_RETURN(createUserGroupCreationV3Action(groupSignatureKeyPair,
+                                            groupEncryptionKeyPair.publicKey,
+                                            groupMembers,
+                                            groupProvisionalMembers,
+                                            trustchainId,
+                                            deviceId,
+                                            deviceSignatureKey));
 }
 
 tc::cotask<SGroupId> create(Users::IUserAccessor& userAccessor,
@@ -112,7 +113,8 @@ tc::cotask<SGroupId> create(Users::IUserAccessor& userAccessor,
                             std::vector<SPublicIdentity> spublicIdentities,
                             Trustchain::TrustchainId const& trustchainId,
                             Trustchain::DeviceId const& deviceId,
-                            Crypto::PrivateSignatureKey const& privateSignatureKey)
+                            Crypto::PrivateSignatureKey const& privateSignatureKey,
+                            WorkerPool* workerPool)
 {
   auto const processedIdentities = processIdentities(trustchainId, std::move(spublicIdentities));
 
@@ -121,25 +123,27 @@ tc::cotask<SGroupId> create(Users::IUserAccessor& userAccessor,
   auto const groupEncryptionKeyPair = Crypto::makeEncryptionKeyPair();
   auto const groupSignatureKeyPair = Crypto::makeSignatureKeyPair();
 
-  auto const groupEntry = makeUserGroupCreationAction(members.users,
-                                                      members.provisionalUsers,
-                                                      groupSignatureKeyPair,
-                                                      groupEncryptionKeyPair,
-                                                      trustchainId,
-                                                      deviceId,
-                                                      privateSignatureKey);
+  auto const groupEntry = TC_AWAIT(makeUserGroupCreationAction(members.users,
+                                                               members.provisionalUsers,
+                                                               groupSignatureKeyPair,
+                                                               groupEncryptionKeyPair,
+                                                               trustchainId,
+                                                               deviceId,
+                                                               privateSignatureKey,
+                                                               workerPool));
 
   TC_AWAIT(requester.createGroup(groupEntry));
   TC_RETURN(mgs::base64::encode(groupSignatureKeyPair.publicKey));
 }
 
-Trustchain::Actions::UserGroupAddition makeUserGroupAdditionAction(
+tc::cotask<Trustchain::Actions::UserGroupAddition> makeUserGroupAdditionAction(
     std::vector<Users::User> const& memberUsers,
     std::vector<ProvisionalUsers::PublicUser> const& memberProvisionalUsers,
     InternalGroup const& group,
     Trustchain::TrustchainId const& trustchainId,
     Trustchain::DeviceId const& deviceId,
-    Crypto::PrivateSignatureKey const& privateSignatureKey)
+    Crypto::PrivateSignatureKey const& privateSignatureKey,
+    WorkerPool* workerPool)
 {
   auto const groupSize = memberUsers.size() + memberProvisionalUsers.size();
   if (groupSize == 0)
@@ -154,16 +158,16 @@ Trustchain::Actions::UserGroupAddition makeUserGroupAdditionAction(
                    MAX_GROUP_SIZE);
   }
 
-  auto members = generateGroupKeysForUsers2(group.encryptionKeyPair.privateKey, memberUsers);
-  auto provisionalMembers =
-      generateGroupKeysForProvisionalUsers3(group.encryptionKeyPair.privateKey, memberProvisionalUsers);
-  return createUserGroupAdditionV3Action(group.signatureKeyPair,
-                                         group.lastBlockHash,
-                                         members,
-                                         provisionalMembers,
-                                         trustchainId,
-                                         deviceId,
-                                         privateSignatureKey);
+  auto members = TC_AWAIT(generateGroupKeysForUsers2(workerPool, group.encryptionKeyPair.privateKey, memberUsers));
+  auto provisionalMembers = TC_AWAIT(
+      generateGroupKeysForProvisionalUsers3(workerPool, group.encryptionKeyPair.privateKey, memberProvisionalUsers));
+  TC_RETURN(createUserGroupAdditionV3Action(group.signatureKeyPair,
+                                            group.lastBlockHash,
+                                            members,
+                                            provisionalMembers,
+                                            trustchainId,
+                                            deviceId,
+                                            privateSignatureKey));
 }
 
 Trustchain::Actions::UserGroupRemoval makeUserGroupRemovalAction(
@@ -215,7 +219,8 @@ createGroupEntries(Users::IUserAccessor& userAccessor,
                    Trustchain::DeviceId const& deviceId,
                    Crypto::PrivateSignatureKey const& privateSignatureKey,
                    std::vector<SPublicIdentity> spublicIdentitiesToAdd,
-                   std::vector<SPublicIdentity> spublicIdentitiesToRemove)
+                   std::vector<SPublicIdentity> spublicIdentitiesToRemove,
+                   WorkerPool* workerPool)
 {
   MembersToAdd membersToAdd;
   MembersToRemove membersToRemove;
@@ -230,8 +235,13 @@ createGroupEntries(Users::IUserAccessor& userAccessor,
   {
     membersToAdd = TC_AWAIT(fetchFutureMembers(userAccessor, processedIdentitiesToAdd));
 
-    groupAddEntry = makeUserGroupAdditionAction(
-        membersToAdd.users, membersToAdd.provisionalUsers, group, trustchainId, deviceId, privateSignatureKey);
+    groupAddEntry = TC_AWAIT(makeUserGroupAdditionAction(membersToAdd.users,
+                                                         membersToAdd.provisionalUsers,
+                                                         group,
+                                                         trustchainId,
+                                                         deviceId,
+                                                         privateSignatureKey,
+                                                         workerPool));
   }
 
   if (!processedIdentitiesToRemove.spublicIdentities.empty())
@@ -262,7 +272,8 @@ tc::cotask<void> updateMembers(Users::IUserAccessor& userAccessor,
                                std::vector<SPublicIdentity> spublicIdentitiesToRemove,
                                Trustchain::TrustchainId const& trustchainId,
                                Trustchain::DeviceId const& deviceId,
-                               Crypto::PrivateSignatureKey const& privateSignatureKey)
+                               Crypto::PrivateSignatureKey const& privateSignatureKey,
+                               WorkerPool* workerPool)
 {
   if (spublicIdentitiesToAdd.empty() && spublicIdentitiesToRemove.empty())
     throw formatEx(Errc::InvalidArgument, "no members to add or remove in updateMembers");
@@ -274,7 +285,8 @@ tc::cotask<void> updateMembers(Users::IUserAccessor& userAccessor,
                                                                              deviceId,
                                                                              privateSignatureKey,
                                                                              std::move(spublicIdentitiesToAdd),
-                                                                             std::move(spublicIdentitiesToRemove)));
+                                                                             std::move(spublicIdentitiesToRemove),
+                                                                             workerPool));
 
   if (groupRemoveEntry)
     TC_AWAIT(requester.softUpdateGroup(*groupRemoveEntry, groupAddEntry));
@@ -146,23 +146,36 @@ Store::Store(Crypto::SymmetricKey const& userSecret, DataStore::DataStore* db) :
 
 tc::cotask<void> Store::put(Group const& group)
 {
-  FUNC_TIMER(DB);
-  auto const groupId = getGroupId(group);
-  TDEBUG("Adding group {}", groupId);
-
-  auto const keyBuffer = serializeStoreKey(groupId);
-  auto const valueBuffer = serializeStoreValue(group);
+  TC_AWAIT(put(gsl::make_span(&group, 1)));
+}
 
-  auto const indexKeyBuffer = serializeIndexKey(getPublicEncryptionKey(group));
-  auto const indexValueBuffer = serializeIndexValue(groupId);
+tc::cotask<void> Store::put(gsl::span<Group const> groups)
+{
+  FUNC_TIMER(DB);
+  if (groups.empty())
+    TC_RETURN();
+
+  // Two entries per group, the value and its index
+  std::vector<std::vector<uint8_t>> buffers;
+  std::vector<std::pair<gsl::span<uint8_t const>, gsl::span<uint8_t const>>> keyValues;
+  buffers.reserve(groups.size() * 4);
+  keyValues.reserve(groups.size() * 2);
+  for (auto const& group : groups)
+  {
+    auto const groupId = getGroupId(group);
+    TDEBUG("Adding group {}", groupId);
 
-  auto const encryptedValue = DataStore::encryptValue(_userSecret, valueBuffer);
+    auto const& keyBuffer = buffers.emplace_back(serializeStoreKey(groupId));
+    auto const& encryptedValue =
+        buffers.emplace_back(DataStore::encryptValue(*_db, _userSecret, serializeStoreValue(group)));
+    keyValues.emplace_back(keyBuffer, encryptedValue);
 
-  std::vector<std::pair<gsl::span<uint8_t const>, gsl::span<uint8_t const>>> keyValues{
-      {keyBuffer, encryptedValue}, {indexKeyBuffer, indexValueBuffer}};
+    auto const& indexKeyBuffer = buffers.emplace_back(serializeIndexKey(getPublicEncryptionKey(group)));
+    auto const& indexValueBuffer = buffers.emplace_back(serializeIndexValue(groupId));
+    keyValues.emplace_back(indexKeyBuffer, indexValueBuffer);
+  }
 
-  _db->putCacheValues(keyValues, DataStore::OnConflict::Replace);
-  TC_RETURN();
+  TC_AWAIT(_db->putCacheValues(keyValues, DataStore::OnConflict::Replace));
 }
 
 tc::cotask<std::optional<Group>> Store::findById(GroupId const& groupId) const
@@ -173,11 +186,11 @@ tc::cotask<std::optional<Group>> Store::findById(GroupId const& groupId) const
   {
     auto const keyBuffer = serializeStoreKey(groupId);
     auto const keys = {gsl::make_span(keyBuffer)};
-    auto const result = _db->findCacheValues(keys);
+    auto const result = TC_AWAIT(_db->findCacheValues(keys));
     if (!result.at(0))
       TC_RETURN(std::nullopt);
 
-    auto const decryptedValue = TC_AWAIT(DataStore::decryptValue(_userSecret, *result.at(0)));
+    auto const decryptedValue = TC_AWAIT(DataStore::decryptValue(*_db, _userSecret, *result.at(0)));
 
     TC_RETURN(deserializeStoreValue(decryptedValue));
   }
@@ -205,17 +218,17 @@ tc::cotask<std::optional<Group>> Store::findByPublicEncryptionKey(
   {
     auto const indexKey = serializeIndexKey(publicEncryptionKey);
     auto const indexKeys = {gsl::make_span(indexKey)};
-    auto const indexResult = _db->findCacheValues(indexKeys);
+    auto const indexResult = TC_AWAIT(_db->findCacheValues(indexKeys));
     if (!indexResult.at(0))
       TC_RETURN(std::nullopt);
 
     auto const keys = {gsl::make_span(*indexResult.at(0))};
-    auto const result = _db->findCacheValues(keys);
+    auto const result = TC_AWAIT(_db->findCacheValues(keys));
     if (!result.at(0))
       // There's an index but no entry, weird...
       TC_RETURN(std::nullopt);
 
-    auto const decryptedValue = TC_AWAIT(DataStore::decryptValue(_userSecret, *result.at(0)));
+    auto const decryptedValue = TC_AWAIT(DataStore::decryptValue(*_db, _userSecret, *result.at(0)));
 
     TC_RETURN(deserializeStoreValue(decryptedValue));
   }
@@ -224,4 +237,9 @@ tc::cotask<std::optional<Group>> Store::findByPublicEncryptionKey(
     DataStore::handleError(e);
   }
 }
+
+tc::cotask<DataStore::CacheUsage> Store::cacheUsage() const
+{
+  TC_RETURN(TC_AWAIT(_db->findCacheUsage(gsl::make_span(KeyPrefix).as_span<uint8_t const>())));
+}
 }
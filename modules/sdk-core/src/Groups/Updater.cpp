@@ -1,5 +1,6 @@
 #include <Tanker/Groups/Updater.hpp>
 
+#include <Tanker/Actions/Deduplicate.hpp>
 #include <Tanker/Crypto/Crypto.hpp>
 #include <Tanker/Crypto/Format/Format.hpp>
 #include <Tanker/Errors/AssertionError.hpp>
@@ -20,8 +21,6 @@
 #include <boost/container/flat_set.hpp>
 #include <range/v3/algorithm/find.hpp>
 #include <range/v3/algorithm/find_if.hpp>
-#include <range/v3/range/conversion.hpp>
-#include <range/v3/view/transform.hpp>
 
 TLOG_CATEGORY(GroupUpdater);
 
@@ -281,6 +280,48 @@ private:
   std::optional<Group> mutable _group;
 };
 
+// Pulls the local user at most once, so that the user keys of all the groups
+// of a batch are resolved with a single request
+class SinglePullLocalUserAccessor : public Users::ILocalUserAccessor
+{
+public:
+  explicit SinglePullLocalUserAccessor(Users::ILocalUserAccessor* localUserAccessor)
+    : _localUserAccessor(localUserAccessor)
+  {
+  }
+
+  Users::LocalUser const& get() const override
+  {
+    return _localUserAccessor->get();
+  }
+
+  tc::cotask<Users::LocalUser const&> pull() override
+  {
+    if (_pulled)
+      TC_RETURN(get());
+    auto const& localUser = TC_AWAIT(_localUserAccessor->pull());
+    _pulled = true;
+    TC_RETURN(localUser);
+  }
+
+  tc::cotask<std::optional<Crypto::EncryptionKeyPair>> pullUserKeyPair(
+      Crypto::PublicEncryptionKey const& publicUserKey) override
+  {
+    auto const isKnown = get().findKeyPair(publicUserKey).has_value();
+    if (!isKnown && _pulled)
+      TC_RETURN(std::nullopt);
+    auto const userKeyPair = TC_AWAIT(_localUserAccessor->pullUserKeyPair(publicUserKey));
+    // An unknown key makes the accessor pull the local user
+    if (!isKnown)
+      _pulled = true;
+    TC_RETURN(userKeyPair);
+  }
+
+private:
+  Users::ILocalUserAccessor* _localUserAccessor;
+  bool _pulled = false;
+};
+
 tc::cotask<std::optional<Group>> processGroupEntriesWithAuthors(std::vector<Users::Device> const& authors,
                                                                 Users::ILocalUserAccessor& localUserAccessor,
                                                                 ProvisionalUsers::IAccessor& provisionalUsersAccessor,
@@ -303,10 +344,27 @@ tc::cotask<std::optional<Group>> processGroupEntries(Users::ILocalUserAccessor&
                                                      std::optional<Group> const& previousGroup,
                                                      gsl::span<Trustchain::GroupAction const> entries)
 {
-  auto authorIds =
-      entries |
-      ranges::views::transform([](auto const& action) { return Trustchain::DeviceId{Trustchain::getAuthor(action)}; }) |
-      ranges::to<std::vector>;
+  std::vector<GroupEntries> const groups{{previousGroup, entries}};
+  auto processedGroups =
+      TC_AWAIT(processGroupsEntries(localUserAccessor, userAccessor, provisionalUsersAccessor, groups));
+  TC_RETURN(std::move(processedGroups.front()));
+}
+
+tc::cotask<std::vector<std::optional<Group>>> processGroupsEntries(
+    Users::ILocalUserAccessor& localUserAccessor,
+    Users::IUserAccessor& userAccessor,
+    ProvisionalUsers::IAccessor& provisionalUsersAccessor,
+    gsl::span<GroupEntries const> groups)
+{
+  if (groups.empty())
+    TC_RETURN(std::vector<std::optional<Group>>{});
+
+  // The groups often share their authors
+  std::vector<Trustchain::DeviceId> authorIds;
+  for (auto const& group : groups)
+    for (auto const& action : group.entries)
+      authorIds.push_back(Trustchain::DeviceId{Trustchain::getAuthor(action)});
+  authorIds |= Actions::deduplicate;
   auto const devices = TC_AWAIT(userAccessor.pull(std::move(authorIds)));
 
   // We are going to process group entries in which there are provisional
@@ -315,7 +373,16 @@ tc::cotask<std::optional<Group>> processGroupEntries(Users::ILocalUserAccessor&
   // provisional identities so that we can find if they are in the group or
   // not.
   TC_AWAIT(provisionalUsersAccessor.refreshKeys());
-  TC_RETURN(TC_AWAIT(processGroupEntriesWithAuthors(
-      devices.found, localUserAccessor, provisionalUsersAccessor, previousGroup, entries)));
+
+  // The blocks were fetched before the first pull, so one pull is enough to
+  // know all the user keys they were sealed for
+  SinglePullLocalUserAccessor batchLocalUserAccessor(&localUserAccessor);
+
+  std::vector<std::optional<Group>> ret;
+  ret.reserve(groups.size());
+  for (auto const& group : groups)
+    ret.push_back(TC_AWAIT(processGroupEntriesWithAuthors(
+        devices.found, batchLocalUserAccessor, provisionalUsersAccessor, group.previousGroup, group.entries)));
+  TC_RETURN(ret);
 }
 }
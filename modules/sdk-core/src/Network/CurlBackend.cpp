@@ -11,11 +11,23 @@ namespace Tanker::Network
 {
 namespace
 {
-std::shared_ptr<tcurl::request> makeRequest(SdkInfo sdkInfo, HttpRequest const& req)
+std::shared_ptr<tcurl::request> makeRequest(CurlBackendOptions const& options, HttpRequest const& req)
 {
   auto creq = std::make_shared<tcurl::request>();
   creq->set_url(std::move(req.url));
 
+  curl_easy_setopt(creq->get_curl(), CURLOPT_TIMEOUT_MS, long(options.timeout.count()));
+  curl_easy_setopt(creq->get_curl(), CURLOPT_CONNECTTIMEOUT_MS, long(options.connectTimeout.count()));
+  curl_easy_setopt(creq->get_curl(), CURLOPT_TCP_KEEPALIVE, 1L);
+  curl_easy_setopt(creq->get_curl(), CURLOPT_TCP_KEEPIDLE, long(options.keepAliveIdle.count()));
+  curl_easy_setopt(creq->get_curl(), CURLOPT_TCP_KEEPINTVL, long(options.keepAliveInterval.count()));
+  if (options.http2)
+  {
+    curl_easy_setopt(creq->get_curl(), CURLOPT_HTTP_VERSION, long(CURL_HTTP_VERSION_2TLS));
+    // Wait for a connection that can be multiplexed rather than opening a new one
+    curl_easy_setopt(creq->get_curl(), CURLOPT_PIPEWAIT, 1L);
+  }
+
   switch (req.method)
   {
   case HttpMethod::Get:
@@ -50,15 +62,21 @@ std::shared_ptr<tcurl::request> makeRequest(SdkInfo sdkInfo, HttpRequest const&
 }
 }
 
-CurlBackend::CurlBackend(SdkInfo sdkInfo, std::chrono::nanoseconds timeout) : _sdkInfo(std::move(sdkInfo))
+CurlBackend::CurlBackend(SdkInfo sdkInfo, CurlBackendOptions options)
+  : _sdkInfo(std::move(sdkInfo)), _options(std::move(options))
 {
+  // The connection cache belongs to the multi handle, so connections (and
+  // their TLS sessions) outlive the requests and the sessions of the Core
+  curl_multi_setopt(_cl.get_multi(), CURLMOPT_MAXCONNECTS, _options.maxIdleConnections);
+  curl_multi_setopt(
+      _cl.get_multi(), CURLMOPT_PIPELINING, _options.http2 ? long(CURLPIPE_MULTIPLEX) : long(CURLPIPE_NOTHING));
 }
 
 tc::cotask<HttpResponse> CurlBackend::fetch(HttpRequest req)
 {
   try
   {
-    auto creq = makeRequest(_sdkInfo, req);
+    auto creq = makeRequest(_options, req);
     auto const cres = TC_AWAIT(tcurl::read_all(_cl, creq));
 
     HttpResponse res;
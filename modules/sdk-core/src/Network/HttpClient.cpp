@@ -143,9 +143,19 @@ std::error_code make_error_code(HttpError const& e)
       e.ec, "HTTP error occurred: {} {}: {} {}, traceID: {}", e.method, e.href, e.status, e.message, e.traceId);
 }
 
-HttpClient::HttpClient(std::string baseUrl, std::string instanceId, Backend* backend, SdkInfo const& info)
-  : _baseUrl(std::move(baseUrl)), _instanceId(std::move(instanceId)), _backend(backend), _info(info)
+HttpClient::HttpClient(std::string baseUrl,
+                       std::string instanceId,
+                       Backend* backend,
+                       SdkInfo const& info,
+                       std::size_t concurrentRequestCount)
+  : _baseUrl(std::move(baseUrl)),
+    _instanceId(std::move(instanceId)),
+    _backend(backend),
+    _semaphore(concurrentRequestCount),
+    _info(info)
 {
+  if (concurrentRequestCount == 0)
+    throw Errors::AssertionError("HttpClient needs at least one concurrent request");
   if (!_baseUrl.empty() && _baseUrl.back() != '/')
     _baseUrl += '/';
 }
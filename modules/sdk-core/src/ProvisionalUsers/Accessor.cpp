@@ -8,6 +8,8 @@
 #include <Tanker/Users/ILocalUserAccessor.hpp>
 #include <Tanker/Users/LocalUser.hpp>
 
+#include <range/v3/algorithm/find_if.hpp>
+
 TLOG_CATEGORY("ProvisionalUsersAccessor");
 
 using Tanker::Trustchain::GroupId;
@@ -40,18 +42,67 @@ tc::cotask<std::optional<ProvisionalUserKeys>> Accessor::pullEncryptionKeys(
     TC_RETURN(*keys);
 
   TC_AWAIT(refreshKeys());
+  if (auto const refreshedKeys =
+          TC_AWAIT(_provisionalUserKeysStore->findProvisionalUserKeys(appPublicSigKey, tankerPublicSigKey)))
+    TC_RETURN(*refreshedKeys);
 
+  // The last claim hash does not prove that the keys of the claims before it
+  // are still stored
+  TC_AWAIT(refreshAllKeys());
   TC_RETURN(TC_AWAIT(_provisionalUserKeysStore->findProvisionalUserKeys(appPublicSigKey, tankerPublicSigKey)));
 }
 
+gsl::span<Trustchain::Actions::ProvisionalIdentityClaim const> Accessor::claimsAfter(
+    gsl::span<Trustchain::Actions::ProvisionalIdentityClaim const> claims,
+    std::optional<Crypto::Hash> const& lastClaimHash)
+{
+  if (!lastClaimHash)
+    return claims;
+  auto const lastIt = ranges::find_if(claims, [&](auto const& claim) { return claim.hash() == *lastClaimHash; });
+  if (lastIt == claims.end())
+    return claims;
+  return claims.subspan(std::distance(claims.begin(), lastIt) + 1);
+}
+
 tc::cotask<void> Accessor::refreshKeys()
 {
+  auto const userId = _localUserAccessor->get().userId();
+  TC_AWAIT(_refreshCoalescer.run(
+      [&](std::vector<Trustchain::UserId> const&) -> tc::cotask<std::vector<RefreshResult>> {
+        TC_AWAIT(refreshKeysImpl(false));
+        TC_RETURN(std::vector{RefreshResult{userId}});
+      },
+      gsl::make_span(&userId, 1)));
+}
+
+tc::cotask<void> Accessor::refreshAllKeys()
+{
+  auto const userId = _localUserAccessor->get().userId();
+  TC_AWAIT(_fullRefreshCoalescer.run(
+      [&](std::vector<Trustchain::UserId> const&) -> tc::cotask<std::vector<RefreshResult>> {
+        TC_AWAIT(refreshKeysImpl(true));
+        TC_RETURN(std::vector{RefreshResult{userId}});
+      },
+      gsl::make_span(&userId, 1)));
+}
+
+tc::cotask<void> Accessor::refreshKeysImpl(bool allClaims)
+{
+  // The server always sends all the claims
   auto const blocks = TC_AWAIT(_requester->getClaimBlocks(_localUserAccessor->get().userId()));
-  auto const toStore = TC_AWAIT(Updater::processClaimEntries(*_localUserAccessor, *_userAccessor, blocks));
+  auto newBlocks = gsl::span<Trustchain::Actions::ProvisionalIdentityClaim const>(blocks);
+  if (!allClaims)
+    newBlocks = claimsAfter(blocks, TC_AWAIT(_provisionalUserKeysStore->findLastClaimHash()));
+  if (newBlocks.empty())
+    TC_RETURN();
+
+  auto const toStore = TC_AWAIT(Updater::processClaimEntries(*_localUserAccessor, *_userAccessor, newBlocks));
 
   for (auto const& [appSignaturePublicKey, tankerSignaturePublicKey, appEncryptionKeyPair, tankerEncryptionKeyPair] :
        toStore)
     TC_AWAIT(_provisionalUserKeysStore->putProvisionalUserKeys(
         appSignaturePublicKey, tankerSignaturePublicKey, {appEncryptionKeyPair, tankerEncryptionKeyPair}));
+  // Only once all the keys are stored, a failure above retries all the claims
+  TC_AWAIT(_provisionalUserKeysStore->putLastClaimHash(newBlocks.back().hash()));
 }
 }
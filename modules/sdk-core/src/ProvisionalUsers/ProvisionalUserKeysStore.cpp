@@ -18,6 +18,7 @@ namespace
 // None
 std::string const KeyPrefix = "provisionaluserkeys-";
 std::string const IndexPrefix = "provisionaluserkeys-index-";
+std::string const LastClaimHashKey = "provisionalclaims-lasthash";
 
 std::vector<uint8_t> serializeStoreKey(Crypto::PublicSignatureKey const& appPublicSignatureKey,
                                        Crypto::PublicSignatureKey const& tankerPublicSignatureKey)
@@ -96,13 +97,12 @@ tc::cotask<void> ProvisionalUserKeysStore::putProvisionalUserKeys(Crypto::Public
   auto const indexKeyBuffer = serializeIndexKey(appPublicSigKey);
   auto const indexValueBuffer = serializeIndexValue(appPublicSigKey, tankerPublicSigKey);
 
-  auto const encryptedValue = DataStore::encryptValue(_userSecret, valueBuffer);
+  auto const encryptedValue = DataStore::encryptValue(*_db, _userSecret, valueBuffer);
 
   std::vector<std::pair<gsl::span<uint8_t const>, gsl::span<uint8_t const>>> keyValues{
       {keyBuffer, encryptedValue}, {indexKeyBuffer, indexValueBuffer}};
 
-  _db->putCacheValues(keyValues, DataStore::OnConflict::Ignore);
-  TC_RETURN();
+  TC_AWAIT(_db->putCacheValues(keyValues, DataStore::OnConflict::Ignore));
 }
 
 tc::cotask<std::optional<ProvisionalUserKeys>> ProvisionalUserKeysStore::findProvisionalUserKeys(
@@ -114,11 +114,11 @@ tc::cotask<std::optional<ProvisionalUserKeys>> ProvisionalUserKeysStore::findPro
   {
     auto const keyBuffer = serializeStoreKey(appPublicSigKey, tankerPublicSigKey);
     auto const keys = {gsl::make_span(keyBuffer)};
-    auto const result = _db->findCacheValues(keys);
+    auto const result = TC_AWAIT(_db->findCacheValues(keys));
     if (!result.at(0))
       TC_RETURN(std::nullopt);
 
-    auto const decryptedValue = TC_AWAIT(DataStore::decryptValue(_userSecret, *result.at(0)));
+    auto const decryptedValue = TC_AWAIT(DataStore::decryptValue(*_db, _userSecret, *result.at(0)));
 
     TC_RETURN(deserializeStoreValue(decryptedValue));
   }
@@ -138,17 +138,17 @@ ProvisionalUserKeysStore::findProvisionalUserKeysByAppPublicSignatureKey(
   {
     auto const indexKey = serializeIndexKey(appPublicSignatureKey);
     auto const indexKeys = {gsl::make_span(indexKey)};
-    auto const indexResult = _db->findCacheValues(indexKeys);
+    auto const indexResult = TC_AWAIT(_db->findCacheValues(indexKeys));
     if (!indexResult.at(0))
       TC_RETURN(std::nullopt);
 
     auto const keys = {gsl::make_span(*indexResult.at(0))};
-    auto const result = _db->findCacheValues(keys);
+    auto const result = TC_AWAIT(_db->findCacheValues(keys));
     if (!result.at(0))
       // There's an index but no entry, weird...
       TC_RETURN(std::nullopt);
 
-    auto const decryptedValue = TC_AWAIT(DataStore::decryptValue(_userSecret, *result.at(0)));
+    auto const decryptedValue = TC_AWAIT(DataStore::decryptValue(*_db, _userSecret, *result.at(0)));
 
     TC_RETURN(deserializeStoreValue(decryptedValue));
   }
@@ -157,4 +157,40 @@ ProvisionalUserKeysStore::findProvisionalUserKeysByAppPublicSignatureKey(
     DataStore::handleError(e);
   }
 }
+
+tc::cotask<void> ProvisionalUserKeysStore::putLastClaimHash(Crypto::Hash const& hash)
+{
+  FUNC_TIMER(DB);
+  auto const key = gsl::make_span(LastClaimHashKey).as_span<uint8_t const>();
+  auto const encryptedValue = DataStore::encryptValue(*_db, _userSecret, hash);
+
+  std::vector<std::pair<gsl::span<uint8_t const>, gsl::span<uint8_t const>>> keyValues{{key, encryptedValue}};
+
+  TC_AWAIT(_db->putCacheValues(keyValues, DataStore::OnConflict::Replace));
+}
+
+tc::cotask<std::optional<Crypto::Hash>> ProvisionalUserKeysStore::findLastClaimHash() const
+{
+  FUNC_TIMER(DB);
+
+  try
+  {
+    auto const keys = {gsl::make_span(LastClaimHashKey).as_span<uint8_t const>()};
+    auto const result = TC_AWAIT(_db->findCacheValues(keys));
+    if (!result.at(0))
+      TC_RETURN(std::nullopt);
+
+    auto const decryptedValue = TC_AWAIT(DataStore::decryptValue(*_db, _userSecret, *result.at(0)));
+    TC_RETURN(Serialization::deserialize<Crypto::Hash>(decryptedValue));
+  }
+  catch (Errors::Exception const& e)
+  {
+    DataStore::handleError(e);
+  }
+}
+
+tc::cotask<DataStore::CacheUsage> ProvisionalUserKeysStore::cacheUsage() const
+{
+  TC_RETURN(TC_AWAIT(_db->findCacheUsage(gsl::make_span(KeyPrefix).as_span<uint8_t const>())));
+}
 }
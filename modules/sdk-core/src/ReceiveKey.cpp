@@ -25,11 +25,10 @@ namespace ReceiveKey
 {
 namespace
 {
-tc::cotask<ResourceKeys::KeyResult> decryptAndStoreKey(ResourceKeys::Store& resourceKeyStore,
-                                                       Users::ILocalUserAccessor& localUserAccessor,
-                                                       Groups::IAccessor&,
-                                                       ProvisionalUsers::IAccessor&,
-                                                       Trustchain::Actions::KeyPublishToUser const& keyPublishToUser)
+tc::cotask<ResourceKeys::KeyResult> decryptKey(Users::ILocalUserAccessor& localUserAccessor,
+                                               Groups::IAccessor&,
+                                               ProvisionalUsers::IAccessor&,
+                                               Trustchain::Actions::KeyPublishToUser const& keyPublishToUser)
 {
   auto const& recipientPublicKey = keyPublishToUser.recipientPublicEncryptionKey();
   auto const userKeyPair = TC_AWAIT(localUserAccessor.pullUserKeyPair(recipientPublicKey));
@@ -42,17 +41,13 @@ tc::cotask<ResourceKeys::KeyResult> decryptAndStoreKey(ResourceKeys::Store& reso
 
   auto const key = Crypto::sealDecrypt(keyPublishToUser.sealedSymmetricKey(), *userKeyPair);
 
-  TC_AWAIT(resourceKeyStore.putKey(keyPublishToUser.resourceId(), key));
-
   TC_RETURN((ResourceKeys::KeyResult{key, keyPublishToUser.resourceId()}));
 }
 
-tc::cotask<ResourceKeys::KeyResult> decryptAndStoreKey(
-    ResourceKeys::Store& resourceKeyStore,
-    Users::ILocalUserAccessor&,
-    Groups::IAccessor& groupAccessor,
-    ProvisionalUsers::IAccessor&,
-    Trustchain::Actions::KeyPublishToUserGroup const& keyPublishToUserGroup)
+tc::cotask<ResourceKeys::KeyResult> decryptKey(Users::ILocalUserAccessor&,
+                                               Groups::IAccessor& groupAccessor,
+                                               ProvisionalUsers::IAccessor&,
+                                               Trustchain::Actions::KeyPublishToUserGroup const& keyPublishToUserGroup)
 {
   auto const& recipientPublicKey = keyPublishToUserGroup.recipientPublicEncryptionKey();
   auto const encryptionKeyPair = TC_AWAIT(groupAccessor.getEncryptionKeyPair(recipientPublicKey));
@@ -67,16 +62,13 @@ tc::cotask<ResourceKeys::KeyResult> decryptAndStoreKey(
 
   auto const key = Crypto::sealDecrypt(keyPublishToUserGroup.sealedSymmetricKey(), *encryptionKeyPair);
 
-  TC_AWAIT(resourceKeyStore.putKey(keyPublishToUserGroup.resourceId(), key));
-
   TC_RETURN((ResourceKeys::KeyResult{key, keyPublishToUserGroup.resourceId()}));
 }
 
-tc::cotask<ResourceKeys::KeyResult> decryptAndStoreKey(ResourceKeys::Store& resourceKeyStore,
-                                                       Users::ILocalUserAccessor&,
-                                                       Groups::IAccessor&,
-                                                       ProvisionalUsers::IAccessor& provisionalUsersAccessor,
-                                                       KeyPublishToProvisionalUser const& keyPublishToProvisionalUser)
+tc::cotask<ResourceKeys::KeyResult> decryptKey(Users::ILocalUserAccessor&,
+                                               Groups::IAccessor&,
+                                               ProvisionalUsers::IAccessor& provisionalUsersAccessor,
+                                               KeyPublishToProvisionalUser const& keyPublishToProvisionalUser)
 {
   auto const provisionalUserKeys = TC_AWAIT(provisionalUsersAccessor.pullEncryptionKeys(
       keyPublishToProvisionalUser.appPublicSignatureKey(), keyPublishToProvisionalUser.tankerPublicSignatureKey()));
@@ -94,22 +86,43 @@ tc::cotask<ResourceKeys::KeyResult> decryptAndStoreKey(ResourceKeys::Store& reso
       Crypto::sealDecrypt(keyPublishToProvisionalUser.twoTimesSealedSymmetricKey(), provisionalUserKeys->tankerKeys);
   auto const key = Crypto::sealDecrypt(encryptedKey, provisionalUserKeys->appKeys);
 
-  TC_AWAIT(resourceKeyStore.putKey(keyPublishToProvisionalUser.resourceId(), key));
-
   TC_RETURN((ResourceKeys::KeyResult{key, keyPublishToProvisionalUser.resourceId()}));
 }
 }
 
+tc::cotask<ResourceKeys::KeyResult> decryptKey(Users::ILocalUserAccessor& localUserAccessor,
+                                               Groups::IAccessor& groupAccessor,
+                                               ProvisionalUsers::IAccessor& provisionalUsersAccessor,
+                                               KeyPublish const& kp)
+{
+  TC_RETURN(TC_AWAIT(kp.visit([&](auto const& val) -> tc::cotask<ResourceKeys::KeyResult> {
+    TC_RETURN(TC_AWAIT(decryptKey(localUserAccessor, groupAccessor, provisionalUsersAccessor, val)));
+  })));
+}
+
 tc::cotask<ResourceKeys::KeyResult> decryptAndStoreKey(ResourceKeys::Store& resourceKeyStore,
                                                        Users::ILocalUserAccessor& localUserAccessor,
                                                        Groups::IAccessor& groupAccessor,
                                                        ProvisionalUsers::IAccessor& provisionalUsersAccessor,
                                                        KeyPublish const& kp)
 {
-  TC_RETURN(TC_AWAIT(kp.visit([&](auto const& val) -> tc::cotask<ResourceKeys::KeyResult> {
-    TC_RETURN(TC_AWAIT(
-        decryptAndStoreKey(resourceKeyStore, localUserAccessor, groupAccessor, provisionalUsersAccessor, val)));
-  })));
+  auto const result = TC_AWAIT(decryptKey(localUserAccessor, groupAccessor, provisionalUsersAccessor, kp));
+  TC_AWAIT(resourceKeyStore.putKey(result.id, result.key));
+  TC_RETURN(result);
+}
+
+tc::cotask<ResourceKeys::KeysResult> decryptAndStoreKeys(ResourceKeys::Store& resourceKeyStore,
+                                                         Users::ILocalUserAccessor& localUserAccessor,
+                                                         Groups::IAccessor& groupAccessor,
+                                                         ProvisionalUsers::IAccessor& provisionalUsersAccessor,
+                                                         gsl::span<Trustchain::KeyPublishAction const> kps)
+{
+  ResourceKeys::KeysResult results;
+  results.reserve(kps.size());
+  for (auto const& kp : kps)
+    results.push_back(TC_AWAIT(decryptKey(localUserAccessor, groupAccessor, provisionalUsersAccessor, kp)));
+  TC_AWAIT(resourceKeyStore.putKeys(results));
+  TC_RETURN(std::move(results));
 }
 }
 }
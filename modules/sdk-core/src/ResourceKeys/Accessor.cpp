@@ -1,3 +1,4 @@
+#include <Tanker/Crypto/Crypto.hpp>
 #include <Tanker/Crypto/Format/Format.hpp>
 #include <Tanker/Log/Log.hpp>
 #include <Tanker/ReceiveKey.hpp>
@@ -22,15 +23,27 @@ Accessor::Accessor(Users::IRequester* requester,
                    Users::ILocalUserAccessor* localUserAccessor,
                    Groups::IAccessor* groupAccessor,
                    ProvisionalUsers::IAccessor* provisionalUsersAccessor,
-                   Store* resourceKeyStore)
+                   Store* resourceKeyStore,
+                   std::size_t keyCacheCapacity)
   : _requester(requester),
     _localUserAccessor(localUserAccessor),
     _groupAccessor(groupAccessor),
     _provisionalUsersAccessor(provisionalUsersAccessor),
-    _resourceKeyStore(resourceKeyStore)
+    _resourceKeyStore(resourceKeyStore),
+    _keys(keyCacheCapacity, [](Crypto::SymmetricKey& key) { Crypto::secureZero(key); })
 {
 }
 
+CacheStats const& Accessor::keyCacheStats() const
+{
+  return _keys.stats();
+}
+
+void Accessor::clearKeyCache()
+{
+  _keys.clear();
+}
+
 tc::cotask<std::optional<Crypto::SymmetricKey>> Accessor::findKey(Crypto::SimpleResourceId const& resourceId)
 {
   try
@@ -48,28 +61,23 @@ tc::cotask<std::optional<Crypto::SymmetricKey>> Accessor::findKey(Crypto::Simple
 
 tc::cotask<KeysResult> Accessor::findOrFetchKeys(gsl::span<Crypto::SimpleResourceId const> resourceIds)
 {
-  KeysResult out;
-  std::vector<Crypto::SimpleResourceId> notFound;
+  auto out = TC_AWAIT(_resourceKeyStore->findKeys(resourceIds));
 
-  for (auto const& resourceId : resourceIds)
+  std::vector<Crypto::SimpleResourceId> notFound;
+  if (out.size() != resourceIds.size())
   {
-    auto const key = TC_AWAIT(_resourceKeyStore->findKey(resourceId));
-    if (key)
-      out.push_back({*key, resourceId});
-    else
-      notFound.push_back(resourceId);
+    auto const found = out | ranges::views::transform(&KeyResult::id) | ranges::to<std::vector> | ranges::actions::sort;
+    auto const requested = resourceIds | ranges::to<std::vector> | ranges::actions::sort;
+    notFound = ranges::views::set_difference(requested, found) | ranges::to<std::vector>;
   }
 
   if (!notFound.empty())
   {
     auto const entries = TC_AWAIT(_requester->getKeyPublishes(notFound));
-    for (auto const& action : entries)
-    {
-      auto const result = TC_AWAIT(ReceiveKey::decryptAndStoreKey(
-          *_resourceKeyStore, *_localUserAccessor, *_groupAccessor, *_provisionalUsersAccessor, action));
-
-      out.push_back(result);
-    }
+    // Store all the received keys at once, rather than one by one
+    auto const results = TC_AWAIT(ReceiveKey::decryptAndStoreKeys(
+        *_resourceKeyStore, *_localUserAccessor, *_groupAccessor, *_provisionalUsersAccessor, entries));
+    out.insert(out.end(), results.begin(), results.end());
   }
   TC_RETURN(std::move(out));
 }
@@ -84,11 +92,36 @@ tc::cotask<KeysResult> Accessor::findOrFetchKeys(gsl::span<Crypto::SimpleResourc
   throw formatEx(Errors::Errc::InvalidArgument, "can't find keys for resource IDs: {:s}", fmt::join(missing, ", "));
 }
 
+tc::cotask<KeysResult> Accessor::getKeys(std::vector<Crypto::SimpleResourceId> const& resourceIds)
+{
+  KeysResult out;
+  std::vector<Crypto::SimpleResourceId> notCached;
+  for (auto const& resourceId : resourceIds)
+  {
+    if (auto const key = _keys.get(resourceId))
+      out.push_back({*key, resourceId});
+    else
+      notCached.push_back(resourceId);
+  }
+  if (notCached.empty())
+    TC_RETURN(std::move(out));
+
+  auto const fetched = TC_AWAIT(_cache.run(
+      [&](std::vector<Crypto::SimpleResourceId> const& keys) -> tc::cotask<KeysResult> {
+        TC_RETURN(TC_AWAIT(findOrFetchKeys(keys)));
+      },
+      notCached));
+  for (auto const& keyResult : fetched)
+  {
+    _keys.put(keyResult.id, keyResult.key);
+    out.push_back(keyResult);
+  }
+  TC_RETURN(std::move(out));
+}
+
 tc::cotask<KeysResult> Accessor::findKeys(std::vector<Crypto::SimpleResourceId> const& resourceIds)
 {
-  auto keys = TC_AWAIT(_cache.run([&](std::vector<Crypto::SimpleResourceId> const& keys)
-                                      -> tc::cotask<KeysResult> { TC_RETURN(TC_AWAIT(findOrFetchKeys(keys))); },
-                                  resourceIds));
+  auto keys = TC_AWAIT(getKeys(resourceIds));
 
   if (keys.size() != resourceIds.size())
     throwForMissingKeys(resourceIds, keys);
@@ -99,9 +132,7 @@ tc::cotask<KeysResult> Accessor::findKeys(std::vector<Crypto::SimpleResourceId>
 tc::cotask<flat_map<Crypto::SimpleResourceId, Crypto::SymmetricKey>> Accessor::tryFindKeys(
     std::vector<Crypto::SimpleResourceId> const& resourceIds)
 {
-  auto keysVec = TC_AWAIT(_cache.run([&](std::vector<Crypto::SimpleResourceId> const& keys)
-                                         -> tc::cotask<KeysResult> { TC_RETURN(TC_AWAIT(findOrFetchKeys(keys))); },
-                                     resourceIds));
+  auto keysVec = TC_AWAIT(getKeys(resourceIds));
 
   auto keys =
       keysVec |
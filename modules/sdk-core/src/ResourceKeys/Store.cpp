@@ -2,6 +2,7 @@
 
 #include <Tanker/Crypto/Format/Format.hpp>
 #include <Tanker/Crypto/SimpleResourceId.hpp>
+#include <Tanker/DataStore/Errors/Errc.hpp>
 #include <Tanker/DataStore/Utils.hpp>
 #include <Tanker/Encryptor/v2.hpp>
 #include <Tanker/Errors/Errc.hpp>
@@ -10,6 +11,11 @@
 #include <Tanker/Serialization/Serialization.hpp>
 #include <Tanker/Tracer/ScopeTimer.hpp>
 
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/transform.hpp>
+#include <tconcurrent/async.hpp>
+#include <tconcurrent/async_wait.hpp>
+
 TLOG_CATEGORY(ResourceKeys::Store);
 
 using Tanker::Crypto::SimpleResourceId;
@@ -22,9 +28,11 @@ namespace
 // None
 std::string const KeyPrefix = "resourcekey-";
 
+auto const StoreKeySize = KeyPrefix.size() + SimpleResourceId::arraySize;
+
 std::vector<uint8_t> serializeStoreKey(SimpleResourceId const& resourceId)
 {
-  std::vector<uint8_t> keyBuffer(KeyPrefix.size() + resourceId.size());
+  std::vector<uint8_t> keyBuffer(StoreKeySize);
   auto it = keyBuffer.data();
   it = std::copy(KeyPrefix.begin(), KeyPrefix.end(), it);
   it = Serialization::serialize(it, resourceId);
@@ -37,19 +45,118 @@ Store::Store(Crypto::SymmetricKey const& userSecret, DataStore::DataStore* db) :
 {
 }
 
+Store::~Store()
+{
+  // Owners flush() before destroying the store. Otherwise, the keys that were
+  // not flushed are only lost from the cache
+  if (_delayedFlush)
+    _delayedFlush->request_cancel();
+}
+
 tc::cotask<void> Store::putKey(SimpleResourceId const& resourceId, Crypto::SymmetricKey const& key)
 {
   TDEBUG("Adding key for {}", resourceId);
+  KeyResult const keyResult{key, resourceId};
+  TC_AWAIT(putKeys(gsl::make_span(&keyResult, 1)));
+}
+
+tc::cotask<void> Store::putKeys(gsl::span<KeyResult const> keys)
+{
+  if (!_writeBehind)
+  {
+    TC_AWAIT(writeKeys(keys));
+    TC_RETURN();
+  }
+
+  // Like the database, keep the first key put for a resource
+  for (auto const& keyResult : keys)
+    _pendingKeys.emplace(keyResult.id, keyResult.key);
+  if (_pendingKeys.size() >= _writeBehind->maxPendingKeys)
+    TC_AWAIT(flush());
+  else if (!_pendingKeys.empty())
+    scheduleFlush();
+}
+
+tc::cotask<void> Store::writeKeys(gsl::span<KeyResult const> keys)
+{
   FUNC_TIMER(DB);
+  if (keys.empty())
+    TC_RETURN();
 
-  auto const storeRid = serializeStoreKey(resourceId);
+  std::vector<std::vector<uint8_t>> storeRids;
+  std::vector<std::vector<uint8_t>> encryptedKeys;
+  std::vector<std::pair<gsl::span<uint8_t const>, gsl::span<uint8_t const>>> keyValues;
+  storeRids.reserve(keys.size());
+  encryptedKeys.reserve(keys.size());
+  keyValues.reserve(keys.size());
+  for (auto const& keyResult : keys)
+  {
+    storeRids.push_back(serializeStoreKey(keyResult.id));
+    encryptedKeys.push_back(DataStore::encryptValue(*_db, _userSecret, keyResult.key));
+    keyValues.emplace_back(storeRids.back(), encryptedKeys.back());
+  }
 
-  auto const encryptedKey = DataStore::encryptValue(_userSecret, key);
+  TC_AWAIT(_db->putCacheValues(keyValues, DataStore::OnConflict::Ignore));
+}
 
-  std::vector<std::pair<gsl::span<uint8_t const>, gsl::span<uint8_t const>>> keyValues{{storeRid, encryptedKey}};
+void Store::setWriteBehind(std::optional<WriteBehindOptions> options)
+{
+  _writeBehind = options;
+}
 
-  _db->putCacheValues(keyValues, DataStore::OnConflict::Ignore);
-  TC_RETURN();
+tc::cotask<void> Store::flush()
+{
+  TC_AWAIT(cancelDelayedFlush());
+  TC_AWAIT(writePendingKeys());
+}
+
+tc::cotask<void> Store::cancelDelayedFlush()
+{
+  if (!_delayedFlush)
+    TC_RETURN();
+
+  auto delayedFlush = std::move(*_delayedFlush);
+  _delayedFlush.reset();
+  _flushScheduled = false;
+  delayedFlush.request_cancel();
+  // Only waits for the task to be done, being canceled is its expected outcome
+  TC_AWAIT(std::move(delayedFlush).then([](auto const&) {}));
+}
+
+tc::cotask<void> Store::writePendingKeys()
+{
+  if (_pendingKeys.empty())
+    TC_RETURN();
+
+  // The keys stay pending until they are written, so that they can still be
+  // found in the meantime
+  auto const keys = _pendingKeys | ranges::views::transform([](auto const& entry) {
+                      return KeyResult{entry.second, entry.first};
+                    }) |
+                    ranges::to<KeysResult>;
+  TC_AWAIT(writeKeys(keys));
+  for (auto const& keyResult : keys)
+    _pendingKeys.erase(keyResult.id);
+}
+
+void Store::scheduleFlush()
+{
+  if (_flushScheduled)
+    return;
+  _flushScheduled = true;
+  _delayedFlush = tc::async_resumable([this, delay = _writeBehind->maxDelay]() -> tc::cotask<void> {
+    TC_AWAIT(tc::async_wait(delay));
+    _flushScheduled = false;
+    try
+    {
+      TC_AWAIT(writePendingKeys());
+    }
+    catch (std::exception const& e)
+    {
+      // Nobody waits for this flush, they will be written by the next one
+      TERROR("Failed to write the pending resource keys: {}", e.what());
+    }
+  });
 }
 
 tc::cotask<Crypto::SymmetricKey> Store::getKey(SimpleResourceId const& resourceId) const
@@ -63,24 +170,89 @@ tc::cotask<Crypto::SymmetricKey> Store::getKey(SimpleResourceId const& resourceI
 }
 
 tc::cotask<std::optional<Crypto::SymmetricKey>> Store::findKey(SimpleResourceId const& resourceId) const
+{
+  auto const keys = TC_AWAIT(findKeys(gsl::make_span(&resourceId, 1)));
+  if (keys.empty())
+    TC_RETURN(std::nullopt);
+  TC_RETURN(keys[0].key);
+}
+
+tc::cotask<KeysResult> Store::findKeys(gsl::span<SimpleResourceId const> resourceIds) const
+{
+  if (_pendingKeys.empty())
+    TC_RETURN(TC_AWAIT(findStoredKeys(resourceIds)));
+
+  std::vector<SimpleResourceId> notPending;
+  for (auto const& resourceId : resourceIds)
+    if (_pendingKeys.find(resourceId) == _pendingKeys.end())
+      notPending.push_back(resourceId);
+  auto const storedKeys = notPending.empty() ? KeysResult{} : TC_AWAIT(findStoredKeys(notPending));
+
+  // Keep the order of resourceIds, like findStoredKeys
+  KeysResult out;
+  out.reserve(resourceIds.size());
+  auto storedIt = storedKeys.begin();
+  for (auto const& resourceId : resourceIds)
+  {
+    if (auto const pendingIt = _pendingKeys.find(resourceId); pendingIt != _pendingKeys.end())
+      out.push_back({pendingIt->second, resourceId});
+    else if (storedIt != storedKeys.end() && storedIt->id == resourceId)
+      out.push_back(*storedIt++);
+  }
+  TC_RETURN(std::move(out));
+}
+
+tc::cotask<KeysResult> Store::findStoredKeys(gsl::span<SimpleResourceId const> resourceIds) const
 {
   FUNC_TIMER(DB);
 
   try
   {
-    auto const storeRid = serializeStoreKey(resourceId);
-    auto const keys = {gsl::make_span(storeRid)};
-    auto const result = _db->findCacheValues(keys);
-    if (!result.at(0))
-      TC_RETURN(std::nullopt);
+    // All the store keys share one buffer
+    std::vector<uint8_t> storeRidsBuffer(resourceIds.size() * StoreKeySize);
+    std::vector<gsl::span<uint8_t const>> storeRids;
+    storeRids.reserve(resourceIds.size());
+    auto it = storeRidsBuffer.data();
+    for (auto const& resourceId : resourceIds)
+    {
+      auto const begin = it;
+      it = std::copy(KeyPrefix.begin(), KeyPrefix.end(), it);
+      it = Serialization::serialize(it, resourceId);
+      storeRids.emplace_back(begin, it);
+    }
+
+    auto const results = TC_AWAIT(_db->findCacheValues(storeRids));
 
-    auto const key = TC_AWAIT(DataStore::decryptValue(_userSecret, *result.at(0)));
+    auto const keyFinder = Encryptor::fixedKeyFinder(_userSecret);
+    KeysResult out;
+    out.reserve(resourceIds.size());
+    for (auto i = 0u; i < resourceIds.size(); ++i)
+    {
+      if (!results.at(i))
+        continue;
 
-    TC_RETURN(Crypto::SymmetricKey{key});
+      // Decrypt straight into the key instead of going through a vector
+      auto const& storedKey = *results[i];
+      auto const encrypted = _db->needsValueEncryption();
+      Crypto::SymmetricKey key;
+      if ((encrypted ? EncryptorV2::decryptedSize(storedKey) : storedKey.size()) != key.size())
+        throw Errors::formatEx(DataStore::Errc::DatabaseCorrupt, "invalid key size for resource {:s}", resourceIds[i]);
+      if (encrypted)
+        TC_AWAIT(EncryptorV2::decrypt(key, keyFinder, storedKey));
+      else
+        std::copy(storedKey.begin(), storedKey.end(), key.begin());
+      out.push_back({key, resourceIds[i]});
+    }
+    TC_RETURN(std::move(out));
   }
   catch (Errors::Exception const& e)
   {
     DataStore::handleError(e);
   }
 }
+
+tc::cotask<DataStore::CacheUsage> Store::cacheUsage() const
+{
+  TC_RETURN(TC_AWAIT(_db->findCacheUsage(gsl::make_span(KeyPrefix).as_span<uint8_t const>())));
+}
 }
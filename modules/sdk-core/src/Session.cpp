@@ -39,6 +39,7 @@ std::string getDbPath(std::string const& path, Trustchain::UserId const& userId)
 Session::Storage::Storage(Crypto::SymmetricKey const& userSecret, std::unique_ptr<DataStore::DataStore> pdb)
   : db(std::move(pdb)),
     localUserStore(userSecret, db.get()),
+    userStore(userSecret, db.get()),
     groupStore(userSecret, db.get()),
     resourceKeyStore(userSecret, db.get()),
     provisionalUserKeysStore(userSecret, db.get()),
@@ -49,9 +50,10 @@ Session::Storage::Storage(Crypto::SymmetricKey const& userSecret, std::unique_pt
 Session::Accessors::Accessors(Storage& storage,
                               Requesters* requesters,
                               Users::LocalUserAccessor plocalUserAccessor,
-                              TransparentSession::SessionShareCallback shareCallback)
+                              TransparentSession::SessionShareCallback shareCallback,
+                              std::optional<std::chrono::seconds> userCacheMaxAge)
   : localUserAccessor(std::move(plocalUserAccessor)),
-    userAccessor(localUserAccessor.getContext(), requesters),
+    userAccessor(localUserAccessor.getContext(), requesters, &storage.userStore, userCacheMaxAge),
     provisionalUsersAccessor(requesters, &userAccessor, &localUserAccessor, &storage.provisionalUserKeysStore),
     provisionalUsersManager(&localUserAccessor,
                             requesters,
@@ -90,6 +92,10 @@ Session::Session(std::unique_ptr<Network::HttpClient> httpClient, DataStore::Bac
 
 tc::cotask<void> Session::stop()
 {
+  if (_accessors)
+    _accessors->resourceKeyAccessor.clearKeyCache();
+  if (_storage)
+    TC_AWAIT(_storage->resourceKeyStore.flush());
   TC_AWAIT(_httpClient->deauthenticate());
 }
 
@@ -119,9 +125,9 @@ void Session::removeOldStorage(Identity::SecretPermanentIdentity const& identity
   removeStorageFile(fmt::format(FMT_STRING("{:s}/tanker-{:S}.db-journal"), dataPath, identity.delegation.userId));
 }
 
-void Session::openStorage(Identity::SecretPermanentIdentity const& identity,
-                          std::string const& dataPath,
-                          std::string const& cachePath)
+tc::cotask<void> Session::openStorage(Identity::SecretPermanentIdentity const& identity,
+                                      std::string const& dataPath,
+                                      std::string const& cachePath)
 {
   assert(!_identity && !_storage);
 
@@ -130,18 +136,19 @@ void Session::openStorage(Identity::SecretPermanentIdentity const& identity,
   _identity = identity;
   _storage = std::make_unique<Storage>(
       userSecret(), _datastoreBackend->open(getDbPath(dataPath, userId()), getDbPath(cachePath, userId())));
+  _storage->resourceKeyStore.setWriteBehind(_resourceKeyWriteBehind);
 
   auto const key = "version"sv;
   auto const keySpan = gsl::make_span(key).as_span<uint8_t const>();
   auto const keys = {keySpan};
 
-  auto const dbVersionResult = _storage->db->findCacheValues(keys);
+  auto const dbVersionResult = TC_AWAIT(_storage->db->findCacheValues(keys));
   if (!dbVersionResult[0])
   {
     auto const valueSpan = gsl::span<uint8_t const>(&Version, 1);
     auto const keyValues = {std::pair{keySpan, valueSpan}};
 
-    _storage->db->putCacheValues(keyValues, DataStore::OnConflict::Fail);
+    TC_AWAIT(_storage->db->putCacheValues(keyValues, DataStore::OnConflict::Fail));
   }
   // dbVersionResult has one row and one column
   else if (auto const dbVersion = (*dbVersionResult[0]).at(0); dbVersion != Version)
@@ -149,6 +156,7 @@ void Session::openStorage(Identity::SecretPermanentIdentity const& identity,
     throw Errors::formatEx(
         DataStore::Errc::InvalidDatabaseVersion, "unsupported device storage version: {}", static_cast<int>(dbVersion));
   }
+  TC_RETURN();
 }
 
 Session::Storage const& Session::storage() const
@@ -227,6 +235,20 @@ tc::cotask<std::optional<DeviceKeys>> Session::findDeviceKeys() const
   TC_RETURN(TC_AWAIT(storage().localUserStore.findDeviceKeys()));
 }
 
+void Session::setUserCacheMaxAge(std::optional<std::chrono::seconds> maxAge)
+{
+  _userCacheMaxAge = maxAge;
+  if (_accessors)
+    _accessors->userAccessor.setCacheMaxAge(maxAge);
+}
+
+void Session::setResourceKeyWriteBehind(std::optional<ResourceKeys::WriteBehindOptions> options)
+{
+  _resourceKeyWriteBehind = options;
+  if (_storage)
+    _storage->resourceKeyStore.setWriteBehind(options);
+}
+
 tc::cotask<void> Session::finalizeCreation(Trustchain::DeviceId const& deviceId, DeviceKeys const& deviceKeys)
 {
   auto shareCallback = [&](auto const& session, auto const& users, auto const& groups) {
@@ -240,7 +262,8 @@ tc::cotask<void> Session::finalizeCreation(Trustchain::DeviceId const& deviceId,
       &requesters(),
       TC_AWAIT(Users::LocalUserAccessor::createAndInit(
           userId(), trustchainId(), &_requesters, &storage().localUserStore, deviceKeys, deviceId)),
-      shareCallback);
+      shareCallback,
+      _userCacheMaxAge);
   setStatus(Status::Ready);
 }
 
@@ -254,7 +277,8 @@ tc::cotask<void> Session::finalizeOpening()
       storage(),
       &requesters(),
       TC_AWAIT(Users::LocalUserAccessor::create(userId(), trustchainId(), &_requesters, &storage().localUserStore)),
-      shareCallback);
+      shareCallback,
+      _userCacheMaxAge);
   _httpClient->setDeviceAuthData(TC_AWAIT(storage().localUserStore.getDeviceId()),
                                  TC_AWAIT(storage().localUserStore.getDeviceKeys()).signatureKeyPair);
   setStatus(Status::Ready);
@@ -268,7 +292,10 @@ tc::cotask<void> Session::transparentSessionShareImpl(TransparentSession::Access
   if (std::find(users.begin(), users.end(), selfIdentity) != users.end())
     TC_AWAIT(storage().resourceKeyStore.putKey(session.id, session.key));
 
-  auto const localUser = TC_AWAIT(accessors().localUserAccessor.pull());
+  // Only our device signs the share, its id and keys never change. The user
+  // keys of the recipients, ours included, are pulled by Share::share, and
+  // LocalUserAccessor pulls again by itself when it misses a key.
+  auto const& localUser = accessors().localUserAccessor.get();
   TC_AWAIT(Share::share(accessors().userAccessor,
                         accessors().groupAccessor,
                         trustchainId(),
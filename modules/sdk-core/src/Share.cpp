@@ -17,15 +17,21 @@
 #include <Tanker/Users/EntryGenerator.hpp>
 #include <Tanker/Users/IUserAccessor.hpp>
 #include <Tanker/Utils.hpp>
+#include <Tanker/WorkerPool.hpp>
 
 #include <boost/variant2/variant.hpp>
 
+#include <tconcurrent/async.hpp>
+#include <tconcurrent/future.hpp>
+
 #include <mgs/base64.hpp>
 
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/view/transform.hpp>
 
 #include <algorithm>
+#include <exception>
+#include <optional>
 
 static constexpr auto ShareLimit = 100;
 
@@ -37,52 +43,71 @@ namespace Share
 {
 namespace
 {
-std::vector<Trustchain::Actions::KeyPublishToUser> generateShareBlocksToUsers(
+// Blocks are generated in resource-major order, whether the work is spread
+// over the worker pool or not
+template <typename Action, typename Recipient, typename MakeAction>
+tc::cotask<std::vector<Action>> generateShareBlocksTo(WorkerPool* workerPool,
+                                                      ResourceKeys::KeysResult const& resourceKeys,
+                                                      std::vector<Recipient> const& recipients,
+                                                      MakeAction const& makeAction)
+{
+  // Actions are not default constructible, each slot is filled by its own index
+  std::vector<std::optional<Action>> blocks(resourceKeys.size() * recipients.size());
+  TC_AWAIT(parallelFor(workerPool, blocks.size(), [&](std::size_t i) {
+    auto const& keyResource = resourceKeys[i / recipients.size()];
+    blocks[i].emplace(makeAction(recipients[i % recipients.size()], keyResource.id, keyResource.key));
+  }));
+
+  std::vector<Action> out;
+  out.reserve(blocks.size());
+  for (auto& block : blocks)
+    out.push_back(std::move(*block));
+  TC_RETURN(out);
+}
+
+tc::cotask<std::vector<Trustchain::Actions::KeyPublishToUser>> generateShareBlocksToUsers(
     TrustchainId const& trustchainId,
     DeviceId const& deviceId,
     Crypto::PrivateSignatureKey const& signatureKey,
     ResourceKeys::KeysResult const& resourceKeys,
-    std::vector<Crypto::PublicEncryptionKey> const& recipientUserKeys)
-{
-  std::vector<Trustchain::Actions::KeyPublishToUser> out;
-  out.reserve(resourceKeys.size() * recipientUserKeys.size());
-  for (auto const& keyResource : resourceKeys)
-    for (auto const& recipientKey : recipientUserKeys)
-      out.push_back(
-          makeKeyPublishToUser(trustchainId, deviceId, signatureKey, recipientKey, keyResource.id, keyResource.key));
-  return out;
+    std::vector<Crypto::PublicEncryptionKey> const& recipientUserKeys,
+    WorkerPool* workerPool)
+{
+  TC_RETURN(TC_AWAIT(generateShareBlocksTo<Trustchain::Actions::KeyPublishToUser>(
+      workerPool, resourceKeys, recipientUserKeys, [&](auto const& recipientKey, auto const& id, auto const& key) {
+        return makeKeyPublishToUser(trustchainId, deviceId, signatureKey, recipientKey, id, key);
+      })));
 }
 
-std::vector<Trustchain::Actions::KeyPublishToProvisionalUser> generateShareBlocksToProvisionalUsers(
+tc::cotask<std::vector<Trustchain::Actions::KeyPublishToProvisionalUser>> generateShareBlocksToProvisionalUsers(
     Trustchain::TrustchainId const& trustchainId,
     Trustchain::DeviceId const& deviceId,
     Crypto::PrivateSignatureKey const& signatureKey,
     ResourceKeys::KeysResult const& resourceKeys,
-    std::vector<ProvisionalUsers::PublicUser> const& recipientProvisionalUserKeys)
-{
-  std::vector<Trustchain::Actions::KeyPublishToProvisionalUser> out;
-  out.reserve(resourceKeys.size() * recipientProvisionalUserKeys.size());
-  for (auto const& keyResource : resourceKeys)
-    for (auto const& recipientKey : recipientProvisionalUserKeys)
-      out.push_back(makeKeyPublishToProvisionalUser(
-          trustchainId, deviceId, signatureKey, recipientKey, keyResource.id, keyResource.key));
-  return out;
+    std::vector<ProvisionalUsers::PublicUser> const& recipientProvisionalUserKeys,
+    WorkerPool* workerPool)
+{
+  TC_RETURN(TC_AWAIT(generateShareBlocksTo<Trustchain::Actions::KeyPublishToProvisionalUser>(
+      workerPool,
+      resourceKeys,
+      recipientProvisionalUserKeys,
+      [&](auto const& recipientKey, auto const& id, auto const& key) {
+        return makeKeyPublishToProvisionalUser(trustchainId, deviceId, signatureKey, recipientKey, id, key);
+      })));
 }
 
-std::vector<Trustchain::Actions::KeyPublishToUserGroup> generateShareBlocksToGroups(
+tc::cotask<std::vector<Trustchain::Actions::KeyPublishToUserGroup>> generateShareBlocksToGroups(
     Trustchain::TrustchainId const& trustchainId,
     Trustchain::DeviceId const& deviceId,
     Crypto::PrivateSignatureKey const& signatureKey,
     ResourceKeys::KeysResult const& resourceKeys,
-    std::vector<Crypto::PublicEncryptionKey> const& recipientUserKeys)
-{
-  std::vector<Trustchain::Actions::KeyPublishToUserGroup> out;
-  out.reserve(resourceKeys.size() * recipientUserKeys.size());
-  for (auto const& keyResource : resourceKeys)
-    for (auto const& recipientKey : recipientUserKeys)
-      out.push_back(
-          makeKeyPublishToGroup(trustchainId, deviceId, signatureKey, recipientKey, keyResource.id, keyResource.key));
-  return out;
+    std::vector<Crypto::PublicEncryptionKey> const& recipientUserKeys,
+    WorkerPool* workerPool)
+{
+  TC_RETURN(TC_AWAIT(generateShareBlocksTo<Trustchain::Actions::KeyPublishToUserGroup>(
+      workerPool, resourceKeys, recipientUserKeys, [&](auto const& recipientKey, auto const& id, auto const& key) {
+        return makeKeyPublishToGroup(trustchainId, deviceId, signatureKey, recipientKey, id, key);
+      })));
 }
 
 void handleNotFound(std::vector<SPublicIdentity> const& spublicIdentities,
@@ -121,6 +146,69 @@ KeyRecipients toKeyRecipients(std::vector<Users::User> const& users,
 
   return out;
 }
+
+// Recipients are indexed users first, then provisional users, then groups
+KeyRecipients sliceRecipients(KeyRecipients const& recipients, std::size_t begin, std::size_t end)
+{
+  auto const slice = [&](auto const& from, std::size_t offset) {
+    auto const first = std::clamp(begin, offset, offset + from.size()) - offset;
+    auto const last = std::clamp(end, offset, offset + from.size()) - offset;
+    return std::decay_t<decltype(from)>(from.begin() + first, from.begin() + last);
+  };
+  auto const nbUsers = recipients.recipientUserKeys.size();
+  auto const nbProvisionalUsers = recipients.recipientProvisionalUserKeys.size();
+  return {slice(recipients.recipientUserKeys, 0),
+          slice(recipients.recipientProvisionalUserKeys, nbUsers),
+          slice(recipients.recipientGroupKeys, nbUsers + nbProvisionalUsers)};
+}
+
+template <typename T>
+void append(std::vector<T>& to, std::vector<T>&& from)
+{
+  to.insert(to.end(), std::make_move_iterator(from.begin()), std::make_move_iterator(from.end()));
+}
+
+// Generates the blocks of the resource-major pairs [pairBegin, pairEnd): a
+// batch may start and end in the middle of a resource's recipients
+tc::cotask<ShareActions> generateShareBlocksForPairs(Trustchain::TrustchainId const& trustchainId,
+                                                     Trustchain::DeviceId const& deviceId,
+                                                     Crypto::PrivateSignatureKey const& signatureKey,
+                                                     ResourceKeys::KeysResult const& resourceKeys,
+                                                     KeyRecipients const& keyRecipients,
+                                                     std::size_t nbRecipients,
+                                                     std::size_t pairBegin,
+                                                     std::size_t pairEnd,
+                                                     WorkerPool* workerPool)
+{
+  ShareActions out;
+  while (pairBegin < pairEnd)
+  {
+    auto const resource = pairBegin / nbRecipients;
+    auto const recipientBegin = pairBegin % nbRecipients;
+    ResourceKeys::KeysResult keys;
+    std::optional<KeyRecipients> partialRecipients;
+    if (recipientBegin == 0 && pairEnd - pairBegin >= nbRecipients)
+    {
+      // Resources shared with all the recipients are generated together
+      auto const nbResources = (pairEnd - pairBegin) / nbRecipients;
+      keys.assign(resourceKeys.begin() + resource, resourceKeys.begin() + resource + nbResources);
+      pairBegin += nbResources * nbRecipients;
+    }
+    else
+    {
+      auto const recipientEnd = std::min(nbRecipients, recipientBegin + (pairEnd - pairBegin));
+      keys.push_back(resourceKeys[resource]);
+      partialRecipients = sliceRecipients(keyRecipients, recipientBegin, recipientEnd);
+      pairBegin += recipientEnd - recipientBegin;
+    }
+    auto actions = TC_AWAIT(generateShareBlocks(
+        trustchainId, deviceId, signatureKey, keys, partialRecipients.value_or(keyRecipients), workerPool));
+    append(out.keyPublishesToUsers, std::move(actions.keyPublishesToUsers));
+    append(out.keyPublishesToUserGroups, std::move(actions.keyPublishesToUserGroups));
+    append(out.keyPublishesToProvisionalUsers, std::move(actions.keyPublishesToProvisionalUsers));
+  }
+  TC_RETURN(out);
+}
 }
 
 Trustchain::Actions::KeyPublishToUser makeKeyPublishToUser(
@@ -204,20 +292,22 @@ tc::cotask<KeyRecipients> generateRecipientList(Trustchain::TrustchainId const&
   TC_RETURN(toKeyRecipients(userResult.found, provisionalUsers, groupResult.found));
 }
 
-ShareActions generateShareBlocks(Trustchain::TrustchainId const& trustchainId,
-                                 Trustchain::DeviceId const& deviceId,
-                                 Crypto::PrivateSignatureKey const& signatureKey,
-                                 ResourceKeys::KeysResult const& resourceKeys,
-                                 KeyRecipients const& keyRecipients)
+tc::cotask<ShareActions> generateShareBlocks(Trustchain::TrustchainId const& trustchainId,
+                                             Trustchain::DeviceId const& deviceId,
+                                             Crypto::PrivateSignatureKey const& signatureKey,
+                                             ResourceKeys::KeysResult const& resourceKeys,
+                                             KeyRecipients const& keyRecipients,
+                                             WorkerPool* workerPool)
 {
-  auto keyPublishesToUsers =
-      generateShareBlocksToUsers(trustchainId, deviceId, signatureKey, resourceKeys, keyRecipients.recipientUserKeys);
-  auto keyPublishesToProvisionalUsers = generateShareBlocksToProvisionalUsers(
-      trustchainId, deviceId, signatureKey, resourceKeys, keyRecipients.recipientProvisionalUserKeys);
-  auto keyPublishesToGroups =
-      generateShareBlocksToGroups(trustchainId, deviceId, signatureKey, resourceKeys, keyRecipients.recipientGroupKeys);
-
-  return {std::move(keyPublishesToUsers), std::move(keyPublishesToGroups), std::move(keyPublishesToProvisionalUsers)};
+  auto keyPublishesToUsers = TC_AWAIT(generateShareBlocksToUsers(
+      trustchainId, deviceId, signatureKey, resourceKeys, keyRecipients.recipientUserKeys, workerPool));
+  auto keyPublishesToProvisionalUsers = TC_AWAIT(generateShareBlocksToProvisionalUsers(
+      trustchainId, deviceId, signatureKey, resourceKeys, keyRecipients.recipientProvisionalUserKeys, workerPool));
+  auto keyPublishesToGroups = TC_AWAIT(generateShareBlocksToGroups(
+      trustchainId, deviceId, signatureKey, resourceKeys, keyRecipients.recipientGroupKeys, workerPool));
+
+  TC_RETURN((ShareActions{
+      std::move(keyPublishesToUsers), std::move(keyPublishesToGroups), std::move(keyPublishesToProvisionalUsers)}));
 }
 
 tc::cotask<void> share(Users::IUserAccessor& userAccessor,
@@ -228,7 +318,8 @@ tc::cotask<void> share(Users::IUserAccessor& userAccessor,
                        Users::IRequester& requester,
                        ResourceKeys::KeysResult const& resourceKeys,
                        std::vector<SPublicIdentity> const& publicIdentities,
-                       std::vector<SGroupId> const& groupIds)
+                       std::vector<SGroupId> const& groupIds,
+                       WorkerPool* workerPool)
 {
   if (resourceKeys.empty())
     throw Errors::AssertionError("no keys to share");
@@ -240,10 +331,70 @@ tc::cotask<void> share(Users::IUserAccessor& userAccessor,
   auto const keyRecipients =
       TC_AWAIT(generateRecipientList(trustchainId, userAccessor, groupAccessor, publicIdentities, groupIds));
 
-  auto const actions = generateShareBlocks(trustchainId, deviceId, signatureKey, resourceKeys, keyRecipients);
+  auto const actions =
+      TC_AWAIT(generateShareBlocks(trustchainId, deviceId, signatureKey, resourceKeys, keyRecipients, workerPool));
 
   TC_AWAIT(requester.postResourceKeys(actions));
 }
 
+tc::cotask<void> shareInBatches(Users::IUserAccessor& userAccessor,
+                                Groups::IAccessor& groupAccessor,
+                                Trustchain::TrustchainId const& trustchainId,
+                                Trustchain::DeviceId const& deviceId,
+                                Crypto::PrivateSignatureKey const& signatureKey,
+                                Users::IRequester& requester,
+                                ResourceKeys::KeysResult const& resourceKeys,
+                                std::vector<SPublicIdentity> const& publicIdentities,
+                                std::vector<SGroupId> const& groupIds,
+                                ProgressHandler const& onProgress,
+                                WorkerPool* workerPool)
+{
+  if (resourceKeys.empty())
+    throw Errors::AssertionError("no keys to share");
+
+  // Recipients are resolved once for all the batches
+  auto const keyRecipients =
+      TC_AWAIT(generateRecipientList(trustchainId, userAccessor, groupAccessor, publicIdentities, groupIds));
+  auto const nbRecipients = keyRecipients.recipientUserKeys.size() +
+                            keyRecipients.recipientProvisionalUserKeys.size() +
+                            keyRecipients.recipientGroupKeys.size();
+  if (nbRecipients == 0)
+    TC_RETURN();
+  auto const nbPairs = resourceKeys.size() * nbRecipients;
+
+  // Batch N is uploaded while batch N+1 is generated. Only one upload is in
+  // flight, and it is always awaited, even when generating a batch failed
+  tc::shared_future<void> upload = tc::make_ready_future().to_shared();
+  std::size_t uploadedKeys = 0;
+  std::exception_ptr error;
+  for (std::size_t begin = 0; begin < nbPairs; begin += ShareLimit)
+  {
+    auto const end = std::min<std::size_t>(begin + ShareLimit, nbPairs);
+    try
+    {
+      auto actions = TC_AWAIT(generateShareBlocksForPairs(
+          trustchainId, deviceId, signatureKey, resourceKeys, keyRecipients, nbRecipients, begin, end, workerPool));
+      TC_AWAIT(upload);
+      if (onProgress && begin > 0)
+        onProgress(uploadedKeys, resourceKeys.size());
+      // A resource key only counts once it is shared with all the recipients
+      uploadedKeys = end / nbRecipients;
+      upload = tc::async_resumable([&requester, actions = std::move(actions)]() -> tc::cotask<void> {
+                 TC_AWAIT(requester.postResourceKeys(actions));
+               }).to_shared();
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+      break;
+    }
+  }
+  TC_AWAIT(upload);
+  if (error)
+    std::rethrow_exception(error);
+  if (onProgress)
+    onProgress(uploadedKeys, resourceKeys.size());
+}
+
 }
 }
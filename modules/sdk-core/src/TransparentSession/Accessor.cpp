@@ -2,10 +2,18 @@
 
 #include <Tanker/Crypto/Crypto.hpp>
 
-constexpr const uint64_t SESSION_EXPIRATION_SECONDS = 12 * 3600;
-
 namespace Tanker::TransparentSession
 {
+namespace
+{
+bool isSessionValid(TransparentSessionData const& session)
+{
+  // Drop sessions in the future, since their real age is unknown
+  auto const now = secondsSinceEpoch();
+  return session.creationTimestamp <= now && now < session.creationTimestamp + Accessor::SessionExpirationSeconds;
+}
+}
+
 bool operator==(AccessorResult const& lhs, AccessorResult const& rhs)
 {
   return std::tie(lhs.key, lhs.id) == std::tie(rhs.key, rhs.id);
@@ -16,33 +24,41 @@ bool operator!=(AccessorResult const& lhs, AccessorResult const& rhs)
   return !(lhs == rhs);
 }
 
-Accessor::Accessor(Store* store, SessionShareCallback shareCallback)
-  : _shareCallback(std::move(shareCallback)), _store(store)
+Accessor::Accessor(Store* store, SessionShareCallback shareCallback, std::size_t cacheCapacity)
+  : _shareCallback(std::move(shareCallback)), _store(store), _sessions(cacheCapacity)
 {
 }
 
+CacheStats const& Accessor::cacheStats() const
+{
+  return _sessions.stats();
+}
+
 tc::cotask<AccessorResult> Accessor::getOrCreateTransparentSession(std::vector<SPublicIdentity> const& users,
                                                                    std::vector<SGroupId> const& groups)
 {
   auto const hash = Store::hashRecipients(users, groups);
 
+  // Enforce expiration of transparent session, both in memory and in the Store
+  if (auto const cached = _sessions.get(hash, isSessionValid))
+    TC_RETURN((AccessorResult{hash, cached->sessionId, cached->sessionKey}));
+
   auto const resultVec = TC_AWAIT(_cache.run(
       [&](auto const& hashSpan) -> tc::cotask<AccessorResults> {
         auto const& hash = hashSpan[0];
-        if (auto sess = TC_AWAIT(_store->get(hash)); sess.has_value())
+        if (auto sess = TC_AWAIT(_store->get(hash)); sess.has_value() && isSessionValid(*sess))
         {
-          // Enforce expiration of transparent session
-          // Drop sessions in the future, since their real age is unknown
-          auto const now = secondsSinceEpoch();
-          if (sess->creationTimestamp <= now && now < sess->creationTimestamp + SESSION_EXPIRATION_SECONDS)
-            TC_RETURN((AccessorResults{AccessorResult{hash, sess->sessionId, sess->sessionKey}}));
+          _sessions.put(hash, *sess);
+          TC_RETURN((AccessorResults{AccessorResult{hash, sess->sessionId, sess->sessionKey}}));
         }
 
         auto id = Crypto::getRandom<Crypto::SimpleResourceId>();
         auto key = Crypto::makeSymmetricKey();
         auto sess = AccessorResult{hash, id, key};
         TC_AWAIT(_shareCallback(sess, users, groups));
-        TC_AWAIT(_store->put(hash, id, key));
+        auto const now = secondsSinceEpoch();
+        TC_AWAIT(_store->put(hash, id, key, now));
+        _sessions.put(hash, TransparentSessionData{now, id, key});
         TC_RETURN(AccessorResults{sess});
       },
       gsl::span<Crypto::Hash const>{&hash, 1}));
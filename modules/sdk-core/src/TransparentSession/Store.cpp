@@ -106,11 +106,10 @@ tc::cotask<void> Store::put(Crypto::Hash const& recipientsHash,
   auto const keyBuffer = serializeStoreKey(recipientsHash);
   TransparentSessionData sessionData{creationTimestamp, sessionId, sessionKey};
   auto const valueBuffer = serializeTransparentSession(sessionData);
-  auto const encryptedValue = DataStore::encryptValue(_userSecret, valueBuffer);
+  auto const encryptedValue = DataStore::encryptValue(*_db, _userSecret, valueBuffer);
 
   std::vector<std::pair<gsl::span<uint8_t const>, gsl::span<uint8_t const>>> keyValues{{keyBuffer, encryptedValue}};
-  _db->putCacheValues(keyValues, DataStore::OnConflict::Replace);
-  TC_RETURN();
+  TC_AWAIT(_db->putCacheValues(keyValues, DataStore::OnConflict::Replace));
 }
 
 tc::cotask<std::optional<TransparentSessionData>> Store::get(Crypto::Hash const& recipientsHash) const
@@ -121,11 +120,11 @@ tc::cotask<std::optional<TransparentSessionData>> Store::get(Crypto::Hash const&
   {
     auto const keyBuffer = serializeStoreKey(recipientsHash);
     auto const keys = {gsl::make_span(keyBuffer)};
-    auto const result = _db->findCacheValues(keys);
+    auto const result = TC_AWAIT(_db->findCacheValues(keys));
     if (!result.at(0))
       TC_RETURN(std::nullopt);
 
-    auto const decryptedValue = TC_AWAIT(DataStore::decryptValue(_userSecret, *result.at(0)));
+    auto const decryptedValue = TC_AWAIT(DataStore::decryptValue(*_db, _userSecret, *result.at(0)));
     TC_RETURN(deserializeTransparentSession(decryptedValue));
   }
   catch (Errors::Exception const& e)
@@ -134,4 +133,8 @@ tc::cotask<std::optional<TransparentSessionData>> Store::get(Crypto::Hash const&
   }
 }
 
+tc::cotask<DataStore::CacheUsage> Store::cacheUsage() const
+{
+  TC_RETURN(TC_AWAIT(_db->findCacheUsage(gsl::make_span(KeyPrefix).as_span<uint8_t const>())));
+}
 }
@@ -160,11 +160,11 @@ tc::cotask<std::optional<DeviceData>> LocalUserStore::getDeviceData() const
 
   try
   {
-    auto const encryptedPayload = _db->findSerializedDevice();
+    auto const encryptedPayload = TC_AWAIT(_db->findSerializedDevice());
     if (!encryptedPayload)
       TC_RETURN(std::nullopt);
 
-    auto const payload = TC_AWAIT(DataStore::decryptValue(_userSecret, *encryptedPayload));
+    auto const payload = TC_AWAIT(DataStore::decryptValue(*_db, _userSecret, *encryptedPayload));
     auto const device = deserializeEncryptedDevice(payload);
 
     if (device.userKeys.empty())
@@ -183,9 +183,7 @@ tc::cotask<void> LocalUserStore::setDeviceData(DeviceData const& deviceData)
   FUNC_TIMER(DB);
 
   auto const payload = serializeEncryptedDevice(deviceData);
-  auto const encryptedPayload = DataStore::encryptValue(_userSecret, payload);
-  _db->putSerializedDevice(encryptedPayload);
-
-  TC_RETURN();
+  auto const encryptedPayload = DataStore::encryptValue(*_db, _userSecret, payload);
+  TC_AWAIT(_db->putSerializedDevice(encryptedPayload));
 }
 }
@@ -1,6 +1,7 @@
 #include <Tanker/Users/UserAccessor.hpp>
 
 #include <Tanker/Actions/Deduplicate.hpp>
+#include <Tanker/ConcurrentChunks.hpp>
 #include <Tanker/Errors/AssertionError.hpp>
 #include <Tanker/Errors/Errc.hpp>
 #include <Tanker/Errors/Exception.hpp>
@@ -17,8 +18,13 @@
 #include <range/v3/action/unique.hpp>
 #include <range/v3/algorithm/unique.hpp>
 
+#include <boost/container/flat_set.hpp>
+
 #include <tconcurrent/coroutine.hpp>
 
+#include <algorithm>
+#include <iterator>
+
 TLOG_CATEGORY(UserAccessor);
 
 static constexpr auto ChunkSize = 100;
@@ -36,11 +42,19 @@ using namespace Tanker::Trustchain::Actions;
 namespace Tanker::Users
 {
 
-UserAccessor::UserAccessor(Trustchain::Context trustchainContext, Users::IRequester* requester)
-  : _context(std::move(trustchainContext)), _requester(requester)
+UserAccessor::UserAccessor(Trustchain::Context trustchainContext,
+                           Users::IRequester* requester,
+                           UserStore* userStore,
+                           std::optional<std::chrono::seconds> cacheMaxAge)
+  : _context(std::move(trustchainContext)), _requester(requester), _userStore(userStore), _cacheMaxAge(cacheMaxAge)
 {
 }
 
+void UserAccessor::setCacheMaxAge(std::optional<std::chrono::seconds> cacheMaxAge)
+{
+  _cacheMaxAge = cacheMaxAge;
+}
+
 auto UserAccessor::pull(std::vector<UserId> userIds) -> tc::cotask<UserPullResult>
 {
   TC_RETURN(TC_AWAIT((pullImpl<UserPullResult, UserId>(std::move(userIds)))));
@@ -73,35 +87,90 @@ auto UserAccessor::pullImpl(std::vector<Id> requestedIds) -> tc::cotask<Result>
 
 namespace
 {
-auto processUserEntries(Trustchain::Context const& context, gsl::span<Trustchain::UserAction const> actions)
+std::vector<CachedUser> processUserEntries(Trustchain::Context const& context,
+                                           gsl::span<Trustchain::UserAction const> actions,
+                                           CachedUsersMap const& cachedUsers,
+                                           std::uint64_t fetchTimestamp)
 {
-  UsersMap usersMap;
-  DevicesMap devicesMap;
-
+  // Group the device creations by user, keeping the order of the history
+  flat_map<UserId, std::vector<DeviceCreation const*>> histories;
   for (auto const& action : actions)
   {
     if (auto const dc = boost::variant2::get_if<DeviceCreation>(&action))
-    {
-      std::optional<Users::User> user;
-      auto const userIt = usersMap.find(dc->userId());
-
-      if (userIt != usersMap.end())
-        user = userIt->second;
+      histories[dc->userId()].push_back(dc);
+    else
+      TERROR("Expected user blocks but got {}", Trustchain::getNature(action));
+  }
 
-      auto const action = Verif::verifyDeviceCreation(*dc, context, user);
+  std::vector<CachedUser> users;
+  users.reserve(histories.size());
+  boost::container::flat_set<DeviceId> devices;
+  for (auto const& [userId, history] : histories)
+  {
+    std::optional<Users::User> user;
+    auto toVerify = history.begin();
 
-      user = Updater::applyDeviceCreationToUser(action, user);
-      usersMap[dc->userId()] = *user;
-      auto const& lastDevice = user->devices().back();
-      if (auto const [it, isInserted] = devicesMap.emplace(lastDevice.id(), lastDevice); isInserted == false)
-        throw Errors::AssertionError("DeviceCreation received more than once");
+    // Blocks up to the cached lastBlockHash have already been verified, only
+    // apply the ones that came after
+    if (auto const cached = cachedUsers.find(userId); cached != cachedUsers.end())
+    {
+      auto const lastBlock = std::find_if(history.begin(), history.end(), [&](auto const dc) {
+        return dc->hash() == cached->second.lastBlockHash;
+      });
+      if (lastBlock != history.end())
+      {
+        user = cached->second.user;
+        toVerify = std::next(lastBlock);
+      }
     }
-    else
+
+    for (; toVerify != history.end(); ++toVerify)
     {
-      TERROR("Expected user blocks but got {}", Trustchain::getNature(action));
+      auto const action = Verif::verifyDeviceCreation(**toVerify, context, user);
+      user = Updater::applyDeviceCreationToUser(action, user);
     }
+
+    for (auto const& device : user->devices())
+      if (auto const [it, isInserted] = devices.insert(device.id()); isInserted == false)
+        throw Errors::AssertionError("DeviceCreation received more than once");
+    users.push_back({std::move(*user), history.back()->hash(), fetchTimestamp});
   }
-  return std::make_tuple(usersMap, devicesMap);
+  return users;
+}
+
+CachedUser const* findCachedUser(CachedUsersMap const& cachedUsers, UserId const& userId)
+{
+  auto const it = cachedUsers.find(userId);
+  return it == cachedUsers.end() ? nullptr : &it->second;
+}
+
+CachedUser const* findCachedUser(CachedUsersMap const& cachedUsers, DeviceId const& deviceId)
+{
+  for (auto const& [userId, cachedUser] : cachedUsers)
+    if (cachedUser.user.findDevice(deviceId))
+      return &cachedUser;
+  return nullptr;
+}
+
+tc::cotask<CachedUsersMap> findCachedUsers(UserStore& userStore, gsl::span<UserId const> userIds)
+{
+  TC_RETURN(TC_AWAIT(userStore.findByUserIds(userIds)));
+}
+
+tc::cotask<CachedUsersMap> findCachedUsers(UserStore& userStore, gsl::span<DeviceId const> deviceIds)
+{
+  TC_RETURN(TC_AWAIT(userStore.findByDeviceIds(deviceIds)));
+}
+
+void addToResult(UsersMap& result, Users::User const& user)
+{
+  result[user.id()] = user;
+}
+
+void addToResult(DevicesMap& result, Users::User const& user)
+{
+  for (auto const& device : user.devices())
+    result[device.id()] = device;
 }
 
 struct HashProvisionalUsersResult
@@ -208,25 +277,25 @@ tc::cotask<std::vector<ProvisionalUsers::PublicUser>> UserAccessor::pullProvisio
   checkIdentityUnicity(hashedProvisionals.hashedEmails);
   checkIdentityUnicity(hashedProvisionals.hashedPhoneNumbers);
 
+  auto const getPublicProvisionalIdentities = [&](auto const chunk) {
+    return _requester->getPublicProvisionalIdentities(chunk);
+  };
+
   flat_map<HashedEmail, PublicKeys> tankerEmailProvisionalIdentities;
-  for (unsigned int i = 0; i < hashedProvisionals.hashedEmails.size(); i += ChunkSize)
-  {
-    auto const count = std::min<unsigned int>(ChunkSize, hashedProvisionals.hashedEmails.size() - i);
-    auto response = TC_AWAIT(
-        _requester->getPublicProvisionalIdentities(gsl::make_span(hashedProvisionals.hashedEmails).subspan(i, count)));
+  auto emailResponses = TC_AWAIT(mapChunksConcurrently(
+      gsl::span<HashedEmail const>(hashedProvisionals.hashedEmails), ChunkSize, getPublicProvisionalIdentities));
+  for (auto& response : emailResponses)
     tankerEmailProvisionalIdentities.insert(std::make_move_iterator(response.begin()),
                                             std::make_move_iterator(response.end()));
-  }
 
   flat_map<HashedPhoneNumber, PublicKeys> tankerPhoneNumberProvisionalIdentities;
-  for (unsigned int i = 0; i < hashedProvisionals.hashedPhoneNumbers.size(); i += ChunkSize)
-  {
-    auto const count = std::min<unsigned int>(ChunkSize, hashedProvisionals.hashedPhoneNumbers.size() - i);
-    auto response = TC_AWAIT(_requester->getPublicProvisionalIdentities(
-        gsl::make_span(hashedProvisionals.hashedPhoneNumbers).subspan(i, count)));
+  auto phoneNumberResponses =
+      TC_AWAIT(mapChunksConcurrently(gsl::span<HashedPhoneNumber const>(hashedProvisionals.hashedPhoneNumbers),
+                                     ChunkSize,
+                                     getPublicProvisionalIdentities));
+  for (auto& response : phoneNumberResponses)
     tankerPhoneNumberProvisionalIdentities.insert(std::make_move_iterator(response.begin()),
                                                   std::make_move_iterator(response.end()));
-  }
 
   if (appProvisionalIdentities.size() !=
       tankerEmailProvisionalIdentities.size() + tankerPhoneNumberProvisionalIdentities.size())
@@ -273,13 +342,38 @@ auto UserAccessor::fetchImpl(gsl::span<Id const> ids) -> tc::cotask<Result>
     TC_RETURN(out);
 
   out.reserve(ids.size());
-  for (unsigned int i = 0; i < ids.size(); i += ChunkSize)
+  auto const now = secondsSinceEpoch();
+  CachedUsersMap cachedUsers;
+  if (_userStore)
+    cachedUsers = TC_AWAIT(findCachedUsers(*_userStore, ids));
+
+  // Users fetched recently enough are trusted as they are
+  std::vector<Id> idsToFetch;
+  for (auto const& id : ids)
+  {
+    auto const cachedUser = findCachedUser(cachedUsers, id);
+    if (_cacheMaxAge && cachedUser && cachedUser->fetchTimestamp <= now &&
+        now - cachedUser->fetchTimestamp < static_cast<std::uint64_t>(_cacheMaxAge->count()))
+      addToResult(out, cachedUser->user);
+    else
+      idsToFetch.push_back(id);
+  }
+
+  // Fetch all the chunks at once, and only verify them when they are all there
+  auto const responses = TC_AWAIT(mapChunksConcurrently(
+      gsl::span<Id const>(idsToFetch), ChunkSize, [&](auto const chunk) { return _requester->getUsers(chunk); }));
+  std::vector<CachedUser> fetchedUsers;
+  for (auto const& [trustchainCreation, actions] : responses)
   {
-    auto const count = std::min<std::size_t>(ChunkSize, ids.size() - i);
-    auto const [trustchainCreation, actions] = TC_AWAIT(_requester->getUsers(ids.subspan(i, count)));
-    auto currentUsers = std::get<Result>(processUserEntries(_context, actions));
-    out.insert(std::make_move_iterator(currentUsers.begin()), std::make_move_iterator(currentUsers.end()));
+    auto users = processUserEntries(_context, actions, cachedUsers, now);
+    fetchedUsers.insert(
+        fetchedUsers.end(), std::make_move_iterator(users.begin()), std::make_move_iterator(users.end()));
   }
+
+  if (_userStore)
+    TC_AWAIT(_userStore->put(fetchedUsers));
+  for (auto const& fetchedUser : fetchedUsers)
+    addToResult(out, fetchedUser.user);
   TC_RETURN(out);
 }
 }
@@ -0,0 +1,222 @@
+#include <Tanker/Users/UserStore.hpp>
+
+#include <Tanker/Crypto/Format/Format.hpp>
+#include <Tanker/DataStore/Errors/Errc.hpp>
+#include <Tanker/DataStore/Utils.hpp>
+#include <Tanker/Errors/Errc.hpp>
+#include <Tanker/Errors/Exception.hpp>
+#include <Tanker/Log/Log.hpp>
+#include <Tanker/Serialization/Errors/Errc.hpp>
+#include <Tanker/Serialization/Serialization.hpp>
+#include <Tanker/Tracer/ScopeTimer.hpp>
+
+#include <range/v3/action/sort.hpp>
+#include <range/v3/action/unique.hpp>
+
+#include <tuple>
+
+TLOG_CATEGORY(UserStore);
+
+namespace Tanker::Users
+{
+namespace
+{
+constexpr auto Version = 1;
+// Prefix should never be reused. List of previously used prefix:
+// None
+std::string const KeyPrefix = "users-";
+std::string const IndexPrefix = "users-index-deviceid-";
+
+template <typename Id>
+std::vector<uint8_t> serializeKey(std::string const& prefix, Id const& id)
+{
+  std::vector<uint8_t> keyBuffer(prefix.size() + id.size());
+  auto it = keyBuffer.data();
+  it = std::copy(prefix.begin(), prefix.end(), it);
+  it = Serialization::serialize(it, id);
+  assert(it == keyBuffer.data() + keyBuffer.size());
+  return keyBuffer;
+}
+
+std::vector<uint8_t> serializeStoreValue(CachedUser const& cachedUser)
+{
+  auto const& user = cachedUser.user;
+  auto const deviceSize = Trustchain::DeviceId::arraySize + Crypto::PublicSignatureKey::arraySize +
+                          Crypto::PublicEncryptionKey::arraySize + sizeof(uint8_t);
+  std::vector<uint8_t> valueBuffer(
+      sizeof(uint8_t) + user.id().size() + sizeof(uint8_t) + (user.userKey() ? user.userKey()->size() : 0) +
+      cachedUser.lastBlockHash.size() + Serialization::serialized_size(cachedUser.fetchTimestamp) + sizeof(uint32_t) +
+      user.devices().size() * deviceSize);
+
+  auto it = valueBuffer.data();
+  it = Serialization::serialize<uint8_t>(it, Version);
+  it = Serialization::serialize(it, user.id());
+  it = Serialization::serialize<uint8_t>(it, user.userKey().has_value());
+  if (user.userKey())
+    it = Serialization::serialize(it, *user.userKey());
+  it = Serialization::serialize(it, cachedUser.lastBlockHash);
+  it = Serialization::serialize(it, cachedUser.fetchTimestamp);
+  it = Serialization::serialize<uint32_t>(it, user.devices().size());
+  for (auto const& device : user.devices())
+  {
+    it = Serialization::serialize(it, device.id());
+    it = Serialization::serialize(it, device.publicSignatureKey());
+    it = Serialization::serialize(it, device.publicEncryptionKey());
+    it = Serialization::serialize<uint8_t>(it, device.isGhostDevice());
+  }
+  assert(it == valueBuffer.data() + valueBuffer.size());
+  return valueBuffer;
+}
+
+CachedUser deserializeStoreValue(gsl::span<uint8_t const> serialized)
+{
+  Serialization::SerializedSource ss{serialized};
+
+  auto const version = Serialization::deserialize<uint8_t>(ss);
+  if (version != Version)
+    throw Errors::formatEx(
+        DataStore::Errc::InvalidDatabaseVersion, "unsupported user storage version: {}", static_cast<int>(version));
+
+  auto const userId = Serialization::deserialize<Trustchain::UserId>(ss);
+  std::optional<Crypto::PublicEncryptionKey> userKey;
+  if (Serialization::deserialize<uint8_t>(ss))
+    userKey = Serialization::deserialize<Crypto::PublicEncryptionKey>(ss);
+  auto const lastBlockHash = Serialization::deserialize<Crypto::Hash>(ss);
+  auto const fetchTimestamp = Serialization::deserialize<std::uint64_t>(ss);
+
+  auto const nbDevices = Serialization::deserialize<uint32_t>(ss);
+  std::vector<Device> devices;
+  devices.reserve(nbDevices);
+  for (auto i = 0u; i < nbDevices; ++i)
+  {
+    auto const deviceId = Serialization::deserialize<Trustchain::DeviceId>(ss);
+    auto const publicSignatureKey = Serialization::deserialize<Crypto::PublicSignatureKey>(ss);
+    auto const publicEncryptionKey = Serialization::deserialize<Crypto::PublicEncryptionKey>(ss);
+    auto const isGhostDevice = Serialization::deserialize<uint8_t>(ss) != 0;
+    devices.emplace_back(deviceId, userId, publicSignatureKey, publicEncryptionKey, isGhostDevice);
+  }
+
+  if (!ss.eof())
+    throw Errors::formatEx(Serialization::Errc::TrailingInput, "{} trailing bytes", ss.remaining_size());
+
+  return CachedUser{User{userId, userKey, devices}, lastBlockHash, fetchTimestamp};
+}
+
+std::vector<gsl::span<uint8_t const>> toSpans(std::vector<std::vector<uint8_t>> const& buffers)
+{
+  return std::vector<gsl::span<uint8_t const>>(buffers.begin(), buffers.end());
+}
+}
+
+bool operator==(CachedUser const& lhs, CachedUser const& rhs)
+{
+  return std::tie(lhs.user, lhs.lastBlockHash, lhs.fetchTimestamp) ==
+         std::tie(rhs.user, rhs.lastBlockHash, rhs.fetchTimestamp);
+}
+
+bool operator!=(CachedUser const& lhs, CachedUser const& rhs)
+{
+  return !(lhs == rhs);
+}
+
+UserStore::UserStore(Crypto::SymmetricKey const& userSecret, DataStore::DataStore* db)
+  : _userSecret(userSecret), _db(db)
+{
+}
+
+tc::cotask<void> UserStore::put(gsl::span<CachedUser const> users)
+{
+  FUNC_TIMER(DB);
+  if (users.empty())
+    TC_RETURN();
+
+  // Keep the buffers alive until the write, the key-values only point to them
+  std::vector<std::vector<uint8_t>> buffers;
+  std::vector<std::pair<gsl::span<uint8_t const>, gsl::span<uint8_t const>>> keyValues;
+
+  for (auto const& cachedUser : users)
+  {
+    TDEBUG("Adding user {}", cachedUser.user.id());
+    auto const keyBuffer = gsl::make_span(buffers.emplace_back(serializeKey(KeyPrefix, cachedUser.user.id())));
+    auto const valueBuffer = gsl::make_span(
+        buffers.emplace_back(DataStore::encryptValue(*_db, _userSecret, serializeStoreValue(cachedUser))));
+    keyValues.emplace_back(keyBuffer, valueBuffer);
+
+    // The index points to the user's store key, like in Groups::Store
+    for (auto const& device : cachedUser.user.devices())
+    {
+      auto const indexKeyBuffer = gsl::make_span(buffers.emplace_back(serializeKey(IndexPrefix, device.id())));
+      keyValues.emplace_back(indexKeyBuffer, keyBuffer);
+    }
+  }
+
+  TC_AWAIT(_db->putCacheValues(keyValues, DataStore::OnConflict::Replace));
+}
+
+tc::cotask<CachedUsersMap> UserStore::findByUserIds(gsl::span<Trustchain::UserId const> userIds) const
+{
+  FUNC_TIMER(DB);
+
+  try
+  {
+    std::vector<std::vector<uint8_t>> keyBuffers;
+    keyBuffers.reserve(userIds.size());
+    for (auto const& userId : userIds)
+      keyBuffers.push_back(serializeKey(KeyPrefix, userId));
+    auto const results = TC_AWAIT(_db->findCacheValues(toSpans(keyBuffers)));
+
+    CachedUsersMap out;
+    out.reserve(userIds.size());
+    for (auto const& result : results)
+    {
+      if (!result)
+        continue;
+      auto const decryptedValue = TC_AWAIT(DataStore::decryptValue(*_db, _userSecret, *result));
+      auto cachedUser = deserializeStoreValue(decryptedValue);
+      auto const userId = cachedUser.user.id();
+      out.emplace(userId, std::move(cachedUser));
+    }
+    TC_RETURN(std::move(out));
+  }
+  catch (Errors::Exception const& e)
+  {
+    DataStore::handleError(e);
+  }
+}
+
+tc::cotask<CachedUsersMap> UserStore::findByDeviceIds(gsl::span<Trustchain::DeviceId const> deviceIds) const
+{
+  FUNC_TIMER(DB);
+
+  try
+  {
+    std::vector<std::vector<uint8_t>> indexKeyBuffers;
+    indexKeyBuffers.reserve(deviceIds.size());
+    for (auto const& deviceId : deviceIds)
+      indexKeyBuffers.push_back(serializeKey(IndexPrefix, deviceId));
+    auto const storeKeys = TC_AWAIT(_db->findCacheValues(toSpans(indexKeyBuffers)));
+
+    std::vector<Trustchain::UserId> userIds;
+    for (auto const& storeKey : storeKeys)
+    {
+      if (!storeKey)
+        continue;
+      if (storeKey->size() != KeyPrefix.size() + Trustchain::UserId::arraySize)
+        throw Errors::Exception(DataStore::Errc::DatabaseCorrupt, "invalid user index value");
+      userIds.emplace_back(gsl::make_span(*storeKey).subspan(KeyPrefix.size()));
+    }
+    userIds |= ranges::actions::sort | ranges::actions::unique;
+
+    TC_RETURN(TC_AWAIT(findByUserIds(userIds)));
+  }
+  catch (Errors::Exception const& e)
+  {
+    DataStore::handleError(e);
+  }
+}
+
+tc::cotask<DataStore::CacheUsage> UserStore::cacheUsage() const
+{
+  TC_RETURN(TC_AWAIT(_db->findCacheUsage(gsl::make_span(KeyPrefix).as_span<uint8_t const>())));
+}
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Tanker/ProvisionalUsers/IRequester.hpp>
+
+#include <trompeloeil.hpp>
+
+namespace Tanker
+{
+class ProvisionalUsersRequesterStub : public trompeloeil::mock_interface<ProvisionalUsers::IRequester>
+{
+public:
+  MAKE_MOCK1(getClaimBlocks,
+             tc::cotask<std::vector<Trustchain::Actions::ProvisionalIdentityClaim>>(Trustchain::UserId const&),
+             override);
+  MAKE_MOCK2(getVerifiedProvisionalIdentityKeys,
+             tc::cotask<std::optional<TankerSecretProvisionalIdentity>>(Trustchain::UserId const&,
+                                                                         Verification::RequestWithSession const&),
+             override);
+  MAKE_MOCK1(getProvisionalIdentityKeys,
+             tc::cotask<TankerSecretProvisionalIdentity>(Verification::RequestWithVerif const&),
+             override);
+  MAKE_MOCK1(claimProvisionalIdentity,
+             tc::cotask<void>(Trustchain::Actions::ProvisionalIdentityClaim const&),
+             override);
+};
+}
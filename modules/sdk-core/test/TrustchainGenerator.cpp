@@ -13,6 +13,8 @@
 #include <Tanker/Types/SUserId.hpp>
 #include <Tanker/Users/EntryGenerator.hpp>
 
+#include <Helpers/Await.hpp>
+
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/view/transform.hpp>
 
@@ -380,13 +382,13 @@ Trustchain::Actions::UserGroupAddition Group::addUsers(Device const& author,
                                                        std::vector<User> const& newUsers,
                                                        std::vector<ProvisionalUser> const& provisionalUsers)
 {
-  auto const groupAddition = Groups::Manager::makeUserGroupAdditionAction(
+  auto const groupAddition = AWAIT(Groups::Manager::makeUserGroupAdditionAction(
       newUsers | ranges::to<std::vector<Users::User>>,
       provisionalUsers | ranges::to<std::vector<ProvisionalUsers::PublicUser>>,
       *this,
       _tid,
       author.id(),
-      author.keys().signatureKeyPair.privateKey);
+      author.keys().signatureKeyPair.privateKey));
   _entries.emplace_back(groupAddition);
   return groupAddition;
 }
@@ -0,0 +1,70 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <Tanker/ConcurrentChunks.hpp>
+#include <Tanker/Errors/Errc.hpp>
+#include <Tanker/Errors/Exception.hpp>
+
+#include <Helpers/Await.hpp>
+#include <Helpers/Errors.hpp>
+
+#include <tconcurrent/async_wait.hpp>
+
+#include <chrono>
+#include <numeric>
+
+using namespace Tanker;
+using namespace std::chrono_literals;
+
+TEST_CASE("mapChunksConcurrently")
+{
+  std::vector<int> ids(10);
+  std::iota(ids.begin(), ids.end(), 0);
+
+  SECTION("returns nothing for no ids")
+  {
+    auto const results = AWAIT(mapChunksConcurrently(
+        gsl::span<int const>{}, 3, [](auto const chunk) -> tc::cotask<std::size_t> { TC_RETURN(chunk.size()); }));
+    CHECK(results.empty());
+  }
+
+  SECTION("returns the results in chunk order")
+  {
+    auto const results =
+        AWAIT(mapChunksConcurrently(gsl::span<int const>(ids), 3, [](auto const chunk) -> tc::cotask<std::vector<int>> {
+          // The first chunks finish last
+          TC_AWAIT(tc::async_wait(std::chrono::milliseconds(10 - chunk[0])));
+          TC_RETURN(std::vector<int>(chunk.begin(), chunk.end()));
+        }));
+    CHECK(results == std::vector<std::vector<int>>{{0, 1, 2}, {3, 4, 5}, {6, 7, 8}, {9}});
+  }
+
+  SECTION("runs the chunks concurrently")
+  {
+    int running = 0;
+    int maxRunning = 0;
+    AWAIT(mapChunksConcurrently(gsl::span<int const>(ids), 2, [&](auto const) -> tc::cotask<int> {
+      maxRunning = std::max(maxRunning, ++running);
+      TC_AWAIT(tc::async_wait(1ms));
+      --running;
+      TC_RETURN(0);
+    }));
+    CHECK(maxRunning == 5);
+  }
+
+  SECTION("waits for all the chunks and rethrows an error")
+  {
+    int done = 0;
+    TANKER_CHECK_THROWS_WITH_CODE(
+        AWAIT(mapChunksConcurrently(gsl::span<int const>(ids),
+                                    3,
+                                    [&](auto const chunk) -> tc::cotask<int> {
+                                      TC_AWAIT(tc::async_wait(1ms));
+                                      ++done;
+                                      if (chunk[0] == 3)
+                                        throw Errors::Exception(Errors::Errc::NetworkError, "chunk failed");
+                                      TC_RETURN(0);
+                                    })),
+        Errors::Errc::NetworkError);
+    CHECK(done == 4);
+  }
+}
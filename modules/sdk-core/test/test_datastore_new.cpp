@@ -2,10 +2,208 @@
 
 #include <Helpers/DataStoreTests.hpp>
 
+#include <Tanker/DataStore/Memory/Backend.hpp>
 #include <Tanker/DataStore/Sqlite/Backend.hpp>
 
+#include <fmt/format.h>
+#include <tconcurrent/async.hpp>
+#include <tconcurrent/when.hpp>
+
+#include <iterator>
+
 TEST_CASE("SQLite DataStore")
 {
   Tanker::DataStore::SqliteBackend backend;
   runDataStoreTests(backend, ".");
 }
+
+TEST_CASE("SQLite DataStore with a write-ahead log")
+{
+  Tanker::DataStore::SqliteBackend backend({true});
+  runDataStoreTests(backend, ".");
+}
+
+TEST_CASE("SQLite DataStore queued writes")
+{
+  using namespace Tanker;
+  using namespace Tanker::DataStore;
+  using CacheResult = std::vector<std::optional<std::vector<uint8_t>>>;
+
+  SqliteBackend backend;
+  Tanker::UniquePath testtmp{"."};
+  auto store = backend.open(testtmp.path, testtmp.path);
+
+  auto const keyValues = makeKeyValues({{"key 1", "value 1"}});
+  auto const keyValues2 = makeKeyValues({{"key 2", "value 2"}});
+  auto const conflictingKeyValues = makeKeyValues({{"key 3", "value 3"}, {"key 1", "value 4"}});
+
+  // Concurrent writes can share a transaction, each still gets its own result
+  std::vector<tc::future<void>> futures;
+  futures.push_back(tc::async_resumable([&]() -> tc::cotask<void> {
+    TC_AWAIT(store->putCacheValues(keyValues, OnConflict::Fail));
+  }));
+  futures.push_back(tc::async_resumable([&]() -> tc::cotask<void> {
+    TC_AWAIT(store->putCacheValues(conflictingKeyValues, OnConflict::Fail));
+  }));
+  futures.push_back(tc::async_resumable([&]() -> tc::cotask<void> {
+    TC_AWAIT(store->putCacheValues(keyValues2, OnConflict::Fail));
+  }));
+  auto done =
+      tc::when_all(std::make_move_iterator(futures.begin()), std::make_move_iterator(futures.end())).get();
+
+  CHECK_NOTHROW(done[0].get());
+  TANKER_CHECK_THROWS_WITH_CODE(done[1].get(), Errc::ConstraintFailed);
+  CHECK_NOTHROW(done[2].get());
+
+  auto const keys = makeKeys({"key 1", "key 2", "key 3"});
+  CacheResult expected{make_buffer("value 1"), make_buffer("value 2"), std::nullopt};
+  CHECK(AWAIT(store->findCacheValues(keys)) == expected);
+}
+
+TEST_CASE("SQLite DataStore cache bound")
+{
+  using namespace Tanker;
+  using namespace Tanker::DataStore;
+  using CacheResult = std::vector<std::optional<std::vector<uint8_t>>>;
+
+  Tanker::UniquePath testtmp{"."};
+  SqliteOptions options;
+  options.maxCacheSize = 64 * 1024;
+  SqliteBackend backend(options);
+  auto store = backend.open(testtmp.path, testtmp.path);
+
+  std::vector<uint8_t> const value(1024);
+  // Written first, but it is not fetched again when missing
+  auto const keptKey = make_buffer("provisionaluserkeys-0");
+  std::vector<std::pair<Key, Value>> const keptKeyValues{{keptKey, value}};
+  AWAIT_VOID(store->putCacheValues(keptKeyValues, OnConflict::Fail));
+  for (auto i = 0; i < 300; ++i)
+  {
+    auto const key = make_buffer(fmt::format("resourcekey-{}", i));
+    std::vector<std::pair<Key, Value>> const keyValues{{key, value}};
+    AWAIT_VOID(store->putCacheValues(keyValues, OnConflict::Fail));
+  }
+
+  auto const keys = makeKeys({"provisionaluserkeys-0", "resourcekey-0", "resourcekey-299"});
+  CacheResult expected{value, std::nullopt, value};
+  CHECK(AWAIT(store->findCacheValues(keys)) == expected);
+
+  auto const prefix = make_buffer("resourcekey-");
+  auto const usage = AWAIT(store->findCacheUsage(prefix));
+  CHECK(usage.entries > 0);
+  CHECK(usage.entries < 64);
+  CHECK(usage.bytes <= options.maxCacheSize);
+}
+
+namespace
+{
+void checkCacheUsage(Tanker::DataStore::Backend& backend)
+{
+  using namespace Tanker;
+  using namespace Tanker::DataStore;
+
+  Tanker::UniquePath testtmp{"."};
+  auto store = backend.open(testtmp.path, testtmp.path);
+
+  auto const keyValues = makeKeyValues({{"a-1", "value"}, {"a-2", "value 2"}, {"b-1", "value 3"}});
+  AWAIT_VOID(store->putCacheValues(keyValues, OnConflict::Fail));
+
+  auto const prefixA = make_buffer("a-");
+  auto const usageA = AWAIT(store->findCacheUsage(prefixA));
+  CHECK(usageA.entries == 2);
+  CHECK(usageA.bytes == 3 + 5 + 3 + 7);
+
+  auto const prefixC = make_buffer("c-");
+  auto const usageC = AWAIT(store->findCacheUsage(prefixC));
+  CHECK(usageC.entries == 0);
+  CHECK(usageC.bytes == 0);
+}
+}
+
+TEST_CASE("SQLite DataStore cache usage")
+{
+  Tanker::DataStore::SqliteBackend backend;
+  checkCacheUsage(backend);
+}
+
+TEST_CASE("Memory DataStore cache usage")
+{
+  Tanker::DataStore::MemoryBackend backend;
+  checkCacheUsage(backend);
+}
+
+TEST_CASE("Memory DataStore")
+{
+  Tanker::DataStore::MemoryBackend backend;
+  runDataStoreTests(backend, ".");
+}
+
+TEST_CASE("Memory DataStore specifics")
+{
+  using namespace Tanker;
+  using namespace Tanker::DataStore;
+  using CacheResult = std::vector<std::optional<std::vector<uint8_t>>>;
+
+  SECTION("cannot open the same database twice at once")
+  {
+    MemoryBackend backend;
+    auto store = backend.open("data", "cache");
+    TANKER_CHECK_THROWS_WITH_CODE(backend.open("data", "cache"), Errc::DatabaseLocked);
+  }
+
+  SECTION("drops the oldest evictable writes when the cache is full")
+  {
+    // Each group takes 15 bytes, the version 8
+    MemoryBackend backend({45});
+    auto store = backend.open("data", "cache");
+
+    for (auto const& [key, value] : {std::pair{"version", "1"},
+                                     std::pair{"groups-1", "value 1"},
+                                     std::pair{"groups-2", "value 2"},
+                                     std::pair{"groups-3", "value 3"},
+                                     std::pair{"groups-4", "value 4"}})
+    {
+      auto const keyValues = makeKeyValues({{key, value}});
+      AWAIT_VOID(store->putCacheValues(keyValues, OnConflict::Fail));
+    }
+
+    // The version is older, but it is not fetched again when missing
+    auto const keys = makeKeys({"version", "groups-1", "groups-2", "groups-3", "groups-4"});
+    CacheResult expected{
+        make_buffer("1"), std::nullopt, std::nullopt, make_buffer("value 3"), make_buffer("value 4")};
+    CHECK(AWAIT(store->findCacheValues(keys)) == expected);
+  }
+
+  SECTION("keeps all the values of a put that is bigger than the bound")
+  {
+    MemoryBackend backend({12});
+    auto store = backend.open("data", "cache");
+
+    auto const keyValues = makeKeyValues({{"groups-1", "value 1"}, {"groups-2", "value 2"}});
+    AWAIT_VOID(store->putCacheValues(keyValues, OnConflict::Fail));
+
+    auto const keys = makeKeys({"groups-1", "groups-2"});
+    CacheResult expected{make_buffer("value 1"), make_buffer("value 2")};
+    CHECK(AWAIT(store->findCacheValues(keys)) == expected);
+  }
+
+  SECTION("keeps the values after replacing many of them")
+  {
+    MemoryBackend backend;
+    auto store = backend.open("data", "cache");
+
+    // Enough writes to go through several arena compactions
+    std::vector<uint8_t> bigValue(10000);
+    auto const key = make_buffer("key");
+    for (auto i = 0; i < 100; ++i)
+    {
+      bigValue[0] = static_cast<uint8_t>(i);
+      std::vector<std::pair<Key, Value>> const keyValues{{key, bigValue}};
+      AWAIT_VOID(store->putCacheValues(keyValues, OnConflict::Replace));
+    }
+
+    auto const keys = makeKeys({"key"});
+    CacheResult expected{bigValue};
+    CHECK(AWAIT(store->findCacheValues(keys)) == expected);
+  }
+}
@@ -1,3 +1,4 @@
+#include <Tanker/Actions/Deduplicate.hpp>
 #include <Tanker/Crypto/Format/Format.hpp>
 #include <Tanker/DataStore/Sqlite/Backend.hpp>
 #include <Tanker/Groups/Accessor.hpp>
@@ -167,4 +168,80 @@ TEST_CASE("GroupAccessor")
       }
     }
   }
+
+  SECTION("refresh a stored group")
+  {
+    auto group = alice.makeGroup();
+    InternalGroup storedGroup = group;
+    group.addUsers(alice.devices().back(), {bob});
+    REQUIRE_CALL(requestStub, getGroupBlocks(std::vector<GroupId>{group.id()})).RETURN(makeCoTask(makeEntries(group)));
+    REQUIRE_CALL(aliceProvisionalUsersAccessor, refreshKeys())
+#if TCONCURRENT_COROUTINES_TS
+        .LR_RETURN(makeCoTask());
+#else
+        ;
+#endif
+
+    SECTION("it should only process the blocks after the stored head")
+    {
+      AWAIT_VOID(groupStore.put(storedGroup));
+      REQUIRE_CALL(aliceUserAccessorMock, pull(std::vector{alice.devices().back().id()}))
+          .RETURN(makeCoTask(BasicPullResult<Users::Device, Trustchain::DeviceId>{{alice.devices().back()}, {}}));
+
+      auto const result = AWAIT(groupAccessor.getInternalGroup(group.id()));
+
+      CHECK(result == group);
+      CHECK(AWAIT(groupStore.findById(group.id())) == Group{result});
+    }
+
+    SECTION("it should replay the whole history if the stored head is not in it")
+    {
+      storedGroup.lastBlockHash = make<Crypto::Hash>("unknown block");
+      AWAIT_VOID(groupStore.put(storedGroup));
+      auto const la = static_cast<Users::LocalUser>(alice);
+      REQUIRE_CALL(aliceLocalAccessorMock, get()).LR_RETURN(la);
+      REQUIRE_CALL(aliceLocalAccessorMock, pullUserKeyPair(alice.userKeys().back().publicKey))
+          .LR_RETURN(makeCoTask(std::make_optional(alice.userKeys().back())));
+      REQUIRE_CALL(aliceUserAccessorMock,
+                   pull(std::vector{alice.devices().back().id()}))
+          .RETURN(makeCoTask(BasicPullResult<Users::Device, Trustchain::DeviceId>{{alice.devices().back()}, {}}));
+
+      auto const result = AWAIT(groupAccessor.getInternalGroup(group.id()));
+
+      CHECK(result == group);
+    }
+  }
+
+  SECTION("it should pull the authors of several groups at once")
+  {
+    auto groupIds = std::vector{aliceGroup.id(), bobGroup.id()};
+    groupIds |= Actions::deduplicate;
+    auto authorIds = std::vector{alice.devices().back().id(), bob.devices().back().id()};
+    authorIds |= Actions::deduplicate;
+    auto entries = makeEntries(aliceGroup);
+    auto const bobEntries = makeEntries(bobGroup);
+    entries.insert(entries.end(), bobEntries.begin(), bobEntries.end());
+
+    auto const la = static_cast<Users::LocalUser>(alice);
+    REQUIRE_CALL(aliceLocalAccessorMock, get()).LR_RETURN(la).TIMES(AT_LEAST(1));
+    REQUIRE_CALL(requestStub, getGroupBlocks(groupIds)).RETURN(makeCoTask(entries));
+    REQUIRE_CALL(aliceUserAccessorMock, pull(authorIds))
+        .RETURN(makeCoTask(
+            BasicPullResult<Users::Device, Trustchain::DeviceId>{{alice.devices().back(), bob.devices().back()}, {}}));
+    REQUIRE_CALL(aliceLocalAccessorMock, pullUserKeyPair(alice.userKeys().back().publicKey))
+        .LR_RETURN(makeCoTask(std::make_optional(alice.userKeys().back())));
+    REQUIRE_CALL(aliceProvisionalUsersAccessor, refreshKeys())
+#if TCONCURRENT_COROUTINES_TS
+        .LR_RETURN(makeCoTask());
+#else
+        ;
+#endif
+
+    auto const result = AWAIT(groupAccessor.getPublicEncryptionKeys({aliceGroup.id(), bobGroup.id()}));
+
+    CHECK(result.notFound.empty());
+    CHECK(result.found.size() == 2);
+    CHECK(AWAIT(groupStore.findById(aliceGroup.id())) == Group{static_cast<InternalGroup>(aliceGroup)});
+    CHECK(AWAIT(groupStore.findById(bobGroup.id())) == Group{static_cast<ExternalGroup>(bobGroup)});
+  }
 }
@@ -5,6 +5,7 @@
 #include <Tanker/Identity/PublicPermanentIdentity.hpp>
 #include <Tanker/Identity/SecretProvisionalIdentity.hpp>
 #include <Tanker/Trustchain/UserId.hpp>
+#include <Tanker/WorkerPool.hpp>
 
 #include <Helpers/Await.hpp>
 #include <Helpers/Errors.hpp>
@@ -13,6 +14,9 @@
 #include "TrustchainGenerator.hpp"
 #include "UserAccessorMock.hpp"
 
+#include <fmt/format.h>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <trompeloeil.hpp>
 
@@ -35,13 +39,13 @@ TEST_CASE("Can't create an empty group")
   auto const userDevice = user.devices().front();
 
   TANKER_CHECK_THROWS_WITH_CODE(
-      Groups::Manager::makeUserGroupCreationAction({},
-                                                   {},
-                                                   Crypto::makeSignatureKeyPair(),
-                                                   Crypto::makeEncryptionKeyPair(),
-                                                   generator.context().id(),
-                                                   userDevice.id(),
-                                                   userDevice.keys().signatureKeyPair.privateKey),
+      AWAIT(Groups::Manager::makeUserGroupCreationAction({},
+                                                         {},
+                                                         Crypto::makeSignatureKeyPair(),
+                                                         Crypto::makeEncryptionKeyPair(),
+                                                         generator.context().id(),
+                                                         userDevice.id(),
+                                                         userDevice.keys().signatureKeyPair.privateKey)),
       Errc::InvalidArgument);
 }
 
@@ -56,13 +60,14 @@ TEST_CASE("Can create a group with two users")
   auto groupEncryptionKey = Crypto::makeEncryptionKeyPair();
   auto groupSignatureKey = Crypto::makeSignatureKeyPair();
 
-  auto const action = Groups::Manager::makeUserGroupCreationAction({user, user2},
-                                                                   {},
-                                                                   groupSignatureKey,
-                                                                   groupEncryptionKey,
-                                                                   generator.context().id(),
-                                                                   userDevice.id(),
-                                                                   userDevice.keys().signatureKeyPair.privateKey);
+  auto const action =
+      AWAIT(Groups::Manager::makeUserGroupCreationAction({user, user2},
+                                                         {},
+                                                         groupSignatureKey,
+                                                         groupEncryptionKey,
+                                                         generator.context().id(),
+                                                         userDevice.id(),
+                                                         userDevice.keys().signatureKeyPair.privateKey));
 
   auto group = action.get<UserGroupCreation::v3>();
 
@@ -93,13 +98,14 @@ TEST_CASE("Can create a group with two provisional users")
   auto groupEncryptionKey = Crypto::makeEncryptionKeyPair();
   auto groupSignatureKey = Crypto::makeSignatureKeyPair();
 
-  auto const action = Groups::Manager::makeUserGroupCreationAction({},
-                                                                   {provisionalUser, provisionalUser2},
-                                                                   groupSignatureKey,
-                                                                   groupEncryptionKey,
-                                                                   generator.context().id(),
-                                                                   userDevice.id(),
-                                                                   userDevice.keys().signatureKeyPair.privateKey);
+  auto const action =
+      AWAIT(Groups::Manager::makeUserGroupCreationAction({},
+                                                         {provisionalUser, provisionalUser2},
+                                                         groupSignatureKey,
+                                                         groupEncryptionKey,
+                                                         generator.context().id(),
+                                                         userDevice.id(),
+                                                         userDevice.keys().signatureKeyPair.privateKey));
 
   auto group = action.get<UserGroupCreation::v3>();
 
@@ -121,6 +127,92 @@ TEST_CASE("Can create a group with two provisional users")
   CHECK(selfSignature == group.selfSignature());
 }
 
+TEST_CASE("Group member keys sealed on a worker pool are in the order of the members")
+{
+  Test::Generator generator;
+  auto const user = generator.makeUser("user");
+  auto const userDevice = user.devices().front();
+
+  std::vector<Users::User> users;
+  for (auto i = 0; i < 10; ++i)
+    users.push_back(generator.makeUser(fmt::format("user{}", i)));
+  std::vector<ProvisionalUsers::PublicUser> provisionalUsers;
+  std::vector<Test::ProvisionalUser> secretProvisionalUsers;
+  for (auto i = 0; i < 5; ++i)
+  {
+    secretProvisionalUsers.push_back(generator.makeProvisionalUser(fmt::format("user{}@tanker", i)));
+    provisionalUsers.push_back(secretProvisionalUsers.back());
+  }
+
+  auto groupEncryptionKey = Crypto::makeEncryptionKeyPair();
+  WorkerPool workerPool(4);
+
+  auto const action =
+      AWAIT(Groups::Manager::makeUserGroupCreationAction(users,
+                                                         provisionalUsers,
+                                                         Crypto::makeSignatureKeyPair(),
+                                                         groupEncryptionKey,
+                                                         generator.context().id(),
+                                                         userDevice.id(),
+                                                         userDevice.keys().signatureKeyPair.privateKey,
+                                                         &workerPool));
+
+  auto group = action.get<UserGroupCreation::v3>();
+  REQUIRE(group.members().size() == users.size());
+  for (auto i = 0u; i < users.size(); ++i)
+  {
+    CHECK(group.members()[i].userId() == users[i].id());
+    CHECK(group.members()[i].userPublicKey() == *users[i].userKey());
+  }
+  REQUIRE(group.provisionalMembers().size() == provisionalUsers.size());
+  for (auto i = 0u; i < provisionalUsers.size(); ++i)
+  {
+    auto const& member = group.provisionalMembers()[i];
+    CHECK(member.appPublicSignatureKey() == provisionalUsers[i].appSignaturePublicKey());
+    CHECK(Crypto::sealDecrypt(Crypto::sealDecrypt(member.encryptedPrivateEncryptionKey(),
+                                                  secretProvisionalUsers[i].tankerEncryptionKeyPair()),
+                              secretProvisionalUsers[i].appEncryptionKeyPair()) == groupEncryptionKey.privateKey);
+  }
+}
+
+TEST_CASE("Group creation with the maximum number of members", "[.][benchmark]")
+{
+  Test::Generator generator;
+  auto const user = generator.makeUser("user");
+  auto const userDevice = user.devices().front();
+
+  auto const nbProvisionalUsers = 100u;
+  std::vector<Users::User> users;
+  for (auto i = 0u; i < Groups::Manager::MAX_GROUP_SIZE - nbProvisionalUsers; ++i)
+    users.push_back(generator.makeUser(fmt::format("user{}", i)));
+  std::vector<ProvisionalUsers::PublicUser> provisionalUsers;
+  for (auto i = 0u; i < nbProvisionalUsers; ++i)
+    provisionalUsers.push_back(generator.makeProvisionalUser(fmt::format("user{}@tanker", i)));
+
+  auto const makeAction = [&](WorkerPool* workerPool) {
+    return AWAIT(Groups::Manager::makeUserGroupCreationAction(users,
+                                                              provisionalUsers,
+                                                              Crypto::makeSignatureKeyPair(),
+                                                              Crypto::makeEncryptionKeyPair(),
+                                                              generator.context().id(),
+                                                              userDevice.id(),
+                                                              userDevice.keys().signatureKeyPair.privateKey,
+                                                              workerPool));
+  };
+
+  BENCHMARK("create a group of 1000 members")
+  {
+    return makeAction(nullptr);
+  };
+
+  WorkerPool workerPool(4);
+
+  BENCHMARK("create a group of 1000 members on 4 threads")
+  {
+    return makeAction(&workerPool);
+  };
+}
+
 TEST_CASE("throws when getting keys of an unknown member")
 {
   auto const unknownIdentity = Identity::PublicPermanentIdentity{
@@ -155,8 +247,8 @@ TEST_CASE("Fails to add 0 users to a group")
   InternalGroup const group{};
 
   TANKER_CHECK_THROWS_WITH_CODE(
-      Groups::Manager::makeUserGroupAdditionAction(
-          {}, {}, group, generator.context().id(), userDevice.id(), userDevice.keys().signatureKeyPair.privateKey),
+      AWAIT(Groups::Manager::makeUserGroupAdditionAction(
+          {}, {}, group, generator.context().id(), userDevice.id(), userDevice.keys().signatureKeyPair.privateKey)),
       Errc::InvalidArgument);
 }
 
@@ -170,12 +262,13 @@ TEST_CASE("Can add users to a group")
 
   auto const group = user.makeGroup({user2});
 
-  auto const action = Groups::Manager::makeUserGroupAdditionAction({user, user2},
-                                                                   {},
-                                                                   group,
-                                                                   generator.context().id(),
-                                                                   userDevice.id(),
-                                                                   userDevice.keys().signatureKeyPair.privateKey);
+  auto const action =
+      AWAIT(Groups::Manager::makeUserGroupAdditionAction({user, user2},
+                                                         {},
+                                                         group,
+                                                         generator.context().id(),
+                                                         userDevice.id(),
+                                                         userDevice.keys().signatureKeyPair.privateKey));
 
   auto groupAdd = action.get<UserGroupAddition::v3>();
 
@@ -205,12 +298,13 @@ TEST_CASE("Can add provisional users to a group")
   auto const provisionalUser = generator.makeProvisionalUser("bob@tanker");
   auto const provisionalUser2 = generator.makeProvisionalUser("charlie@tanker");
 
-  auto const action = Groups::Manager::makeUserGroupAdditionAction({},
-                                                                   {provisionalUser, provisionalUser2},
-                                                                   group,
-                                                                   generator.context().id(),
-                                                                   userDevice.id(),
-                                                                   userDevice.keys().signatureKeyPair.privateKey);
+  auto const action =
+      AWAIT(Groups::Manager::makeUserGroupAdditionAction({},
+                                                         {provisionalUser, provisionalUser2},
+                                                         group,
+                                                         generator.context().id(),
+                                                         userDevice.id(),
+                                                         userDevice.keys().signatureKeyPair.privateKey));
 
   auto groupAdd = action.get<UserGroupAddition::v3>();
 
@@ -7,6 +7,7 @@
 
 #include "LocalUserAccessorMock.hpp"
 #include "ProvisionalUsersAccessorMock.hpp"
+#include "UserAccessorMock.hpp"
 
 #include "TrustchainGenerator.hpp"
 
@@ -333,3 +334,44 @@ TEST_CASE("Group V3")
     }
   }
 }
+
+TEST_CASE("processGroupsEntries")
+{
+  Test::Generator generator;
+  auto const alice = generator.makeUser("alice");
+  auto const bob = generator.makeUser("bob");
+  auto aliceLocalUserAccessor = LocalUserAccessorMock{};
+  auto aliceUserAccessor = UserAccessorMock{};
+  auto aliceProvisionalUsersAccessor = ProvisionalUsersAccessorMock{};
+
+  auto const aliceLocalUser = static_cast<Users::LocalUser>(alice);
+
+  REQUIRE_CALL(aliceLocalUserAccessor, get()).LR_RETURN(aliceLocalUser).TIMES(AT_LEAST(0));
+  REQUIRE_CALL(aliceUserAccessor, pull(std::vector{bob.devices().front().id()}))
+      .RETURN(makeCoTask(BasicPullResult<Users::Device, Trustchain::DeviceId>{{bob.devices().front()}, {}}));
+  REQUIRE_CALL(aliceProvisionalUsersAccessor, refreshKeys())
+#if TCONCURRENT_COROUTINES_TS
+      .LR_RETURN(makeCoTask());
+#else
+      ;
+#endif
+
+  SECTION("pulls the local user once for all the groups I am *not* part of")
+  {
+    auto const bobGroup1 = generator.makeGroupV1(bob.devices().front(), {bob});
+    auto const bobGroup2 = generator.makeGroupV1(bob.devices().front(), {bob});
+    auto const entries1 = makeEntries(bobGroup1);
+    auto const entries2 = makeEntries(bobGroup2);
+    std::vector<GroupUpdater::GroupEntries> const groups{{std::nullopt, entries1}, {std::nullopt, entries2}};
+
+    REQUIRE_CALL(aliceLocalUserAccessor, pull()).LR_RETURN(makeCoTask<Users::LocalUser const&>(aliceLocalUser));
+    auto const resultGroups = AWAIT(GroupUpdater::processGroupsEntries(
+        aliceLocalUserAccessor, aliceUserAccessor, aliceProvisionalUsersAccessor, groups));
+
+    REQUIRE(resultGroups.size() == 2);
+    REQUIRE(resultGroups[0].has_value());
+    REQUIRE(resultGroups[1].has_value());
+    GroupMatcher<ExternalGroup>(*resultGroups[0], bobGroup1);
+    GroupMatcher<ExternalGroup>(*resultGroups[1], bobGroup2);
+  }
+}
@@ -0,0 +1,85 @@
+#include <Tanker/Network/Backend.hpp>
+#include <Tanker/Network/HttpClient.hpp>
+
+#include <Helpers/Await.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <tconcurrent/async.hpp>
+#include <tconcurrent/async_wait.hpp>
+#include <tconcurrent/when.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace Tanker;
+using namespace Tanker::Network;
+using namespace std::chrono_literals;
+
+namespace
+{
+// Counts the requests that are being fetched at the same time
+class CountingBackend : public Backend
+{
+public:
+  int running = 0;
+  int maxRunning = 0;
+  int nbFetched = 0;
+
+  tc::cotask<HttpResponse> fetch(HttpRequest) override
+  {
+    maxRunning = std::max(maxRunning, ++running);
+    TC_AWAIT(tc::async_wait(1ms));
+    --running;
+    ++nbFetched;
+    TC_RETURN((HttpResponse{204, {}, {}}));
+  }
+};
+
+void fetchConcurrently(HttpClient& client, int nbRequests)
+{
+  AWAIT_VOID([&]() -> tc::cotask<void> {
+    std::vector<tc::future<void>> futures;
+    for (auto i = 0; i < nbRequests; ++i)
+      futures.push_back(tc::async_resumable([&]() -> tc::cotask<void> { TC_AWAIT(client.asyncUnauthGet("route")); }));
+    auto done =
+        TC_AWAIT(tc::when_all(std::make_move_iterator(futures.begin()), std::make_move_iterator(futures.end())));
+    for (auto& future : done)
+      future.get();
+  }());
+}
+}
+
+TEST_CASE("HttpClient concurrency")
+{
+  SdkInfo const info{"test", {}, "0.0.0"};
+  CountingBackend backend;
+
+  SECTION("sends at most DefaultConcurrentRequestCount requests at once by default")
+  {
+    HttpClient client("https://example.com", "instance", &backend, info);
+
+    fetchConcurrently(client, 10);
+
+    CHECK(backend.nbFetched == 10);
+    CHECK(backend.maxRunning == static_cast<int>(DefaultConcurrentRequestCount));
+  }
+
+  SECTION("sends at most the configured number of requests at once")
+  {
+    HttpClient client("https://example.com", "instance", &backend, info, 2);
+
+    fetchConcurrently(client, 10);
+
+    CHECK(backend.nbFetched == 10);
+    CHECK(backend.maxRunning == 2);
+  }
+
+  SECTION("rejects a concurrency of zero")
+  {
+    CHECK_THROWS(HttpClient("https://example.com", "instance", &backend, info, 0));
+  }
+}
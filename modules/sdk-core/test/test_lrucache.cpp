@@ -0,0 +1,79 @@
+#include <Tanker/LruCache.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace Tanker;
+
+TEST_CASE("LruCache")
+{
+  LruCache<int, std::string> cache(2);
+
+  SECTION("it returns nothing for an unknown key")
+  {
+    CHECK(cache.get(1) == nullptr);
+    CHECK(cache.stats().misses == 1);
+    CHECK(cache.stats().hits == 0);
+  }
+
+  SECTION("it returns a value that was put")
+  {
+    cache.put(1, "one");
+    auto const value = cache.get(1);
+    REQUIRE(value);
+    CHECK(*value == "one");
+    CHECK(cache.stats().hits == 1);
+  }
+
+  SECTION("it replaces the value of an existing key")
+  {
+    cache.put(1, "one");
+    cache.put(1, "uno");
+    CHECK(cache.size() == 1);
+    CHECK(*cache.get(1) == "uno");
+  }
+
+  SECTION("it evicts the least recently used value")
+  {
+    cache.put(1, "one");
+    cache.put(2, "two");
+    cache.get(1);
+    cache.put(3, "three");
+
+    CHECK(cache.size() == 2);
+    CHECK(cache.get(1));
+    CHECK(cache.get(2) == nullptr);
+    CHECK(cache.get(3));
+  }
+
+  SECTION("it drops values that are no longer valid")
+  {
+    cache.put(1, "one");
+    CHECK(cache.get(1, [](auto const& value) { return value != "one"; }) == nullptr);
+    CHECK(cache.size() == 0);
+    CHECK(cache.stats().misses == 1);
+  }
+
+  SECTION("it calls the drop handler on every value leaving the cache")
+  {
+    std::vector<std::string> dropped;
+    {
+      LruCache<int, std::string> wiped(2, [&](std::string& value) { dropped.push_back(value); });
+      wiped.put(1, "one");
+      wiped.put(1, "uno");
+      wiped.put(2, "two");
+      wiped.put(3, "three");
+      wiped.erase(2);
+    }
+    CHECK(dropped == std::vector<std::string>{"one", "uno", "two", "three"});
+  }
+
+  SECTION("it stores nothing when its capacity is 0")
+  {
+    LruCache<int, std::string> disabled(0);
+    disabled.put(1, "one");
+    CHECK(disabled.get(1) == nullptr);
+  }
+}
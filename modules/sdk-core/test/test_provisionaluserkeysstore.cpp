@@ -79,4 +79,24 @@ TEST_CASE("ProvisionalUserKeysStore")
     CHECK(appKeys == gotKeyPair->appKeys);
     CHECK(tankerKeys == gotKeyPair->tankerKeys);
   }
+
+  SECTION("it should not find a last claim hash in an empty store")
+  {
+    ProvisionalUserKeysStore store({}, db.get());
+    CHECK(!AWAIT(store.findLastClaimHash()));
+  }
+
+  SECTION("it should replace the last claim hash")
+  {
+    auto const firstHash = make<Crypto::Hash>("first claim");
+    auto const secondHash = make<Crypto::Hash>("second claim");
+
+    ProvisionalUserKeysStore store({}, db.get());
+
+    AWAIT_VOID(store.putLastClaimHash(firstHash));
+    CHECK(AWAIT(store.findLastClaimHash()) == firstHash);
+
+    AWAIT_VOID(store.putLastClaimHash(secondHash));
+    CHECK(AWAIT(store.findLastClaimHash()) == secondHash);
+  }
 }
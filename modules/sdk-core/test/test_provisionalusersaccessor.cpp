@@ -0,0 +1,233 @@
+#include <Tanker/ProvisionalUsers/Accessor.hpp>
+
+#include <Tanker/DataStore/Sqlite/Backend.hpp>
+#include <Tanker/Errors/Errc.hpp>
+#include <Tanker/Errors/Exception.hpp>
+#include <Tanker/ProvisionalUsers/ProvisionalUserKeysStore.hpp>
+
+#include <Helpers/Await.hpp>
+#include <Helpers/Buffers.hpp>
+#include <Helpers/Errors.hpp>
+#include <Helpers/MakeCoTask.hpp>
+
+#include "LocalUserAccessorMock.hpp"
+#include "ProvisionalUsersRequesterStub.hpp"
+#include "TrustchainGenerator.hpp"
+#include "UserAccessorMock.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <tconcurrent/async.hpp>
+#include <tconcurrent/async_wait.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <string_view>
+
+using namespace Tanker;
+using namespace std::chrono_literals;
+using Trustchain::Actions::ProvisionalIdentityClaim;
+
+namespace
+{
+// Fails the puts of provisional user keys when failKeyPuts is set
+class FailingDataStore : public Tanker::DataStore::DataStore
+{
+public:
+  bool failKeyPuts = false;
+
+  explicit FailingDataStore(Tanker::DataStore::DataStore* db) : _db(db)
+  {
+  }
+
+  tc::cotask<void> nuke() override
+  {
+    TC_AWAIT(_db->nuke());
+  }
+
+  tc::cotask<void> putSerializedDevice(gsl::span<uint8_t const> device) override
+  {
+    TC_AWAIT(_db->putSerializedDevice(device));
+  }
+
+  tc::cotask<std::optional<std::vector<uint8_t>>> findSerializedDevice() override
+  {
+    TC_RETURN(TC_AWAIT(_db->findSerializedDevice()));
+  }
+
+  tc::cotask<void> putCacheValues(gsl::span<std::pair<Key, Value> const> keyValues,
+                                  Tanker::DataStore::OnConflict onConflict) override
+  {
+    std::string_view const keyPrefix = "provisionaluserkeys-";
+    auto const isKeyPut = std::any_of(keyValues.begin(), keyValues.end(), [&](auto const& keyValue) {
+      auto const& key = keyValue.first;
+      return key.size() >= keyPrefix.size() && std::equal(keyPrefix.begin(), keyPrefix.end(), key.begin());
+    });
+    if (failKeyPuts && isKeyPut)
+      throw Errors::Exception(make_error_code(Errors::Errc::IOError), "provisional user keys put failed");
+    TC_AWAIT(_db->putCacheValues(keyValues, onConflict));
+  }
+
+  tc::cotask<std::vector<std::optional<std::vector<uint8_t>>>> findCacheValues(gsl::span<Key const> keys) override
+  {
+    TC_RETURN(TC_AWAIT(_db->findCacheValues(keys)));
+  }
+
+private:
+  Tanker::DataStore::DataStore* _db;
+};
+
+tc::cotask<std::vector<ProvisionalIdentityClaim>> delayedClaims(std::vector<ProvisionalIdentityClaim> claims)
+{
+  TC_AWAIT(tc::async_wait(1ms));
+  TC_RETURN(claims);
+}
+
+auto deviceIds(std::vector<ProvisionalIdentityClaim> const& claims)
+{
+  std::vector<Trustchain::DeviceId> ids;
+  for (auto const& claim : claims)
+    ids.emplace_back(claim.author());
+  return ids;
+}
+}
+
+TEST_CASE("ProvisionalUsers::Accessor::claimsAfter")
+{
+  Test::Generator generator;
+  auto const alice = generator.makeUser("alice");
+  std::vector<ProvisionalIdentityClaim> const claims{
+      alice.claim(generator.makeProvisionalUser("alice1@tanker.io")),
+      alice.claim(generator.makeProvisionalUser("alice2@tanker.io")),
+      alice.claim(generator.makeProvisionalUser("alice3@tanker.io")),
+  };
+
+  SECTION("returns all the claims when there is no last claim hash")
+  {
+    auto const newClaims = ProvisionalUsers::Accessor::claimsAfter(claims, std::nullopt);
+    CHECK(newClaims.size() == claims.size());
+  }
+
+  SECTION("returns all the claims when the last claim hash is not found")
+  {
+    auto const newClaims = ProvisionalUsers::Accessor::claimsAfter(claims, make<Crypto::Hash>("unknown"));
+    CHECK(newClaims.size() == claims.size());
+  }
+
+  SECTION("returns the claims after the last claim hash")
+  {
+    auto const newClaims = ProvisionalUsers::Accessor::claimsAfter(claims, claims.front().hash());
+    REQUIRE(newClaims.size() == 2);
+    CHECK(newClaims[0].hash() == claims[1].hash());
+    CHECK(newClaims[1].hash() == claims[2].hash());
+  }
+
+  SECTION("returns no claims when the last claim hash is the last claim")
+  {
+    auto const newClaims = ProvisionalUsers::Accessor::claimsAfter(claims, claims.back().hash());
+    CHECK(newClaims.empty());
+  }
+}
+
+TEST_CASE("ProvisionalUsers::Accessor::refreshKeys")
+{
+  Test::Generator generator;
+  auto const alice = generator.makeUser("alice");
+  auto const aliceLocalUser = static_cast<Users::LocalUser>(alice);
+  auto const aliceDevice = static_cast<Users::Device>(alice.devices().back());
+  auto const aliceUserKeyPair = alice.userKeys().back();
+
+  auto const provisionalUser1 = generator.makeProvisionalUser("alice1@tanker.io");
+  auto const provisionalUser2 = generator.makeProvisionalUser("alice2@tanker.io");
+  auto const claim1 = alice.claim(provisionalUser1);
+  auto const claim2 = alice.claim(provisionalUser2);
+
+  auto db = DataStore::SqliteBackend().open(DataStore::MemoryPath, DataStore::MemoryPath);
+  FailingDataStore failingDb(db.get());
+  ProvisionalUserKeysStore store({}, &failingDb);
+
+  ProvisionalUsersRequesterStub requester;
+  UserAccessorMock userAccessor;
+  LocalUserAccessorMock localUserAccessor;
+  ProvisionalUsers::Accessor accessor(&requester, &userAccessor, &localUserAccessor, &store);
+
+  ALLOW_CALL(localUserAccessor, get()).LR_RETURN(aliceLocalUser);
+  ALLOW_CALL(localUserAccessor, pullUserKeyPair(aliceUserKeyPair.publicKey))
+      .RETURN(makeCoTask(std::make_optional(aliceUserKeyPair)));
+
+  auto const findKeys = [&](Test::ProvisionalUser const& provisionalUser) {
+    return AWAIT(store.findProvisionalUserKeys(provisionalUser.appSignatureKeyPair().publicKey,
+                                               provisionalUser.tankerSignatureKeyPair().publicKey));
+  };
+
+  SECTION("only processes the claims after the last one processed")
+  {
+    {
+      std::vector const claims{claim1};
+      REQUIRE_CALL(requester, getClaimBlocks(alice.id())).RETURN(makeCoTask(claims));
+      REQUIRE_CALL(userAccessor, pull(deviceIds(claims)))
+          .RETURN(makeCoTask(Users::IUserAccessor::DevicePullResult{{aliceDevice}, {}}));
+      AWAIT_VOID(accessor.refreshKeys());
+    }
+    CHECK(AWAIT(store.findLastClaimHash()) == claim1.hash());
+
+    {
+      std::vector const claims{claim1, claim2};
+      REQUIRE_CALL(requester, getClaimBlocks(alice.id())).RETURN(makeCoTask(claims));
+      REQUIRE_CALL(userAccessor, pull(deviceIds({claim2})))
+          .RETURN(makeCoTask(Users::IUserAccessor::DevicePullResult{{aliceDevice}, {}}));
+      AWAIT_VOID(accessor.refreshKeys());
+    }
+    CHECK(AWAIT(store.findLastClaimHash()) == claim2.hash());
+    CHECK(findKeys(provisionalUser1).has_value());
+    CHECK(findKeys(provisionalUser2).has_value());
+  }
+
+  SECTION("does not process any claim when the last one was processed")
+  {
+    AWAIT_VOID(store.putLastClaimHash(claim2.hash()));
+
+    REQUIRE_CALL(requester, getClaimBlocks(alice.id())).RETURN(makeCoTask(std::vector{claim1, claim2}));
+    FORBID_CALL(userAccessor, pull(ANY(std::vector<Trustchain::DeviceId>)));
+    AWAIT_VOID(accessor.refreshKeys());
+
+    CHECK(!findKeys(provisionalUser1));
+  }
+
+  SECTION("does not put the last claim hash when the keys cannot be put")
+  {
+    std::vector const claims{claim1, claim2};
+    REQUIRE_CALL(requester, getClaimBlocks(alice.id())).RETURN(makeCoTask(claims)).TIMES(2);
+    REQUIRE_CALL(userAccessor, pull(deviceIds(claims)))
+        .RETURN(makeCoTask(Users::IUserAccessor::DevicePullResult{{aliceDevice}, {}}))
+        .TIMES(2);
+
+    failingDb.failKeyPuts = true;
+    TANKER_CHECK_THROWS_WITH_CODE(AWAIT_VOID(accessor.refreshKeys()), Errors::Errc::IOError);
+    CHECK(!AWAIT(store.findLastClaimHash()));
+
+    // All the claims are processed again
+    failingDb.failKeyPuts = false;
+    AWAIT_VOID(accessor.refreshKeys());
+    CHECK(AWAIT(store.findLastClaimHash()) == claim2.hash());
+    CHECK(findKeys(provisionalUser1).has_value());
+    CHECK(findKeys(provisionalUser2).has_value());
+  }
+
+  SECTION("coalesces concurrent refreshes into a single fetch")
+  {
+    std::vector const claims{claim1};
+    REQUIRE_CALL(requester, getClaimBlocks(alice.id())).RETURN(delayedClaims(claims));
+    REQUIRE_CALL(userAccessor, pull(deviceIds(claims)))
+        .RETURN(makeCoTask(Users::IUserAccessor::DevicePullResult{{aliceDevice}, {}}));
+
+    AWAIT_VOID([&]() -> tc::cotask<void> {
+      auto first = tc::async_resumable([&]() -> tc::cotask<void> { TC_AWAIT(accessor.refreshKeys()); });
+      auto second = tc::async_resumable([&]() -> tc::cotask<void> { TC_AWAIT(accessor.refreshKeys()); });
+      TC_AWAIT(std::move(first));
+      TC_AWAIT(std::move(second));
+    }());
+
+    CHECK(findKeys(provisionalUser1).has_value());
+  }
+}
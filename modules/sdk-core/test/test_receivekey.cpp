@@ -83,3 +83,43 @@ TEST_CASE("decryptAndStoreKey")
   }
   CHECK(AWAIT(resourceKeyStore.getKey(resource.id())) == resource.key());
 }
+
+TEST_CASE("decryptAndStoreKeys")
+{
+  Test::Generator generator;
+  auto const receiver = generator.makeUser("receiver");
+  auto const sender = generator.makeUser("sender");
+  auto const& senderDevice = sender.devices().front();
+
+  auto const resource = Test::Resource();
+  auto const resource2 = Test::Resource();
+
+  auto db = DataStore::SqliteBackend().open(":memory:", ":memory:");
+
+  ResourceKeys::Store resourceKeyStore({}, db.get());
+  GroupAccessorMock receiverGroupAccessor;
+  LocalUserAccessorMock receiverLocalUserAccessor;
+  ProvisionalUsersAccessorMock receiverProvisionalUsersAccessor;
+
+  auto const group = receiver.makeGroup();
+  std::vector<Trustchain::KeyPublishAction> const keyPublishes{
+      generator.shareWith(senderDevice, receiver, resource),
+      generator.shareWith(senderDevice, group, resource2),
+  };
+
+  REQUIRE_CALL(receiverLocalUserAccessor, pullUserKeyPair(receiver.userKeys().back().publicKey))
+      .RETURN(makeCoTask(std::make_optional(receiver.userKeys().back())));
+  REQUIRE_CALL(receiverGroupAccessor, getEncryptionKeyPair(trompeloeil::_))
+      .LR_RETURN(makeCoTask(std::make_optional(group.currentEncKp())));
+
+  auto const results = AWAIT(ReceiveKey::decryptAndStoreKeys(resourceKeyStore,
+                                                             receiverLocalUserAccessor,
+                                                             receiverGroupAccessor,
+                                                             receiverProvisionalUsersAccessor,
+                                                             keyPublishes));
+
+  ResourceKeys::KeysResult const expected{{resource.key(), resource.id()}, {resource2.key(), resource2.id()}};
+  CHECK(results == expected);
+  std::vector<Crypto::SimpleResourceId> const resourceIds{resource.id(), resource2.id()};
+  CHECK(AWAIT(resourceKeyStore.findKeys(resourceIds)) == expected);
+}
@@ -0,0 +1,56 @@
+#include <Tanker/ResourceKeys/Accessor.hpp>
+#include <Tanker/ResourceKeys/Store.hpp>
+
+#include <Tanker/DataStore/Sqlite/Backend.hpp>
+
+#include <Helpers/Await.hpp>
+#include <Helpers/Buffers.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace Tanker;
+
+TEST_CASE("Resource Keys Accessor")
+{
+  auto db = DataStore::SqliteBackend().open(DataStore::MemoryPath, DataStore::MemoryPath);
+  ResourceKeys::Store store({}, db.get());
+
+  auto const resourceId = make<Crypto::SimpleResourceId>("mymac");
+  auto const key = make<Crypto::SymmetricKey>("mykey");
+  AWAIT_VOID(store.putKey(resourceId, key));
+
+  // Keys are all in the store, so nothing is fetched from the server
+  ResourceKeys::Accessor accessor(nullptr, nullptr, nullptr, nullptr, &store);
+
+  SECTION("it keeps keys found in the store in memory")
+  {
+    CHECK(AWAIT(accessor.findKey(resourceId)) == key);
+    CHECK(AWAIT(accessor.findKey(resourceId)) == key);
+
+    CHECK(accessor.keyCacheStats().misses == 1);
+    CHECK(accessor.keyCacheStats().hits == 1);
+  }
+
+  SECTION("it reads keys back from the store once the cache is cleared")
+  {
+    AWAIT(accessor.findKey(resourceId));
+    accessor.clearKeyCache();
+
+    CHECK(AWAIT(accessor.findKey(resourceId)) == key);
+    CHECK(accessor.keyCacheStats().misses == 2);
+  }
+
+  SECTION("it returns cached and stored keys together")
+  {
+    auto const resourceId2 = make<Crypto::SimpleResourceId>("mymac2");
+    auto const key2 = make<Crypto::SymmetricKey>("mykey2");
+    AWAIT_VOID(store.putKey(resourceId2, key2));
+
+    AWAIT(accessor.findKey(resourceId));
+    auto const keys = AWAIT(accessor.tryFindKeys({resourceId, resourceId2}));
+
+    CHECK(keys.size() == 2);
+    CHECK(keys.at(resourceId) == key);
+    CHECK(keys.at(resourceId2) == key2);
+  }
+}
@@ -2,6 +2,7 @@
 
 #include <Tanker/Crypto/Crypto.hpp>
 #include <Tanker/DataStore/Connection.hpp>
+#include <Tanker/DataStore/Memory/Backend.hpp>
 #include <Tanker/DataStore/Sqlite/Backend.hpp>
 #include <Tanker/DataStore/Utils.hpp>
 #include <Tanker/Errors/Errc.hpp>
@@ -12,6 +13,7 @@
 
 #include <catch2/catch_test_macros.hpp>
 #include <mgs/base64.hpp>
+#include <tconcurrent/async_wait.hpp>
 
 using namespace Tanker;
 
@@ -51,4 +53,91 @@ TEST_CASE("Resource Keys Store")
 
     CHECK(key == gotKey);
   }
+
+  SECTION("it should find several keys at once and skip the missing ones")
+  {
+    auto const resourceId = make<Crypto::SimpleResourceId>("mymac");
+    auto const resourceId2 = make<Crypto::SimpleResourceId>("mymac2");
+    auto const unexistentMac = make<Crypto::SimpleResourceId>("unexistent");
+    auto const key = make<Crypto::SymmetricKey>("mykey");
+    auto const key2 = make<Crypto::SymmetricKey>("mykey2");
+
+    AWAIT_VOID(keys.putKey(resourceId, key));
+    AWAIT_VOID(keys.putKey(resourceId2, key2));
+    std::vector<Crypto::SimpleResourceId> const resourceIds{resourceId2, unexistentMac, resourceId};
+    auto const gotKeys = AWAIT(keys.findKeys(resourceIds));
+
+    CHECK(gotKeys == ResourceKeys::KeysResult{{key2, resourceId2}, {key, resourceId}});
+  }
+}
+
+TEST_CASE("Resource Keys Store batched writes")
+{
+  auto db = DataStore::SqliteBackend().open(DataStore::MemoryPath, DataStore::MemoryPath);
+
+  ResourceKeys::Store keys({}, db.get());
+
+  ResourceKeys::KeysResult const keyResults{
+      {make<Crypto::SymmetricKey>("mykey"), make<Crypto::SimpleResourceId>("mymac")},
+      {make<Crypto::SymmetricKey>("mykey2"), make<Crypto::SimpleResourceId>("mymac2")},
+  };
+  std::vector<Crypto::SimpleResourceId> const resourceIds{keyResults[0].id, keyResults[1].id};
+
+  SECTION("it should find keys put together")
+  {
+    AWAIT_VOID(keys.putKeys(keyResults));
+
+    CHECK(AWAIT(keys.findKeys(resourceIds)) == keyResults);
+  }
+
+  SECTION("it should find pending keys before they are written")
+  {
+    keys.setWriteBehind(ResourceKeys::WriteBehindOptions{10, std::chrono::hours(1)});
+    AWAIT_VOID(keys.putKeys(keyResults));
+
+    ResourceKeys::Store otherKeys({}, db.get());
+    CHECK(AWAIT(otherKeys.findKeys(resourceIds)).empty());
+    CHECK(AWAIT(keys.findKeys(resourceIds)) == keyResults);
+
+    AWAIT_VOID(keys.flush());
+    CHECK(AWAIT(otherKeys.findKeys(resourceIds)) == keyResults);
+  }
+
+  SECTION("it should write the pending keys once there are enough of them")
+  {
+    keys.setWriteBehind(ResourceKeys::WriteBehindOptions{2, std::chrono::hours(1)});
+    AWAIT_VOID(keys.putKey(keyResults[0].id, keyResults[0].key));
+
+    ResourceKeys::Store otherKeys({}, db.get());
+    CHECK(AWAIT(otherKeys.findKeys(resourceIds)).empty());
+
+    AWAIT_VOID(keys.putKey(keyResults[1].id, keyResults[1].key));
+    CHECK(AWAIT(otherKeys.findKeys(resourceIds)) == keyResults);
+  }
+
+  SECTION("it should write the pending keys after a delay")
+  {
+    keys.setWriteBehind(ResourceKeys::WriteBehindOptions{10, std::chrono::milliseconds(1)});
+    AWAIT_VOID(keys.putKeys(keyResults));
+
+    ResourceKeys::Store otherKeys({}, db.get());
+    AWAIT_VOID(tc::async_wait(std::chrono::milliseconds(50)));
+    CHECK(AWAIT(otherKeys.findKeys(resourceIds)) == keyResults);
+  }
+}
+
+TEST_CASE("Resource Keys Store with unencrypted values")
+{
+  auto db = DataStore::MemoryBackend().open(DataStore::MemoryPath, DataStore::MemoryPath);
+  REQUIRE(!db->needsValueEncryption());
+
+  ResourceKeys::Store keys({}, db.get());
+
+  auto const resourceId = make<Crypto::SimpleResourceId>("mymac");
+  auto const key = make<Crypto::SymmetricKey>("mykey");
+
+  AWAIT_VOID(keys.putKey(resourceId, key));
+  auto const gotKeys = AWAIT(keys.findKeys(gsl::make_span(&resourceId, 1)));
+
+  CHECK(gotKeys == ResourceKeys::KeysResult{{key, resourceId}});
 }
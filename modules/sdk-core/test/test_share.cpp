@@ -11,6 +11,7 @@
 #include <Tanker/Trustchain/UserId.hpp>
 #include <Tanker/Users/Device.hpp>
 #include <Tanker/Users/UserAccessor.hpp>
+#include <Tanker/WorkerPool.hpp>
 
 #include <Helpers/Await.hpp>
 #include <Helpers/Errors.hpp>
@@ -19,6 +20,7 @@
 #include "GroupAccessorMock.hpp"
 #include "TrustchainGenerator.hpp"
 #include "UserAccessorMock.hpp"
+#include "UserRequesterStub.hpp"
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -26,6 +28,10 @@
 
 #include <Helpers/Buffers.hpp>
 
+#include <fmt/format.h>
+
+#include <set>
+
 using namespace Tanker;
 using namespace Tanker::Errors;
 using namespace Tanker::Trustchain;
@@ -241,11 +247,11 @@ TEST_CASE("generateShareBlocks")
     auto const newUserKeyPair = newUser.userKeys().back();
 
     Share::KeyRecipients keyRecipients{{newUserKeyPair.publicKey}, {}, {}};
-    auto const blocks = Share::generateShareBlocks(generator.context().id(),
-                                                   keySenderDevice.id(),
-                                                   keySenderDevice.keys().signatureKeyPair.privateKey,
-                                                   resourceKeys,
-                                                   keyRecipients);
+    auto const blocks = AWAIT(Share::generateShareBlocks(generator.context().id(),
+                                                         keySenderDevice.id(),
+                                                         keySenderDevice.keys().signatureKeyPair.privateKey,
+                                                         resourceKeys,
+                                                         keyRecipients));
 
     assertKeyPublishToUsersTargetedAt(resourceKeys[0], blocks.keyPublishesToUsers, {newUserKeyPair});
   }
@@ -258,11 +264,11 @@ TEST_CASE("generateShareBlocks")
         {make<Crypto::SymmetricKey>("symmkey"), make<Crypto::SimpleResourceId>("resource mac")}};
 
     Share::KeyRecipients keyRecipients{{}, {provisionalUser}, {}};
-    auto const blocks = Share::generateShareBlocks(generator.context().id(),
-                                                   keySenderDevice.id(),
-                                                   keySenderDevice.keys().signatureKeyPair.privateKey,
-                                                   resourceKeys,
-                                                   keyRecipients);
+    auto const blocks = AWAIT(Share::generateShareBlocks(generator.context().id(),
+                                                         keySenderDevice.id(),
+                                                         keySenderDevice.keys().signatureKeyPair.privateKey,
+                                                         resourceKeys,
+                                                         keyRecipients));
 
     assertKeyPublishToUsersTargetedAt(resourceKeys[0], blocks.keyPublishesToProvisionalUsers, {provisionalUser});
   }
@@ -275,12 +281,152 @@ TEST_CASE("generateShareBlocks")
         {make<Crypto::SymmetricKey>("symmkey"), make<Crypto::SimpleResourceId>("resource resourceId")}};
 
     Share::KeyRecipients keyRecipients{{}, {}, {newGroup.currentEncKp().publicKey}};
-    auto const blocks = Share::generateShareBlocks(generator.context().id(),
-                                                   keySenderDevice.id(),
-                                                   keySenderDevice.keys().signatureKeyPair.privateKey,
-                                                   resourceKeys,
-                                                   keyRecipients);
+    auto const blocks = AWAIT(Share::generateShareBlocks(generator.context().id(),
+                                                         keySenderDevice.id(),
+                                                         keySenderDevice.keys().signatureKeyPair.privateKey,
+                                                         resourceKeys,
+                                                         keyRecipients));
 
     assertKeyPublishToGroupTargetedAt(resourceKeys[0], blocks.keyPublishesToUserGroups, {newGroup.currentEncKp()});
   }
+
+  SECTION("on a worker pool should generate the blocks in resource order, then recipient order")
+  {
+    WorkerPool workerPool(4);
+    ResourceKeys::KeysResult resourceKeys;
+    for (auto i = 0; i < 5; ++i)
+      resourceKeys.push_back({Crypto::makeSymmetricKey(), Crypto::getRandom<Crypto::SimpleResourceId>()});
+    std::vector<Crypto::EncryptionKeyPair> userKeyPairs;
+    for (auto i = 0; i < 7; ++i)
+      userKeyPairs.push_back(Crypto::makeEncryptionKeyPair());
+
+    Share::KeyRecipients keyRecipients;
+    for (auto const& keyPair : userKeyPairs)
+      keyRecipients.recipientUserKeys.push_back(keyPair.publicKey);
+    auto const blocks = AWAIT(Share::generateShareBlocks(generator.context().id(),
+                                                         keySenderDevice.id(),
+                                                         keySenderDevice.keys().signatureKeyPair.privateKey,
+                                                         resourceKeys,
+                                                         keyRecipients,
+                                                         &workerPool));
+
+    REQUIRE(blocks.keyPublishesToUsers.size() == resourceKeys.size() * userKeyPairs.size());
+    for (auto i = 0u; i < resourceKeys.size(); ++i)
+    {
+      std::vector<Trustchain::Actions::KeyPublishToUser> const resourceBlocks(
+          blocks.keyPublishesToUsers.begin() + i * userKeyPairs.size(),
+          blocks.keyPublishesToUsers.begin() + (i + 1) * userKeyPairs.size());
+      assertKeyPublishToUsersTargetedAt(resourceKeys[i], resourceBlocks, userKeyPairs);
+    }
+  }
+}
+
+TEST_CASE("shareInBatches")
+{
+  Test::Generator generator;
+  auto const newUser = generator.makeUser("newUser");
+  auto const keySender = generator.makeUser("keySender");
+  auto const& keySenderDevice = keySender.devices().front();
+
+  UserAccessorMock userAccessor;
+  GroupAccessorMock groupAccessor;
+  UserRequesterStub requester;
+
+  ResourceKeys::KeysResult resourceKeys;
+  for (auto i = 0; i < 250; ++i)
+    resourceKeys.push_back({Crypto::makeSymmetricKey(), Crypto::getRandom<Crypto::SimpleResourceId>()});
+
+  // Recipients are resolved once for all the batches
+  REQUIRE_CALL(userAccessor, pull(std::vector{newUser.id()})).LR_RETURN(makeCoTask(UserPullResult{{newUser}, {}}));
+  REQUIRE_CALL(userAccessor, pullProvisional(trompeloeil::_))
+      .LR_RETURN(makeCoTask(std::vector<ProvisionalUsers::PublicUser>{}));
+  REQUIRE_CALL(groupAccessor, getPublicEncryptionKeys(std::vector<GroupId>{}))
+      .LR_RETURN(makeCoTask(Groups::Accessor::PublicEncryptionKeyPullResult{{}, {}}));
+
+  std::vector<Crypto::SimpleResourceId> sharedIds;
+  REQUIRE_CALL(requester, postResourceKeys(trompeloeil::_))
+      .TIMES(3)
+      .LR_SIDE_EFFECT(for (auto const& block : _1.keyPublishesToUsers) sharedIds.push_back(block.resourceId()))
+      .LR_SIDE_EFFECT(CHECK(_1.keyPublishesToUsers.size() <= 100))
+      .RETURN(makeCoTask());
+
+  std::vector<std::size_t> progress;
+  AWAIT_VOID(Share::shareInBatches(
+      userAccessor,
+      groupAccessor,
+      generator.context().id(),
+      keySenderDevice.id(),
+      keySenderDevice.keys().signatureKeyPair.privateKey,
+      requester,
+      resourceKeys,
+      {SPublicIdentity{to_string(Identity::PublicPermanentIdentity{generator.context().id(), newUser.id()})}},
+      {},
+      [&](std::size_t sharedKeys, std::size_t totalKeys) {
+        CHECK(totalKeys == resourceKeys.size());
+        progress.push_back(sharedKeys);
+      }));
+
+  CHECK(progress == std::vector<std::size_t>{100, 200, 250});
+  REQUIRE(sharedIds.size() == resourceKeys.size());
+  for (auto i = 0u; i < resourceKeys.size(); ++i)
+    CHECK(sharedIds[i] == resourceKeys[i].id);
+}
+
+TEST_CASE("shareInBatches splits the resource x recipient pairs")
+{
+  Test::Generator generator;
+  auto const keySender = generator.makeUser("keySender");
+  auto const& keySenderDevice = keySender.devices().front();
+
+  UserAccessorMock userAccessor;
+  GroupAccessorMock groupAccessor;
+  UserRequesterStub requester;
+
+  // More recipients than the server accepts in a single share
+  std::vector<Users::User> users;
+  std::vector<SPublicIdentity> publicIdentities;
+  for (auto i = 0; i < 150; ++i)
+  {
+    auto const user = generator.makeUser(fmt::format("user{}", i));
+    users.push_back(user);
+    publicIdentities.push_back(
+        SPublicIdentity{to_string(Identity::PublicPermanentIdentity{generator.context().id(), user.id()})});
+  }
+
+  ResourceKeys::KeysResult resourceKeys;
+  for (auto i = 0; i < 3; ++i)
+    resourceKeys.push_back({Crypto::makeSymmetricKey(), Crypto::getRandom<Crypto::SimpleResourceId>()});
+
+  REQUIRE_CALL(userAccessor, pull(trompeloeil::_)).LR_RETURN(makeCoTask(UserPullResult{users, {}}));
+  REQUIRE_CALL(userAccessor, pullProvisional(trompeloeil::_))
+      .LR_RETURN(makeCoTask(std::vector<ProvisionalUsers::PublicUser>{}));
+  REQUIRE_CALL(groupAccessor, getPublicEncryptionKeys(std::vector<GroupId>{}))
+      .LR_RETURN(makeCoTask(Groups::Accessor::PublicEncryptionKeyPullResult{{}, {}}));
+
+  std::set<std::pair<Crypto::SimpleResourceId, Crypto::PublicEncryptionKey>> sharedPairs;
+  REQUIRE_CALL(requester, postResourceKeys(trompeloeil::_))
+      .TIMES(5)
+      .LR_SIDE_EFFECT(CHECK(_1.keyPublishesToUsers.size() <= 100))
+      .LR_SIDE_EFFECT(for (auto const& b : _1.keyPublishesToUsers)
+                          sharedPairs.emplace(b.resourceId(), b.recipientPublicEncryptionKey()))
+      .RETURN(makeCoTask());
+
+  std::vector<std::size_t> progress;
+  AWAIT_VOID(Share::shareInBatches(userAccessor,
+                                   groupAccessor,
+                                   generator.context().id(),
+                                   keySenderDevice.id(),
+                                   keySenderDevice.keys().signatureKeyPair.privateKey,
+                                   requester,
+                                   resourceKeys,
+                                   publicIdentities,
+                                   {},
+                                   [&](std::size_t sharedKeys, std::size_t) { progress.push_back(sharedKeys); }));
+
+  // 450 pairs: 100, 200, 300, 400 and 450 pairs uploaded
+  CHECK(progress == std::vector<std::size_t>{0, 1, 2, 2, 3});
+  REQUIRE(sharedPairs.size() == resourceKeys.size() * users.size());
+  for (auto const& resourceKey : resourceKeys)
+    for (auto const& user : users)
+      CHECK(sharedPairs.count({resourceKey.id, *user.userKey()}) == 1);
 }
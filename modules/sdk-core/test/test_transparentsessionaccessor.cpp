@@ -1,15 +1,31 @@
 #include <Tanker/TransparentSession/Accessor.hpp>
 #include <Tanker/TransparentSession/Store.hpp>
 
+#include <Tanker/Crypto/Crypto.hpp>
 #include <Tanker/DataStore/Sqlite/Backend.hpp>
+#include <Tanker/Utils.hpp>
 
 #include <Helpers/Await.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <chrono>
+#include <thread>
+
 using namespace Tanker;
 using namespace Tanker::Crypto;
 using namespace Tanker::TransparentSession;
+using namespace std::chrono_literals;
+
+namespace
+{
+void waitForNextSecond()
+{
+  auto const now = secondsSinceEpoch();
+  while (secondsSinceEpoch() == now)
+    std::this_thread::sleep_for(10ms);
+}
+}
 
 TEST_CASE("TransparentSessionAccessor")
 {
@@ -44,7 +60,53 @@ TEST_CASE("TransparentSessionAccessor")
     auto sess1 = AWAIT(accessor.getOrCreateTransparentSession({}, {{"X"}}));
     AWAIT_VOID(store.put(sess1.recipientsHash, sess1.id, sess1.key, 0));
 
-    auto sess2 = AWAIT(accessor.getOrCreateTransparentSession({}, {{"X"}}));
+    // A new accessor does not have the session in memory
+    Accessor accessor2(&store, shareMock);
+    auto sess2 = AWAIT(accessor2.getOrCreateTransparentSession({}, {{"X"}}));
     CHECK(sess1.id != sess2.id);
   }
+
+  SECTION("it creates a new session if the one in memory has expired")
+  {
+    auto const hash = Store::hashRecipients({}, {{"X"}});
+    auto const id = Crypto::getRandom<Crypto::SimpleResourceId>();
+    auto const key = Crypto::makeSymmetricKey();
+    // Leave almost a second before the stored session expires
+    waitForNextSecond();
+    AWAIT_VOID(store.put(hash, id, key, secondsSinceEpoch() - Accessor::SessionExpirationSeconds + 1));
+
+    auto const sess1 = AWAIT(accessor.getOrCreateTransparentSession({}, {{"X"}}));
+    CHECK(sess1.id == id);
+    CHECK(accessor.cacheStats().misses == 1);
+
+    waitForNextSecond();
+    auto const sess2 = AWAIT(accessor.getOrCreateTransparentSession({}, {{"X"}}));
+    CHECK(sess2.id != id);
+    CHECK(accessor.cacheStats().hits == 0);
+    CHECK(accessor.cacheStats().misses == 2);
+  }
+
+  SECTION("it keeps reused sessions in memory")
+  {
+    auto sess1 = AWAIT(accessor.getOrCreateTransparentSession({}, {{"X"}}));
+    CHECK(accessor.cacheStats().hits == 0);
+    CHECK(accessor.cacheStats().misses == 1);
+
+    auto sess2 = AWAIT(accessor.getOrCreateTransparentSession({}, {{"X"}}));
+    CHECK(sess1 == sess2);
+    CHECK(accessor.cacheStats().hits == 1);
+    CHECK(accessor.cacheStats().misses == 1);
+  }
+
+  SECTION("it reads evicted sessions back from the store")
+  {
+    Accessor smallAccessor(&store, shareMock, 1);
+    auto sess1 = AWAIT(smallAccessor.getOrCreateTransparentSession({}, {{"1"}}));
+    AWAIT(smallAccessor.getOrCreateTransparentSession({}, {{"2"}}));
+
+    auto sess2 = AWAIT(smallAccessor.getOrCreateTransparentSession({}, {{"1"}}));
+    CHECK(sess1 == sess2);
+    CHECK(smallAccessor.cacheStats().hits == 0);
+    CHECK(smallAccessor.cacheStats().misses == 3);
+  }
 }
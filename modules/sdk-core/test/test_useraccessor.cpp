@@ -2,6 +2,9 @@
 #include <Tanker/Trustchain/UserId.hpp>
 #include <Tanker/Users/User.hpp>
 #include <Tanker/Users/UserAccessor.hpp>
+#include <Tanker/Users/UserStore.hpp>
+
+#include <Tanker/DataStore/Sqlite/Backend.hpp>
 
 #include <Helpers/Await.hpp>
 #include <Helpers/MakeCoTask.hpp>
@@ -66,3 +69,60 @@ TEST_CASE("UserAccessor")
     CHECK(result.found == std::vector<Users::User>{alice});
   }
 }
+
+TEST_CASE("UserAccessor with a user cache")
+{
+  Test::Generator generator;
+  auto alice = generator.makeUser("alice");
+
+  auto db = DataStore::SqliteBackend().open(DataStore::MemoryPath, DataStore::MemoryPath);
+  Users::UserStore userStore({}, db.get());
+  UserRequesterStub requester;
+
+  std::vector const ids{alice.id()};
+
+  SECTION("it should fetch cached users again when there is no max age")
+  {
+    Users::UserAccessor userAccessor(generator.context(), &requester, &userStore);
+    {
+      REQUIRE_CALL(requester, getUsers(ids))
+          .RETURN(makeCoTask(Users::IRequester::GetResult{generator.rootBlock(), generator.makeEntryList({alice})}));
+      AWAIT(userAccessor.pull(ids));
+    }
+
+    alice.addDevice();
+    REQUIRE_CALL(requester, getUsers(ids))
+        .RETURN(makeCoTask(Users::IRequester::GetResult{generator.rootBlock(), generator.makeEntryList({alice})}));
+    auto const result = AWAIT(userAccessor.pull(ids));
+    CHECK(result.found == std::vector<Users::User>{alice});
+  }
+
+  SECTION("it should not fetch users that were fetched recently")
+  {
+    Users::UserAccessor userAccessor(generator.context(), &requester, &userStore, std::chrono::hours(1));
+    {
+      REQUIRE_CALL(requester, getUsers(ids))
+          .RETURN(makeCoTask(Users::IRequester::GetResult{generator.rootBlock(), generator.makeEntryList({alice})}));
+      AWAIT(userAccessor.pull(ids));
+    }
+
+    FORBID_CALL(requester, getUsers(ANY(gsl::span<Trustchain::UserId const>)));
+    auto const result = AWAIT(userAccessor.pull(ids));
+    CHECK(result.found == std::vector<Users::User>{alice});
+  }
+
+  SECTION("it should find cached users by device id")
+  {
+    Users::UserAccessor userAccessor(generator.context(), &requester, &userStore, std::chrono::hours(1));
+    {
+      REQUIRE_CALL(requester, getUsers(ids))
+          .RETURN(makeCoTask(Users::IRequester::GetResult{generator.rootBlock(), generator.makeEntryList({alice})}));
+      AWAIT(userAccessor.pull(ids));
+    }
+
+    FORBID_CALL(requester, getUsers(ANY(gsl::span<Trustchain::DeviceId const>)));
+    std::vector const deviceIds{alice.devices()[0].id()};
+    auto const result = AWAIT(userAccessor.pull(deviceIds));
+    CHECK(result.found == std::vector<Users::Device>{alice.devices()[0]});
+  }
+}
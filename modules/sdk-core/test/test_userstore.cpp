@@ -0,0 +1,65 @@
+#include <Tanker/Users/UserStore.hpp>
+
+#include <Tanker/DataStore/Sqlite/Backend.hpp>
+
+#include <Helpers/Await.hpp>
+#include <Helpers/Buffers.hpp>
+
+#include "TrustchainGenerator.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace Tanker;
+
+TEST_CASE("UserStore")
+{
+  auto db = DataStore::SqliteBackend().open(DataStore::MemoryPath, DataStore::MemoryPath);
+  Users::UserStore userStore({}, db.get());
+
+  Test::Generator generator;
+  auto alice = generator.makeUser("alice");
+  alice.addDevice();
+  auto const bob = generator.makeUser("bob");
+
+  auto const cachedAlice = Users::CachedUser{alice, make<Crypto::Hash>("alice last block"), 42};
+  auto const cachedBob = Users::CachedUser{bob, make<Crypto::Hash>("bob last block"), 43};
+  std::vector const bothUsers{cachedAlice, cachedBob};
+
+  SECTION("it should not find a user that was not put")
+  {
+    std::vector const ids{alice.id()};
+    CHECK(AWAIT(userStore.findByUserIds(ids)).empty());
+  }
+
+  SECTION("it should find users that were put")
+  {
+    AWAIT_VOID(userStore.put(bothUsers));
+
+    std::vector const ids{alice.id(), bob.id()};
+    auto const found = AWAIT(userStore.findByUserIds(ids));
+    CHECK(found.size() == 2);
+    CHECK(found.at(alice.id()) == cachedAlice);
+    CHECK(found.at(bob.id()) == cachedBob);
+  }
+
+  SECTION("it should find users by device id")
+  {
+    AWAIT_VOID(userStore.put(bothUsers));
+
+    std::vector const ids{alice.devices()[0].id(), alice.devices()[1].id()};
+    auto const found = AWAIT(userStore.findByDeviceIds(ids));
+    CHECK(found.size() == 1);
+    CHECK(found.at(alice.id()) == cachedAlice);
+  }
+
+  SECTION("it should replace a user that was put again")
+  {
+    AWAIT_VOID(userStore.put(bothUsers));
+    auto updatedAlice = cachedAlice;
+    updatedAlice.fetchTimestamp = 1000;
+    AWAIT_VOID(userStore.put(gsl::make_span(&updatedAlice, 1)));
+
+    std::vector const ids{alice.id()};
+    CHECK(AWAIT(userStore.findByUserIds(ids)).at(alice.id()) == updatedAlice);
+  }
+}
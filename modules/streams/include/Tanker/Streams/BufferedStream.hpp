@@ -26,6 +26,9 @@ protected:
   tc::cotask<gsl::span<std::uint8_t const>> readInputSource(std::int64_t n);
   // sets the state to BufferedOutput
   gsl::span<std::uint8_t> prepareWrite(std::int64_t toWrite);
+  // returns a buffer of the given size for the derived stream's own use, its
+  // content is not kept between calls
+  gsl::span<std::uint8_t> scratchBuffer(std::int64_t size);
 
   bool isInputEndOfStream();
   void endOutputStream();
@@ -42,9 +45,15 @@ private:
 
   tc::cotask<std::int64_t> copyBufferedOutput(gsl::span<std::uint8_t> out);
 
+  // The buffers only grow, so that once they fit a chunk, processing the next
+  // ones does not allocate
+  static gsl::span<std::uint8_t> reuseBuffer(std::vector<std::uint8_t>& buffer, std::int64_t size);
+
   InputSource _cb;
   std::vector<std::uint8_t> _input;
   std::vector<std::uint8_t> _output;
+  std::vector<std::uint8_t> _scratch;
+  std::int64_t _outputSize{};
   State _state{State::NoOutput};
   bool _processingComplete = false;
   std::int64_t _currentPosition{};
@@ -34,6 +34,7 @@ public:
 
   Crypto::SymmetricKey const& symmetricKey() const;
   decltype(std::declval<HeaderType>().resourceId()) resourceId() const;
+  std::uint32_t encryptedChunkSize() const;
 
 protected:
   Crypto::SymmetricKey _key;
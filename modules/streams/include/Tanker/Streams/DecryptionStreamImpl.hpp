@@ -66,6 +66,12 @@ decltype(std::declval<HeaderType>().resourceId()) DecryptionStream<Derived, Head
   return _header.resourceId();
 }
 
+template <typename Derived, typename HeaderType>
+std::uint32_t DecryptionStream<Derived, HeaderType>::encryptedChunkSize() const
+{
+  return _header.encryptedChunkSize();
+}
+
 template <typename Derived, typename HeaderType>
 Crypto::SymmetricKey const& DecryptionStream<Derived, HeaderType>::symmetricKey() const
 {
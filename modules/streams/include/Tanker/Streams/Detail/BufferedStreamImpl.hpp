@@ -20,10 +20,10 @@ BufferedStream<Derived>::BufferedStream(InputSource cb) : _cb(std::move(cb))
 template <typename Derived>
 tc::cotask<std::int64_t> BufferedStream<Derived>::copyBufferedOutput(gsl::span<std::uint8_t> out)
 {
-  auto const toRead = std::min<std::int64_t>(out.size(), _output.size() - _currentPosition);
+  auto const toRead = std::min<std::int64_t>(out.size(), _outputSize - _currentPosition);
   std::copy_n(_output.begin() + _currentPosition, toRead, out.data());
   _currentPosition += toRead;
-  if (_currentPosition == static_cast<std::int64_t>(_output.size()))
+  if (_currentPosition == _outputSize)
   {
     if (!_processingComplete)
       _state = State::NoOutput;
@@ -33,26 +33,39 @@ tc::cotask<std::int64_t> BufferedStream<Derived>::copyBufferedOutput(gsl::span<s
   TC_RETURN(toRead);
 }
 
+template <typename Derived>
+gsl::span<std::uint8_t> BufferedStream<Derived>::reuseBuffer(std::vector<std::uint8_t>& buffer, std::int64_t size)
+{
+  if (static_cast<std::int64_t>(buffer.size()) < size)
+    buffer.resize(size);
+  return gsl::make_span(buffer).subspan(0, size);
+}
+
 template <typename Derived>
 tc::cotask<gsl::span<std::uint8_t const>> BufferedStream<Derived>::readInputSource(std::int64_t n)
 {
   if (!_cb)
     TC_RETURN(gsl::span<std::uint8_t const>());
 
-  _input.resize(n);
-  auto const totalRead = TC_AWAIT(readStream(_input, _cb));
+  auto const input = reuseBuffer(_input, n);
+  auto const totalRead = TC_AWAIT(readStream(input, _cb));
   if (totalRead < n)
     _cb = nullptr;
-  _input.resize(totalRead);
-  TC_RETURN(gsl::make_span(_input).template as_span<std::uint8_t const>());
+  TC_RETURN(input.subspan(0, totalRead).template as_span<std::uint8_t const>());
 }
 
 template <typename Derived>
 gsl::span<std::uint8_t> BufferedStream<Derived>::prepareWrite(std::int64_t toWrite)
 {
-  _output.resize(toWrite);
+  _outputSize = toWrite;
   _state = State::BufferedOutput;
-  return gsl::make_span(_output);
+  return reuseBuffer(_output, toWrite);
+}
+
+template <typename Derived>
+gsl::span<std::uint8_t> BufferedStream<Derived>::scratchBuffer(std::int64_t size)
+{
+  return reuseBuffer(_scratch, size);
 }
 
 template <typename Derived>
@@ -69,10 +82,10 @@ tc::cotask<std::int64_t> BufferedStream<Derived>::operator()(gsl::span<std::uint
     case State::Error:
       throw Exception(make_error_code(Errc::IOError), "buffered stream is in an error state");
     case State::NoOutput:
-      _output.clear();
-      while (_output.empty() && !_processingComplete)
+      _outputSize = 0;
+      while (_outputSize == 0 && !_processingComplete)
         TC_AWAIT(static_cast<Derived&>(*this).processInput());
-      if (_output.empty())
+      if (_outputSize == 0)
       {
         _state = State::EndOfStream;
         TC_RETURN(0);
@@ -109,10 +122,10 @@ void BufferedStream<Derived>::endOutputStream()
 template <typename Derived>
 void BufferedStream<Derived>::shrinkOutput(std::uint64_t n)
 {
-  if (n > _output.size())
+  if (n > static_cast<std::uint64_t>(_outputSize))
     throw Errors::AssertionError("attempting to enlarge buffer with shrinkOutput()");
 
-  _output.resize(n);
+  _outputSize = n;
 }
 }
 }
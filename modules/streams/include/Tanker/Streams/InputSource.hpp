@@ -17,5 +17,10 @@ namespace Streams
 //
 // Throws if an error occurred.
 using InputSource = std::function<tc::cotask<std::int64_t>(gsl::span<std::uint8_t> out)>;
+
+// Same as InputSource, but reads starting at offset, for random access to the
+// encrypted data. It can return fewer bytes than asked even before the end.
+using PositionalInputSource =
+    std::function<tc::cotask<std::int64_t>(std::uint64_t offset, gsl::span<std::uint8_t> out)>;
 }
 }
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Tanker/Crypto/AeadIv.hpp>
+#include <Tanker/Crypto/ResourceId.hpp>
+#include <Tanker/Crypto/SimpleResourceId.hpp>
+#include <Tanker/Crypto/SymmetricKey.hpp>
+#include <Tanker/Encryptor/v11.hpp>
+#include <Tanker/Streams/InputSource.hpp>
+
+#include <gsl/gsl-lite.hpp>
+#include <tconcurrent/coroutine.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+namespace Tanker
+{
+namespace Streams
+{
+/**
+ * Decrypts any range of a V4, V8 or V11 stream, by reading and decrypting only
+ * the chunks that hold it.
+ *
+ * Each chunk is authenticated, and its position is bound to its IV, but a
+ * range says nothing about the rest of the data: a truncated stream is not
+ * detected unless the truncation is inside the range.
+ */
+class RangeDecryptor
+{
+public:
+  using ResourceKeyFinder =
+      std::function<tc::cotask<std::optional<Crypto::SymmetricKey>>(Crypto::SimpleResourceId const&)>;
+
+  RangeDecryptor() = default;
+
+  // Reads the header to find the format and the key
+  static tc::cotask<RangeDecryptor> create(PositionalInputSource source, ResourceKeyFinder const& finder);
+
+  Crypto::ResourceId const& resourceId() const;
+  Crypto::SymmetricKey const& symmetricKey() const;
+
+  // Decrypts the clear data starting at offset into out. Returns the number of
+  // bytes written, which is less than out.size() only at the end of the data.
+  // Throws InvalidArgument when offset is past the end of the data, or when the
+  // range overflows.
+  tc::cotask<std::int64_t> decryptRange(std::uint64_t offset, gsl::span<std::uint8_t> out);
+
+private:
+  PositionalInputSource _source;
+  std::uint32_t _version{};
+  std::uint32_t _encryptedChunkSize{};
+  std::uint32_t _clearChunkSize{};
+  // Where the first chunk starts, V11 has a single header before the chunks
+  std::uint64_t _chunksOffset{};
+  Crypto::ResourceId _resourceId;
+  Crypto::SymmetricKey _key;
+  // Only used by V11, the other formats have them in each chunk header
+  Crypto::AeadIv _seedIv{};
+  std::array<std::uint8_t, EncryptorV11::macDataSize> _associatedData{};
+
+  gsl::span<std::uint8_t const> decryptChunk(std::uint64_t index,
+                                             gsl::span<std::uint8_t const> encryptedChunk,
+                                             gsl::span<std::uint8_t> clearBuffer) const;
+  gsl::span<std::uint8_t const> decryptChunkV4V8(std::uint64_t index,
+                                                 gsl::span<std::uint8_t const> encryptedChunk,
+                                                 gsl::span<std::uint8_t> clearBuffer) const;
+  gsl::span<std::uint8_t const> decryptChunkV11(std::uint64_t index,
+                                                gsl::span<std::uint8_t const> encryptedChunk,
+                                                gsl::span<std::uint8_t> clearBuffer) const;
+};
+}
+}
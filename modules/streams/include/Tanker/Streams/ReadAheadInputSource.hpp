@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Tanker/Streams/InputSource.hpp>
+
+#include <gsl/gsl-lite.hpp>
+#include <tconcurrent/coroutine.hpp>
+
+#include <cstdint>
+#include <memory>
+
+namespace Tanker
+{
+namespace Streams
+{
+struct ReadAheadOptions
+{
+  // Number of chunks read in advance, 0 disables the read-ahead
+  std::uint32_t depth = 0;
+  // Also encrypt or decrypt the chunks in advance, not only read their input
+  bool processing = false;
+};
+
+/**
+ * Reads the underlying source chunkSize bytes at a time, up to depth chunks
+ * ahead of the consumer. The next reads are in flight while the current chunk
+ * is consumed, which helps when the source waits on the network or on a
+ * callback.
+ *
+ * The reads are started on the tconcurrent executor, the source is still
+ * called one read at a time and in order. Once the last copy of a
+ * ReadAheadInputSource is destroyed, the source is not called again, but a call
+ * already in progress is not interrupted. When the source itself reads through
+ * another stage, e.g. a decryptor over an application callback, that stage can
+ * still be called until its in-progress call returns: callbacks that must not
+ * be called after a close have to check for it themselves.
+ */
+class ReadAheadInputSource
+{
+public:
+  ReadAheadInputSource(InputSource source, std::int64_t chunkSize, std::uint32_t depth);
+
+  tc::cotask<std::int64_t> operator()(gsl::span<std::uint8_t> out);
+
+private:
+  struct State;
+
+  std::shared_ptr<State> _state;
+};
+
+// Returns source itself when depth is 0
+InputSource readAhead(InputSource source, std::int64_t chunkSize, std::uint32_t depth);
+}
+}
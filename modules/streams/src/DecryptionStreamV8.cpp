@@ -3,6 +3,8 @@
 #include <Tanker/Crypto/Padding.hpp>
 #include <Tanker/Errors/Exception.hpp>
 
+#include <array>
+
 namespace Tanker::Streams
 {
 DecryptionStreamV8::DecryptionStreamV8(InputSource cb, Header header, Crypto::SymmetricKey key)
@@ -26,7 +28,7 @@ tc::cotask<void> DecryptionStreamV8::decryptChunk()
   ++_chunkIndex;
   auto output = prepareWrite(Crypto::decryptedSize(encryptedInput.size()));
 
-  std::vector<uint8_t> associatedData(Header::serializedSize);
+  std::array<uint8_t, Header::serializedSize> associatedData;
   to_serialized(associatedData.data(), _header);
 
   Crypto::decryptAead(_key, iv, output, encryptedInput, associatedData);
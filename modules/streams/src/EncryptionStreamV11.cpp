@@ -4,6 +4,8 @@
 #include <Tanker/Crypto/Padding.hpp>
 #include <Tanker/Serialization/Serialization.hpp>
 
+#include <algorithm>
+
 using namespace Tanker::Errors;
 using namespace Tanker::Crypto;
 
@@ -51,14 +53,15 @@ tc::cotask<void> EncryptionStreamV11::encryptChunk()
     return writeHeader();
 
   auto clearChunkSize = _encryptedChunkSize - overhead;
-  std::vector<uint8_t> paddedInputBuf;
+  gsl::span<uint8_t> paddedInputBuf;
   auto paddingSize = 0;
 
   if (_paddingLeftToAdd)
   {
     // This is a padding only block, write remaining padding bytes
     paddingSize = std::min<std::int64_t>(clearChunkSize, *_paddingLeftToAdd);
-    paddedInputBuf = std::vector<uint8_t>(EncryptorV11::paddingSizeSize + paddingSize, 0);
+    paddedInputBuf = scratchBuffer(EncryptorV11::paddingSizeSize + paddingSize);
+    std::fill(paddedInputBuf.begin(), paddedInputBuf.end(), 0);
     _paddingLeftToAdd = *_paddingLeftToAdd - paddingSize;
   }
   else
@@ -73,8 +76,10 @@ tc::cotask<void> EncryptionStreamV11::encryptChunk()
       _paddingLeftToAdd = *_paddingLeftToAdd - paddingSize;
     }
 
-    paddedInputBuf.resize(EncryptorV11::paddingSizeSize + paddingSize + clearData.size());
-    std::copy(clearData.begin(), clearData.end(), paddedInputBuf.begin() + EncryptorV11::paddingSizeSize + paddingSize);
+    paddedInputBuf = scratchBuffer(EncryptorV11::paddingSizeSize + paddingSize + clearData.size());
+    auto const padding = paddedInputBuf.subspan(EncryptorV11::paddingSizeSize, paddingSize);
+    std::fill(padding.begin(), padding.end(), 0);
+    std::copy(clearData.begin(), clearData.end(), padding.end());
   }
   Serialization::serialize<uint32_t>(paddedInputBuf.data(), paddingSize);
 
@@ -6,6 +6,8 @@
 
 #include <gsl/gsl-lite.hpp>
 
+#include <algorithm>
+
 using namespace Tanker::Errors;
 
 namespace Tanker::Streams
@@ -33,29 +35,32 @@ EncryptionStreamV8::EncryptionStreamV8(InputSource cb,
 tc::cotask<void> EncryptionStreamV8::encryptChunk()
 {
   auto currentClearChunkSize = _encryptedChunkSize - overhead;
-  std::vector<std::uint8_t> clearInput;
+  gsl::span<std::uint8_t const> clearData;
   if (!_paddingLeftToAdd)
   {
-    auto const span = TC_AWAIT(readInputSource(currentClearChunkSize));
-    clearInput = std::vector(span.begin(), span.end());
+    clearData = TC_AWAIT(readInputSource(currentClearChunkSize));
     // If we reached the end of input
-    if (clearInput.size() < currentClearChunkSize)
+    if (clearData.size() < currentClearChunkSize)
     {
-      auto const totalClearSize = _chunkIndex * currentClearChunkSize + clearInput.size();
+      auto const totalClearSize = _chunkIndex * currentClearChunkSize + clearData.size();
       _paddingLeftToAdd = Padding::paddedFromClearSize(totalClearSize, _paddingStep) - 1 - totalClearSize;
     }
   }
-  clearInput.push_back(0x80);
-  if (_paddingLeftToAdd && clearInput.size() - 1 < currentClearChunkSize)
+  std::int64_t paddingForCurrentChunk = 0;
+  if (_paddingLeftToAdd && clearData.size() < currentClearChunkSize)
   {
-    auto const paddingForCurrentChunk =
-        std::min<std::int64_t>(currentClearChunkSize - (clearInput.size() - 1), *_paddingLeftToAdd);
-    clearInput.resize(clearInput.size() + paddingForCurrentChunk, 0x00);
+    paddingForCurrentChunk = std::min<std::int64_t>(currentClearChunkSize - clearData.size(), *_paddingLeftToAdd);
     *_paddingLeftToAdd -= paddingForCurrentChunk;
-    if (*_paddingLeftToAdd == 0 && clearInput.size() - 1 < currentClearChunkSize)
+    if (*_paddingLeftToAdd == 0 && clearData.size() + paddingForCurrentChunk < currentClearChunkSize)
       endOutputStream();
   }
 
+  // The data, the 0x80 padding marker, and the padding zeroes
+  auto const clearInput = scratchBuffer(clearData.size() + 1 + paddingForCurrentChunk);
+  auto const marker = std::copy(clearData.begin(), clearData.end(), clearInput.begin());
+  *marker = 0x80;
+  std::fill(marker + 1, clearInput.end(), 0x00);
+
   auto output = prepareWrite(Header::serializedSize + Crypto::encryptedSize(clearInput.size()));
 
   Header const header(8u, _encryptedChunkSize, _resourceId, Crypto::getRandom<Crypto::AeadIv>());
@@ -0,0 +1,234 @@
+#include <Tanker/Streams/RangeDecryptor.hpp>
+
+#include <Tanker/Crypto/Crypto.hpp>
+#include <Tanker/Crypto/Format/Format.hpp>
+#include <Tanker/Crypto/Padding.hpp>
+#include <Tanker/Crypto/SubkeySeed.hpp>
+#include <Tanker/Errors/Errc.hpp>
+#include <Tanker/Errors/Exception.hpp>
+#include <Tanker/Serialization/Serialization.hpp>
+#include <Tanker/Streams/Header.hpp>
+#include <Tanker/Streams/TransparentSessionHeader.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using namespace Tanker::Errors;
+
+namespace Tanker
+{
+namespace Streams
+{
+namespace
+{
+template <typename HeaderType>
+HeaderType deserializeHeader(gsl::span<std::uint8_t const> buffer)
+try
+{
+  if (buffer.size() < HeaderType::serializedSize)
+    throw Exception(make_error_code(Errc::DecryptionFailed), "truncated buffer: could not read encrypted input header");
+  return Serialization::deserialize<HeaderType>(buffer.subspan(0, HeaderType::serializedSize));
+}
+catch (Exception const& e)
+{
+  if (e.errorCode() == Errc::InvalidArgument)
+    throw Exception(make_error_code(Errc::DecryptionFailed), e.what());
+  throw;
+}
+
+tc::cotask<std::int64_t> readAt(PositionalInputSource const& source, std::uint64_t offset, gsl::span<std::uint8_t> out)
+{
+  std::int64_t totalRead = 0;
+  while (!out.empty())
+  {
+    auto const nbRead = TC_AWAIT(source(offset + totalRead, out));
+    if (nbRead == 0)
+      break;
+    out = out.subspan(nbRead);
+    totalRead += nbRead;
+  }
+  TC_RETURN(totalRead);
+}
+
+std::uint32_t clearChunkSize(std::uint32_t encryptedChunkSize, std::uint32_t overhead)
+{
+  if (encryptedChunkSize <= overhead)
+    throw formatEx(Errc::DecryptionFailed, "invalid encrypted chunk size in header: {}", encryptedChunkSize);
+  return encryptedChunkSize - overhead;
+}
+}
+
+tc::cotask<RangeDecryptor> RangeDecryptor::create(PositionalInputSource source, ResourceKeyFinder const& finder)
+{
+  std::array<std::uint8_t, std::max(Header::serializedSize, TransparentSessionHeader::serializedSize)> headerBuf;
+  auto const nbRead = TC_AWAIT(readAt(source, 0, headerBuf));
+  auto const headerData = gsl::make_span(headerBuf).subspan(0, nbRead).as_span<std::uint8_t const>();
+  if (headerData.empty())
+    throw formatEx(Errc::InvalidArgument, "empty stream");
+
+  RangeDecryptor decryptor;
+  decryptor._source = std::move(source);
+  decryptor._version = headerData[0];
+  switch (decryptor._version)
+  {
+  case 4:
+  case 8: {
+    auto const header = deserializeHeader<Header>(headerData);
+    // V8 chunks end with at least one byte of padding
+    auto const overhead = Header::serializedSize + Crypto::Mac::arraySize + (decryptor._version == 8 ? 1 : 0);
+    decryptor._encryptedChunkSize = header.encryptedChunkSize();
+    decryptor._clearChunkSize = clearChunkSize(header.encryptedChunkSize(), overhead);
+    decryptor._resourceId = header.resourceId();
+    auto const key = TC_AWAIT(finder(header.resourceId()));
+    if (!key)
+      throw formatEx(Errc::InvalidArgument, "key not found for resource: {:s}", header.resourceId());
+    decryptor._key = *key;
+    break;
+  }
+  case 11: {
+    auto const header = deserializeHeader<TransparentSessionHeader>(headerData);
+    auto const& resourceId = header.resourceId();
+    Crypto::SubkeySeed const subkeySeed{resourceId.individualResourceId()};
+    decryptor._encryptedChunkSize = header.encryptedChunkSize();
+    decryptor._clearChunkSize = clearChunkSize(header.encryptedChunkSize(), EncryptorV11::chunkOverhead);
+    decryptor._chunksOffset = TransparentSessionHeader::serializedSize;
+    decryptor._resourceId = resourceId;
+    // Same lookup as DecryptionStreamV11
+    if (auto const sessionKey = TC_AWAIT(finder(resourceId.sessionId())))
+      decryptor._key = EncryptorV11::deriveSubkey(*sessionKey, subkeySeed);
+    else if (auto const key = TC_AWAIT(finder(resourceId.individualResourceId())))
+      decryptor._key = *key;
+    else
+      throw formatEx(Errc::InvalidArgument, "key not found for resource: {:s}", resourceId);
+    auto const sessionId = resourceId.sessionId();
+    std::copy(sessionId.begin(), sessionId.end(), decryptor._seedIv.begin());
+    decryptor._associatedData =
+        EncryptorV11::makeMacData(resourceId.sessionId(), subkeySeed, header.encryptedChunkSize());
+    break;
+  }
+  default:
+    throw formatEx(Errc::InvalidArgument, "range decryption is not supported for encryption format version {}",
+                   decryptor._version);
+  }
+  TC_RETURN(std::move(decryptor));
+}
+
+Crypto::ResourceId const& RangeDecryptor::resourceId() const
+{
+  return _resourceId;
+}
+
+Crypto::SymmetricKey const& RangeDecryptor::symmetricKey() const
+{
+  return _key;
+}
+
+tc::cotask<std::int64_t> RangeDecryptor::decryptRange(std::uint64_t offset, gsl::span<std::uint8_t> out)
+{
+  if (out.empty())
+    TC_RETURN(0);
+
+  auto constexpr maxOffset = std::numeric_limits<std::uint64_t>::max();
+  if (out.size() > maxOffset - offset)
+    throw formatEx(Errc::InvalidArgument, "range of {} bytes at offset {} overflows", out.size(), offset);
+  // The encrypted position of the last chunk must not overflow either, no
+  // stream is that big
+  auto const maxChunks = (maxOffset - _chunksOffset) / _encryptedChunkSize;
+  if ((offset + out.size() - 1) / _clearChunkSize >= maxChunks)
+    throw formatEx(Errc::InvalidArgument, "offset {} is past the end of the data", offset);
+
+  // The chunks that hold the range are contiguous, read them at once
+  auto const firstChunk = offset / _clearChunkSize;
+  auto const lastChunk = (offset + out.size() - 1) / _clearChunkSize;
+  std::vector<std::uint8_t> encrypted((lastChunk - firstChunk + 1) * _encryptedChunkSize);
+  auto const nbRead =
+      TC_AWAIT(readAt(_source, _chunksOffset + firstChunk * _encryptedChunkSize, encrypted));
+  auto const encryptedChunks = gsl::make_span(encrypted).subspan(0, nbRead).as_span<std::uint8_t const>();
+  // The clear size is only known once the last chunk is read: there is no
+  // chunk at all, or the last one ends before offset
+  if (encryptedChunks.empty())
+    throw formatEx(Errc::InvalidArgument, "offset {} is past the end of the data", offset);
+
+  std::vector<std::uint8_t> clearBuffer(_encryptedChunkSize);
+  std::int64_t written = 0;
+  auto skip = offset % _clearChunkSize;
+  for (auto index = firstChunk; index <= lastChunk; ++index)
+  {
+    auto const chunkPosition = (index - firstChunk) * _encryptedChunkSize;
+    if (chunkPosition >= encryptedChunks.size())
+      break;
+    auto const encryptedChunk = encryptedChunks.subspan(
+        chunkPosition, std::min<std::uint64_t>(_encryptedChunkSize, encryptedChunks.size() - chunkPosition));
+    auto const clearChunk = decryptChunk(index, encryptedChunk, clearBuffer);
+    if (clearChunk.size() < skip)
+      throw formatEx(Errc::InvalidArgument, "offset {} is past the end of the data", offset);
+
+    if (clearChunk.size() > skip)
+    {
+      auto const toCopy = std::min<std::uint64_t>(clearChunk.size() - skip, out.size() - written);
+      std::copy_n(clearChunk.begin() + skip, toCopy, out.begin() + written);
+      written += toCopy;
+    }
+    // Only the last chunk holding data is not full
+    if (clearChunk.size() < _clearChunkSize)
+      break;
+    skip = 0;
+  }
+  TC_RETURN(written);
+}
+
+gsl::span<std::uint8_t const> RangeDecryptor::decryptChunk(std::uint64_t index,
+                                                           gsl::span<std::uint8_t const> encryptedChunk,
+                                                           gsl::span<std::uint8_t> clearBuffer) const
+{
+  if (_version == 11)
+    return decryptChunkV11(index, encryptedChunk, clearBuffer);
+  return decryptChunkV4V8(index, encryptedChunk, clearBuffer);
+}
+
+gsl::span<std::uint8_t const> RangeDecryptor::decryptChunkV4V8(std::uint64_t index,
+                                                               gsl::span<std::uint8_t const> encryptedChunk,
+                                                               gsl::span<std::uint8_t> clearBuffer) const
+{
+  // Each chunk has its own copy of the header, with its own IV seed
+  auto const header = deserializeHeader<Header>(encryptedChunk);
+  if (header.version() != _version || header.resourceId() != _resourceId.individualResourceId() ||
+      header.encryptedChunkSize() != _encryptedChunkSize)
+    throw formatEx(Errc::DecryptionFailed, "header mismatch in chunk {}", index);
+
+  auto const cipherText = encryptedChunk.subspan(Header::serializedSize);
+  if (cipherText.size() < Crypto::Mac::arraySize)
+    throw Exception(make_error_code(Errc::DecryptionFailed), "truncated buffer: missing chunk metadata");
+  auto const output = clearBuffer.subspan(0, Crypto::decryptedSize(cipherText.size()));
+  auto const iv = Crypto::deriveIv(header.seed(), index);
+  if (_version == 4)
+  {
+    Crypto::decryptAead(_key, iv, output, cipherText, {});
+    return output;
+  }
+
+  auto const associatedData = encryptedChunk.subspan(0, Header::serializedSize);
+  Crypto::decryptAead(_key, iv, output, cipherText, associatedData);
+  return output.subspan(0, Padding::unpaddedSize(output));
+}
+
+gsl::span<std::uint8_t const> RangeDecryptor::decryptChunkV11(std::uint64_t index,
+                                                              gsl::span<std::uint8_t const> encryptedChunk,
+                                                              gsl::span<std::uint8_t> clearBuffer) const
+{
+  if (encryptedChunk.size() < EncryptorV11::chunkOverhead)
+    throw Exception(make_error_code(Errc::DecryptionFailed), "truncated buffer: missing chunk metadata");
+
+  auto const output = clearBuffer.subspan(0, Crypto::decryptedSize(encryptedChunk.size()));
+  auto const iv = Crypto::deriveIv(_seedIv, index);
+  Crypto::decryptAead(_key, iv, output, encryptedChunk, _associatedData);
+
+  // The padding comes before the data
+  auto const paddingSize = Serialization::deserialize<std::uint32_t>(output.subspan(0, EncryptorV11::paddingSizeSize));
+  if (encryptedChunk.size() < EncryptorV11::chunkOverhead + paddingSize)
+    throw Exception(make_error_code(Errc::DecryptionFailed), "invalid padding size value");
+  return output.subspan(EncryptorV11::paddingSizeSize + paddingSize);
+}
+}
+}
@@ -0,0 +1,139 @@
+#include <Tanker/Streams/ReadAheadInputSource.hpp>
+
+#include <Tanker/Errors/AssertionError.hpp>
+#include <Tanker/Streams/Helpers.hpp>
+
+#include <tconcurrent/async.hpp>
+#include <tconcurrent/future.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+namespace Tanker
+{
+namespace Streams
+{
+namespace
+{
+using Chunk = std::shared_ptr<std::vector<std::uint8_t>>;
+
+// Shared with the reads in flight, which can outlive the ReadAheadInputSource
+struct Reader
+{
+  InputSource source;
+  std::int64_t chunkSize;
+  // Set once a read came back short, the source must not be read again
+  bool endOfStream = false;
+  bool closed = false;
+  std::vector<std::vector<std::uint8_t>> freeBuffers;
+
+  tc::cotask<Chunk> read()
+  {
+    auto chunk = std::make_shared<std::vector<std::uint8_t>>();
+    if (endOfStream || closed)
+      TC_RETURN(chunk);
+
+    if (!freeBuffers.empty())
+    {
+      *chunk = std::move(freeBuffers.back());
+      freeBuffers.pop_back();
+    }
+    chunk->resize(chunkSize);
+    // A chunk can take several calls, none is made once closed
+    auto const guardedSource = [this](gsl::span<std::uint8_t> out) -> tc::cotask<std::int64_t> {
+      if (closed)
+        TC_RETURN(0);
+      TC_RETURN(TC_AWAIT(source(out)));
+    };
+    auto const totalRead = TC_AWAIT(readStream(*chunk, guardedSource));
+    chunk->resize(totalRead);
+    if (totalRead < chunkSize)
+      endOfStream = true;
+    TC_RETURN(chunk);
+  }
+};
+}
+
+struct ReadAheadInputSource::State
+{
+  std::shared_ptr<Reader> reader;
+  std::uint32_t depth;
+  // Oldest first, each one starts when the previous one is done
+  std::deque<tc::shared_future<Chunk>> reads;
+  Chunk current;
+  std::size_t position = 0;
+  bool sawEndOfStream = false;
+
+  ~State()
+  {
+    reader->closed = true;
+  }
+
+  void scheduleReads()
+  {
+    while (!sawEndOfStream && reads.size() < depth)
+    {
+      auto previous = reads.empty() ? tc::make_ready_future(Chunk{}).to_shared() : reads.back();
+      reads.push_back(tc::async_resumable([reader = reader, previous]() mutable -> tc::cotask<Chunk> {
+                        // The errors are forwarded to the next reads, so that
+                        // they are seen in order
+                        TC_AWAIT(previous);
+                        TC_RETURN(TC_AWAIT(reader->read()));
+                      }).to_shared());
+    }
+  }
+
+  void recycleCurrent()
+  {
+    if (current && current->capacity() > 0)
+      reader->freeBuffers.push_back(std::move(*current));
+    current = nullptr;
+  }
+};
+
+ReadAheadInputSource::ReadAheadInputSource(InputSource source, std::int64_t chunkSize, std::uint32_t depth)
+  : _state(std::make_shared<State>())
+{
+  if (chunkSize <= 0 || depth == 0)
+    throw Errors::AssertionError("invalid read-ahead chunk size or depth");
+  _state->reader = std::make_shared<Reader>();
+  _state->reader->source = std::move(source);
+  _state->reader->chunkSize = chunkSize;
+  _state->depth = depth;
+}
+
+tc::cotask<std::int64_t> ReadAheadInputSource::operator()(gsl::span<std::uint8_t> out)
+{
+  auto& state = *_state;
+  if (!state.current || state.position == state.current->size())
+  {
+    state.recycleCurrent();
+    state.scheduleReads();
+    if (state.reads.empty())
+      TC_RETURN(0);
+
+    auto read = std::move(state.reads.front());
+    state.reads.pop_front();
+    state.current = TC_AWAIT(read);
+    state.position = 0;
+    if (static_cast<std::int64_t>(state.current->size()) < state.reader->chunkSize)
+      state.sawEndOfStream = true;
+    // Keep depth reads in flight while this chunk is consumed
+    state.scheduleReads();
+  }
+
+  auto const toRead = std::min<std::uint64_t>(out.size(), state.current->size() - state.position);
+  std::copy_n(state.current->begin() + state.position, toRead, out.data());
+  state.position += toRead;
+  TC_RETURN(toRead);
+}
+
+InputSource readAhead(InputSource source, std::int64_t chunkSize, std::uint32_t depth)
+{
+  if (depth == 0)
+    return source;
+  return ReadAheadInputSource(std::move(source), chunkSize, depth);
+}
+}
+}
@@ -0,0 +1,165 @@
+#include <Tanker/Crypto/Crypto.hpp>
+#include <Tanker/Crypto/SimpleResourceId.hpp>
+#include <Tanker/Streams/EncryptionStreamV11.hpp>
+#include <Tanker/Streams/EncryptionStreamV4.hpp>
+#include <Tanker/Streams/EncryptionStreamV8.hpp>
+#include <Tanker/Streams/Helpers.hpp>
+#include <Tanker/Streams/RangeDecryptor.hpp>
+
+#include <Helpers/Await.hpp>
+#include <Helpers/Errors.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+using namespace Tanker;
+using namespace Tanker::Errors;
+using namespace Tanker::Streams;
+
+namespace
+{
+constexpr auto smallChunkSize = 0x46;
+
+// Counts the bytes read, to check that only the chunks of a range are read
+PositionalInputSource makePositionalSource(std::vector<std::uint8_t> const& encrypted, std::uint64_t& bytesRead)
+{
+  return [&encrypted, &bytesRead](std::uint64_t offset, gsl::span<std::uint8_t> out) -> tc::cotask<std::int64_t> {
+    if (offset >= encrypted.size())
+      TC_RETURN(0);
+    auto const toRead = std::min<std::uint64_t>(out.size(), encrypted.size() - offset);
+    std::copy_n(encrypted.begin() + offset, toRead, out.begin());
+    bytesRead += toRead;
+    TC_RETURN(toRead);
+  };
+}
+
+RangeDecryptor makeRangeDecryptor(PositionalInputSource const& source, Crypto::SymmetricKey const& key)
+{
+  auto const keyFinder = [key](Crypto::SimpleResourceId const&) -> tc::cotask<std::optional<Crypto::SymmetricKey>> {
+    TC_RETURN(key);
+  };
+  // This should be the AWAIT() macro, but that breaks Visual
+  return tc::async_resumable([&]() -> tc::cotask<RangeDecryptor> {
+           TC_RETURN(TC_AWAIT(RangeDecryptor::create(source, keyFinder)));
+         }).get();
+}
+
+std::vector<std::uint8_t> decryptRange(RangeDecryptor& decryptor, std::uint64_t offset, std::size_t size)
+{
+  std::vector<std::uint8_t> out(size);
+  out.resize(AWAIT(decryptor.decryptRange(offset, out)));
+  return out;
+}
+
+std::vector<std::uint8_t> expectedRange(std::vector<std::uint8_t> const& clear, std::uint64_t offset, std::size_t size)
+{
+  auto const begin = std::min<std::uint64_t>(offset, clear.size());
+  auto const end = std::min<std::uint64_t>(offset + size, clear.size());
+  return {clear.begin() + begin, clear.begin() + end};
+}
+
+template <typename EncStream>
+void rangeDecryptionTests(EncStream& encryptor,
+                          std::vector<std::uint8_t> const& clear,
+                          std::uint64_t clearChunkSize,
+                          std::uint64_t chunksOffset)
+{
+  auto encrypted = AWAIT(readAllStream(encryptor));
+  std::uint64_t bytesRead = 0;
+  auto decryptor = makeRangeDecryptor(makePositionalSource(encrypted, bytesRead), encryptor.symmetricKey());
+
+  SECTION("decrypts ranges")
+  {
+    std::vector<std::pair<std::uint64_t, std::size_t>> const ranges{
+        {0, 1},
+        {0, clear.size()},
+        {clearChunkSize - 1, 2},
+        {3 * clearChunkSize + 7, 2 * clearChunkSize},
+        {clear.size() - 3, 10},
+        {clear.size(), 4},
+    };
+    for (auto const& [offset, size] : ranges)
+    {
+      CAPTURE(offset, size);
+      CHECK(decryptRange(decryptor, offset, size) == expectedRange(clear, offset, size));
+    }
+  }
+
+  SECTION("rejects ranges past the end of the data")
+  {
+    TANKER_CHECK_THROWS_WITH_CODE(decryptRange(decryptor, clear.size() + 1, 4), Errc::InvalidArgument);
+    TANKER_CHECK_THROWS_WITH_CODE(decryptRange(decryptor, clear.size() + 5 * clearChunkSize, 4),
+                                  Errc::InvalidArgument);
+  }
+
+  SECTION("rejects overflowing ranges without reading anything")
+  {
+    auto constexpr maxOffset = std::numeric_limits<std::uint64_t>::max();
+    bytesRead = 0;
+    TANKER_CHECK_THROWS_WITH_CODE(decryptRange(decryptor, maxOffset - 1, 4), Errc::InvalidArgument);
+    TANKER_CHECK_THROWS_WITH_CODE(decryptRange(decryptor, maxOffset / 2, 4), Errc::InvalidArgument);
+    CHECK(bytesRead == 0);
+  }
+
+  SECTION("reads only the chunks holding the range")
+  {
+    bytesRead = 0;
+    CHECK(decryptRange(decryptor, 3 * clearChunkSize + 1, 2) == expectedRange(clear, 3 * clearChunkSize + 1, 2));
+    CHECK(bytesRead == smallChunkSize);
+  }
+
+  SECTION("fails on a corrupted chunk in the range only")
+  {
+    encrypted[chunksOffset + 2 * smallChunkSize + smallChunkSize / 2] ^= 0x01;
+
+    CHECK(decryptRange(decryptor, 0, clearChunkSize) == expectedRange(clear, 0, clearChunkSize));
+    TANKER_CHECK_THROWS_WITH_CODE(decryptRange(decryptor, 2 * clearChunkSize, 1), Errc::DecryptionFailed);
+  }
+}
+}
+
+TEST_CASE("Range decryption of a V4 stream", "[rangedecryptor]")
+{
+  std::vector<std::uint8_t> clear(10 * (smallChunkSize - EncryptionStreamV4::overhead) + 5);
+  Crypto::randomFill(clear);
+  EncryptionStreamV4 encryptor(bufferViewToInputSource(clear), smallChunkSize);
+
+  rangeDecryptionTests(encryptor, clear, smallChunkSize - EncryptionStreamV4::overhead, 0);
+}
+
+TEST_CASE("Range decryption of a V8 stream", "[rangedecryptor]")
+{
+  std::vector<std::uint8_t> clear(10 * (smallChunkSize - EncryptionStreamV8::overhead) + 5);
+  Crypto::randomFill(clear);
+  EncryptionStreamV8 encryptor(bufferViewToInputSource(clear), 500, smallChunkSize);
+
+  rangeDecryptionTests(encryptor, clear, smallChunkSize - EncryptionStreamV8::overhead, 0);
+}
+
+TEST_CASE("Range decryption of a V11 stream", "[rangedecryptor]")
+{
+  std::vector<std::uint8_t> clear(10 * (smallChunkSize - EncryptionStreamV11::overhead) + 5);
+  Crypto::randomFill(clear);
+  EncryptionStreamV11 encryptor(bufferViewToInputSource(clear),
+                                Crypto::getRandom<Crypto::SimpleResourceId>(),
+                                Crypto::makeSymmetricKey(),
+                                500,
+                                smallChunkSize);
+
+  rangeDecryptionTests(
+      encryptor, clear, smallChunkSize - EncryptionStreamV11::overhead, TransparentSessionHeader::serializedSize);
+}
+
+TEST_CASE("Range decryption of an unsupported format", "[rangedecryptor]")
+{
+  std::vector<std::uint8_t> const encrypted{2, 0, 0, 0};
+  std::uint64_t bytesRead = 0;
+
+  TANKER_CHECK_THROWS_WITH_CODE(makeRangeDecryptor(makePositionalSource(encrypted, bytesRead), {}),
+                                Errc::InvalidArgument);
+}
@@ -0,0 +1,123 @@
+#include <Tanker/Crypto/Crypto.hpp>
+#include <Tanker/Crypto/SimpleResourceId.hpp>
+#include <Tanker/Streams/DecryptionStreamV11.hpp>
+#include <Tanker/Streams/EncryptionStreamV11.hpp>
+#include <Tanker/Streams/Helpers.hpp>
+#include <Tanker/Streams/ReadAheadInputSource.hpp>
+
+#include <Helpers/Await.hpp>
+#include <Helpers/Errors.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <tconcurrent/async_wait.hpp>
+#include <tconcurrent/promise.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+using namespace Tanker;
+using namespace Tanker::Errors;
+using namespace Tanker::Streams;
+
+namespace
+{
+std::vector<uint8_t> makeRandomBuffer(std::size_t size)
+{
+  std::vector<uint8_t> buffer(size);
+  Crypto::randomFill(buffer);
+  return buffer;
+}
+}
+
+TEST_CASE("reads an underlying stream ahead", "[readaheadinputsource]")
+{
+  auto const buffer = makeRandomBuffer(50);
+  ReadAheadInputSource readAheadSource(bufferViewToInputSource(buffer), 7, 3);
+
+  auto out = AWAIT(readAllStream(readAheadSource));
+  CHECK(out == buffer);
+}
+
+TEST_CASE("does not read the underlying stream past its end", "[readaheadinputsource]")
+{
+  auto const buffer = makeRandomBuffer(30);
+  auto source = bufferViewToInputSource(buffer);
+  auto readsAtEnd = 0;
+  auto countingSource = [&](gsl::span<std::uint8_t> out) -> tc::cotask<std::int64_t> {
+    auto const nbRead = TC_AWAIT(source(out));
+    if (nbRead == 0)
+      ++readsAtEnd;
+    TC_RETURN(nbRead);
+  };
+  ReadAheadInputSource readAheadSource(countingSource, 10, 4);
+
+  auto out = AWAIT(readAllStream(readAheadSource));
+  CHECK(out == buffer);
+  CHECK(readsAtEnd == 1);
+}
+
+TEST_CASE("forwards the errors of the underlying stream", "[readaheadinputsource]")
+{
+  auto const buffer = makeRandomBuffer(30);
+  auto source = bufferViewToInputSource(buffer);
+  auto nbReads = 0;
+  auto failingSource = [&](gsl::span<std::uint8_t> out) -> tc::cotask<std::int64_t> {
+    if (++nbReads == 2)
+      throw Exception(make_error_code(Errc::IOError), "failRead");
+    TC_RETURN(TC_AWAIT(source(out)));
+  };
+  ReadAheadInputSource readAheadSource(failingSource, 10, 2);
+
+  TANKER_CHECK_THROWS_WITH_CODE(AWAIT(readAllStream(readAheadSource)), Errc::IOError);
+}
+
+TEST_CASE("does not call the underlying stream once destroyed", "[readaheadinputsource]")
+{
+  auto nbCalls = 0;
+  tc::promise<std::int64_t> blockedRead;
+  // One byte per call, the second chunk blocks on its first byte
+  auto source = [&](gsl::span<std::uint8_t> out) -> tc::cotask<std::int64_t> {
+    if (++nbCalls == 5)
+      TC_RETURN(TC_AWAIT(blockedRead.get_future()));
+    out[0] = 0;
+    TC_RETURN(1);
+  };
+
+  {
+    ReadAheadInputSource readAheadSource(source, 4, 1);
+    std::vector<std::uint8_t> out(4);
+    CHECK(AWAIT(readAheadSource(out)) == 4);
+    AWAIT_VOID(tc::async_wait(std::chrono::milliseconds(10)));
+    REQUIRE(nbCalls == 5);
+  }
+
+  // The read in flight completes, but does not go on with the rest of its chunk
+  AWAIT_VOID([&]() -> tc::cotask<void> {
+    blockedRead.set_value(1);
+    TC_AWAIT(tc::async_wait(std::chrono::milliseconds(10)));
+  }());
+  CHECK(nbCalls == 5);
+}
+
+TEST_CASE("encrypts and decrypts ahead", "[readaheadinputsource]")
+{
+  auto const chunkSize = 0x46;
+  auto const buffer = makeRandomBuffer(10 * chunkSize);
+  auto const key = Crypto::makeSymmetricKey();
+  EncryptionStreamV11 encryptor(readAhead(bufferViewToInputSource(buffer), chunkSize, 2),
+                                Crypto::getRandom<Crypto::SimpleResourceId>(),
+                                key,
+                                std::nullopt,
+                                chunkSize);
+  auto const encrypted = AWAIT(readAllStream(readAhead(encryptor, chunkSize, 2)));
+
+  auto keyFinder = [&](Crypto::SimpleResourceId const&) -> tc::cotask<std::optional<Crypto::SymmetricKey>> {
+    TC_RETURN(key);
+  };
+  auto decryptor = AWAIT(DecryptionStreamV11::create(bufferViewToInputSource(encrypted), keyFinder));
+  auto const decrypted = AWAIT(readAllStream(readAhead(decryptor, chunkSize, 3)));
+  CHECK(decrypted == buffer);
+}
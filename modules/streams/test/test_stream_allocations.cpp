@@ -0,0 +1,113 @@
+#include <Tanker/Crypto/Crypto.hpp>
+#include <Tanker/Crypto/SimpleResourceId.hpp>
+#include <Tanker/Streams/DecryptionStreamV11.hpp>
+#include <Tanker/Streams/DecryptionStreamV4.hpp>
+#include <Tanker/Streams/DecryptionStreamV8.hpp>
+#include <Tanker/Streams/EncryptionStreamV11.hpp>
+#include <Tanker/Streams/EncryptionStreamV4.hpp>
+#include <Tanker/Streams/EncryptionStreamV8.hpp>
+#include <Tanker/Streams/Helpers.hpp>
+
+#include <Helpers/Await.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <utility>
+#include <vector>
+
+using namespace Tanker;
+using namespace Tanker::Streams;
+
+namespace
+{
+// Only counts the allocations of the current thread, the streams are read on a
+// single coroutine
+thread_local std::int64_t allocationCount = 0;
+}
+
+void* operator new(std::size_t size)
+{
+  ++allocationCount;
+  if (auto const ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+// With the coroutines TS, every coroutine frame is heap-allocated
+#ifndef __cpp_coroutines
+namespace
+{
+constexpr auto chunkSize = 0x400;
+constexpr auto clearSize = 10 * chunkSize + 3;
+
+auto makeKeyFinder(Crypto::SymmetricKey const& key)
+{
+  return [=](Crypto::SimpleResourceId const&) -> tc::cotask<std::optional<Crypto::SymmetricKey>> { TC_RETURN(key); };
+}
+
+// Reads the whole stream into out, and returns how many bytes were read and
+// how many allocations were made after the first chunks
+template <typename Stream>
+tc::cotask<std::pair<std::int64_t, std::int64_t>> readCountingAllocations(Stream& stream, gsl::span<uint8_t> out)
+{
+  auto const warmupSize = TC_AWAIT(readStream(out.subspan(0, 2 * chunkSize), stream));
+  auto const before = allocationCount;
+  auto const size = TC_AWAIT(readStream(out.subspan(warmupSize), stream));
+  TC_RETURN(std::make_pair(warmupSize + size, allocationCount - before));
+}
+
+template <typename DecStream, typename EncStream>
+void checkSteadyStateAllocations(EncStream& encryptor)
+{
+  std::vector<uint8_t> encrypted(2 * clearSize);
+  auto const [encryptedSize, encryptionAllocations] =
+      AWAIT(readCountingAllocations(encryptor, gsl::make_span(encrypted)));
+  CHECK(encryptionAllocations == 0);
+  encrypted.resize(encryptedSize);
+
+  auto decryptor =
+      AWAIT(DecStream::create(bufferViewToInputSource(encrypted), makeKeyFinder(encryptor.symmetricKey())));
+  std::vector<uint8_t> decrypted(clearSize);
+  auto const [decryptedSize, decryptionAllocations] =
+      AWAIT(readCountingAllocations(decryptor, gsl::make_span(decrypted)));
+  CHECK(decryptionAllocations == 0);
+  CHECK(decryptedSize == clearSize);
+}
+}
+
+TEST_CASE("Stream V4 does not allocate per chunk", "[streamencryption]")
+{
+  EncryptionStreamV4 encryptor(bufferToInputSource(std::vector<uint8_t>(clearSize, 'a')), chunkSize);
+  checkSteadyStateAllocations<DecryptionStreamV4>(encryptor);
+}
+
+TEST_CASE("Stream V8 does not allocate per chunk", "[streamencryption]")
+{
+  EncryptionStreamV8 encryptor(bufferToInputSource(std::vector<uint8_t>(clearSize, 'a')), std::nullopt, chunkSize);
+  checkSteadyStateAllocations<DecryptionStreamV8>(encryptor);
+}
+
+TEST_CASE("Stream V11 does not allocate per chunk", "[streamencryption]")
+{
+  EncryptionStreamV11 encryptor(bufferToInputSource(std::vector<uint8_t>(clearSize, 'a')),
+                                Crypto::getRandom<Crypto::SimpleResourceId>(),
+                                Crypto::makeSymmetricKey(),
+                                std::nullopt,
+                                chunkSize);
+  checkSteadyStateAllocations<DecryptionStreamV11>(encryptor);
+}
+#endif
@@ -6,6 +6,7 @@
 #include <Tanker/DataStore/Backend.hpp>
 #include <Tanker/DataStore/Errors/Errc.hpp>
 
+#include <Helpers/Await.hpp>
 #include <Helpers/Buffers.hpp>
 #include <Helpers/DataStoreTestUtils.hpp>
 #include <Helpers/Errors.hpp>
@@ -26,38 +27,38 @@ void runDataStoreTests(T& backend, std::string_view writablePath)
   {
     SECTION("returns nullopt when there is no device")
     {
-      CHECK(!store->findSerializedDevice());
+      CHECK(!AWAIT(store->findSerializedDevice()));
     }
 
     SECTION("can put and get a device")
     {
       std::vector<uint8_t> device(128);
       Tanker::Crypto::randomFill(device);
-      REQUIRE_NOTHROW(store->putSerializedDevice(device));
-      CHECK(store->findSerializedDevice() == device);
+      REQUIRE_NOTHROW(AWAIT_VOID(store->putSerializedDevice(device)));
+      CHECK(AWAIT(store->findSerializedDevice()) == device);
     }
 
     SECTION("can close and reopen the db")
     {
       std::vector<uint8_t> device(128);
       Tanker::Crypto::randomFill(device);
-      REQUIRE_NOTHROW(store->putSerializedDevice(device));
+      REQUIRE_NOTHROW(AWAIT_VOID(store->putSerializedDevice(device)));
 
       // We need to close the DB before we can reopen it
       store.reset();
       store = backend.open(testtmp.path, testtmp.path);
 
-      CHECK(store->findSerializedDevice() == device);
+      CHECK(AWAIT(store->findSerializedDevice()) == device);
     }
 
     SECTION("can overwrite and get a device")
     {
       std::vector<uint8_t> device(128);
       Tanker::Crypto::randomFill(device);
-      REQUIRE_NOTHROW(store->putSerializedDevice(device));
+      REQUIRE_NOTHROW(AWAIT_VOID(store->putSerializedDevice(device)));
       Tanker::Crypto::randomFill(device);
-      REQUIRE_NOTHROW(store->putSerializedDevice(device));
-      CHECK(store->findSerializedDevice() == device);
+      REQUIRE_NOTHROW(AWAIT_VOID(store->putSerializedDevice(device)));
+      CHECK(AWAIT(store->findSerializedDevice()) == device);
     }
   }
 
@@ -68,13 +69,13 @@ void runDataStoreTests(T& backend, std::string_view writablePath)
       auto const key = make_buffer("test key");
       auto const keys = {gsl::make_span(key)};
       std::vector<std::optional<std::vector<uint8_t>>> expected{std::nullopt};
-      CHECK(store->findCacheValues(keys) == expected);
+      CHECK(AWAIT(store->findCacheValues(keys)) == expected);
     }
 
     SECTION("puts no value at all")
     {
       auto const keyValues = makeKeyValues({});
-      REQUIRE_NOTHROW(store->putCacheValues(keyValues, OnConflict::Fail));
+      REQUIRE_NOTHROW(AWAIT_VOID(store->putCacheValues(keyValues, OnConflict::Fail)));
     }
 
     SECTION("puts a binary value and gets it back")
@@ -82,11 +83,11 @@ void runDataStoreTests(T& backend, std::string_view writablePath)
       char const key[] = "test\0 key";
       char const value[] = "test\0 value";
       auto const keyValues = makeKeyValues({{key, value}});
-      REQUIRE_NOTHROW(store->putCacheValues(keyValues, OnConflict::Fail));
+      REQUIRE_NOTHROW(AWAIT_VOID(store->putCacheValues(keyValues, OnConflict::Fail)));
 
       auto const keys = makeKeys({key});
       CacheResult expected{make_buffer(value)};
-      CHECK(store->findCacheValues(keys) == expected);
+      CHECK(AWAIT(store->findCacheValues(keys)) == expected);
     }
 
     SECTION("puts and gets multiple values at once, respecting order")
@@ -97,12 +98,12 @@ void runDataStoreTests(T& backend, std::string_view writablePath)
       auto const value = "test value";
       auto const value2 = "test another value";
       auto const keyValues = makeKeyValues({{key, value}, {key2, value2}});
-      REQUIRE_NOTHROW(store->putCacheValues(keyValues, OnConflict::Fail));
+      REQUIRE_NOTHROW(AWAIT_VOID(store->putCacheValues(keyValues, OnConflict::Fail)));
 
       // invert them, just to check that the order is respected
       auto const keys = makeKeys({key2, unknownKey, key});
       CacheResult expected{make_buffer(value2), std::nullopt, make_buffer(value)};
-      CHECK(store->findCacheValues(keys) == expected);
+      CHECK(AWAIT(store->findCacheValues(keys)) == expected);
     }
 
     SECTION("can close and reopen the db")
@@ -110,14 +111,14 @@ void runDataStoreTests(T& backend, std::string_view writablePath)
       auto const key = "test key";
       auto const value = "test value";
       auto const keyValues = makeKeyValues({{key, value}});
-      REQUIRE_NOTHROW(store->putCacheValues(keyValues, OnConflict::Fail));
+      REQUIRE_NOTHROW(AWAIT_VOID(store->putCacheValues(keyValues, OnConflict::Fail)));
 
       store = nullptr;
       store = backend.open(testtmp.path, testtmp.path);
 
       auto const keys = makeKeys({key});
       CacheResult expected{make_buffer(value)};
-      CHECK(store->findCacheValues(keys) == expected);
+      CHECK(AWAIT(store->findCacheValues(keys)) == expected);
     }
 
     SECTION("overwrites a value and gets it back")
@@ -126,14 +127,14 @@ void runDataStoreTests(T& backend, std::string_view writablePath)
       auto const value = "test value";
       auto const value2 = "test value 2";
       auto const keyValues = makeKeyValues({{key, value}});
-      REQUIRE_NOTHROW(store->putCacheValues(keyValues, OnConflict::Fail));
+      REQUIRE_NOTHROW(AWAIT_VOID(store->putCacheValues(keyValues, OnConflict::Fail)));
 
       auto const keyValues2 = makeKeyValues({{key, value2}});
-      REQUIRE_NOTHROW(store->putCacheValues(keyValues2, OnConflict::Replace));
+      REQUIRE_NOTHROW(AWAIT_VOID(store->putCacheValues(keyValues2, OnConflict::Replace)));
 
       auto const keys = makeKeys({key});
       CacheResult expected{make_buffer(value2)};
-      CHECK(store->findCacheValues(keys) == expected);
+      CHECK(AWAIT(store->findCacheValues(keys)) == expected);
     }
 
     SECTION("ignores conflicts on a value and gets it back")
@@ -142,14 +143,14 @@ void runDataStoreTests(T& backend, std::string_view writablePath)
       auto const value = "test value";
       auto const value2 = "test value 2";
       auto const keyValues = makeKeyValues({{key, value}});
-      REQUIRE_NOTHROW(store->putCacheValues(keyValues, OnConflict::Fail));
+      REQUIRE_NOTHROW(AWAIT_VOID(store->putCacheValues(keyValues, OnConflict::Fail)));
 
       auto const keyValues2 = makeKeyValues({{key, value2}});
-      REQUIRE_NOTHROW(store->putCacheValues(keyValues2, OnConflict::Ignore));
+      REQUIRE_NOTHROW(AWAIT_VOID(store->putCacheValues(keyValues2, OnConflict::Ignore)));
 
       auto const keys = makeKeys({key});
       CacheResult expected{make_buffer(value)};
-      CHECK(store->findCacheValues(keys) == expected);
+      CHECK(AWAIT(store->findCacheValues(keys)) == expected);
     }
 
     SECTION("fails to overwrite a value when needed")
@@ -158,15 +159,15 @@ void runDataStoreTests(T& backend, std::string_view writablePath)
       auto const value = "test value";
       auto const value2 = "test value 2";
       auto const keyValues = makeKeyValues({{key, value}});
-      REQUIRE_NOTHROW(store->putCacheValues(keyValues, OnConflict::Fail));
+      REQUIRE_NOTHROW(AWAIT_VOID(store->putCacheValues(keyValues, OnConflict::Fail)));
 
       auto const keyValues2 = makeKeyValues({{key, value2}});
-      TANKER_CHECK_THROWS_WITH_CODE(store->putCacheValues(keyValues2, OnConflict::Fail),
+      TANKER_CHECK_THROWS_WITH_CODE(AWAIT_VOID(store->putCacheValues(keyValues2, OnConflict::Fail)),
                                     Tanker::DataStore::Errc::ConstraintFailed);
 
       auto const keys = makeKeys({key});
       CacheResult expected{make_buffer(value)};
-      CHECK(store->findCacheValues(keys) == expected);
+      CHECK(AWAIT(store->findCacheValues(keys)) == expected);
     }
   }
 
@@ -174,20 +175,20 @@ void runDataStoreTests(T& backend, std::string_view writablePath)
   {
     std::vector<uint8_t> device(128);
     Tanker::Crypto::randomFill(device);
-    store->putSerializedDevice(device);
+    AWAIT_VOID(store->putSerializedDevice(device));
 
     auto const key = "test key";
     auto const value = "test value";
     auto const keyValues = makeKeyValues({{key, value}});
-    store->putCacheValues(keyValues, OnConflict::Fail);
+    AWAIT_VOID(store->putCacheValues(keyValues, OnConflict::Fail));
 
-    REQUIRE_NOTHROW(store->nuke());
+    REQUIRE_NOTHROW(AWAIT_VOID(store->nuke()));
 
     // everything is deleted
-    CHECK(!store->findSerializedDevice());
+    CHECK(!AWAIT(store->findSerializedDevice()));
 
     auto const keys = makeKeys({key});
     CacheResult expected{std::nullopt};
-    CHECK(store->findCacheValues(keys) == expected);
+    CHECK(AWAIT(store->findCacheValues(keys)) == expected);
   }
 }